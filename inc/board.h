@@ -1,60 +1,66 @@
 /*
-* Last Modified: 01/19/21
+* Last Modified: 10/19/26
 * Author: Alex Eastman
 * Contact: alexeast@buffalo.edu
 * Summary: Board class with function prototypes and intializer.
 */
 
+#ifndef BOARD_H
+#define BOARD_H
+
 #include <vector>
 #include <string>
 #include <fstream>
 #include <glibmm/ustring.h>
 #include <glibmm/keyfile.h>
-
+#include "canonical.h"
+#include "cache.h"
+#include "rater.h"
+#include "generator.h"
+#include "variants.h"
+#include "collection.h"
+#include "random.h"
+
+/* Number of reserved cells in games saved before the count was stored with
+ * them. Generated puzzles have as many reserved cells as they need.
+ */
 #define RESERVED 12
 
+/* Keyfile holding every user's times and saved game, in the data directory
+ *
+ */
+#define USER_DATA_FILE "user_data.txt"
+
 class Board {
 
   private:
 
-	  /* Used to reset the game_board and blocks variables
-	   *
-	   */
-	   std::vector< std::vector< int>> initial =
-		 { {0, 0, 0, 0, 0, 0, 0, 0, 0},
-		   {0, 0, 0, 0, 0, 0, 0, 0, 0},
-		   {0, 0, 0, 0, 0, 0, 0, 0, 0},
-		   {0, 0, 0, 0, 0, 0, 0, 0, 0},
-		   {0, 0, 0, 0, 0, 0, 0, 0, 0},
-		   {0, 0, 0, 0, 0, 0, 0, 0, 0},
-		   {0, 0, 0, 0, 0, 0, 0, 0, 0},
-		   {0, 0, 0, 0, 0, 0, 0, 0, 0},
-		   {0, 0, 0, 0, 0, 0, 0, 0, 0}
-		 };
-
-    /* A 3 by 3 board where the outer array specifies the row, starting at 0, and
-    *  the inner array specifies the column, also starting at 0. The value is
-    *  the number in the square at this position on the board.
-    */
-    std::vector< std::vector< int>> game_board = initial;
+	/* The numbers and pencil marks on the board, reserved cells included.
+	 * The marks of a cell are kept while it has a number so that clearing it
+	 * brings them back.
+	 */
+	 BoardState state;
 
-    /* Represents each 9-cell block on the board. Each inner vector is one block.
-     * Blocks are numbered starting at 0 in the upper left, 3 directly below that,
-     * and 6 directly below 3. This is used to simplify checking board validity.
-     * Order in each block does not matter.
-     */
-    std::vector< std::vector< int>> blocks = initial;
+	/* The state when each open branch was made, innermost last. See branch.
+	 *
+	 */
+	 std::vector<BoardState> branches;
 
-    /* A lookup table giving the index of the inner vector for the blocks
-     * variable. Since we don't care about the exact position in the block,
-     * having the blocks index is good enough
+	/* Returns the state outside every branch, which is what gets saved
+	 *
+	 */
+	 const BoardState& committed_state (void);
+
+	/* (number, cell) Clears number from the marks of the cells that share a
+	 * unit with cell. Jigsaw games use the regions instead of the blocks.
+	 */
+	 void eliminate_mark (int, int);
+
+    /* A lookup table giving the index of the block a cell is in, stored with
+     * each reserved coordinate. Since we don't care about the exact position
+     * in the block, having the blocks index is good enough
      */
-     std::vector< std::vector< int>> blocksLookup =
-      {
-        {0, 1, 2},
-        {3, 4, 5},
-        {6, 7, 8}
-      };
+     static const std::vector< std::vector< int>> blocksLookup;
 
     /* Contains subarrays where the first two values are the x and y, or row and
 	 * column, coordinates of reserved cells, and the third is the block that
@@ -66,6 +72,73 @@ class Board {
 	 */
 	 bool reserved_set;
 
+	/* The puzzle made by generate_reserved, waiting for populate_reserved to
+	 * put its numbers on the board
+	 */
+	 Grid generated;
+
+	/* Whether generated holds a puzzle from import_puzzle that the next
+	 * generate_reserved should use instead of making one
+	 */
+	 bool imported;
+
+	/* The ID and solution of an imported puzzle that came with them, from
+	 * import_generated. imported_id is empty if the puzzle did not.
+	 */
+	 std::string imported_id;
+	 PackedGrid imported_solution;
+
+	/* ID of the puzzle being played, see get_puzzle_id. Empty for imported
+	 * puzzles and games saved before IDs were kept.
+	 */
+	 std::string puzzle_id;
+
+	/* The seed and Variant picked with set_puzzle_id for the next
+	 * generate_reserved, and whether there is one
+	 */
+	 uint64_t chosen_seed;
+	 int chosen_variant;
+	 bool seed_chosen;
+
+	/* The Symmetry from generator.h that new puzzles follow
+	 *
+	 */
+	 int symmetry;
+
+	/* The Variant from variants.h being played. Picks the rule set used by
+	 * is_win, generate_reserved and analyze.
+	 */
+	 int variant;
+
+	/* The Variant set with set_variant, which each new game starts from.
+	 * variant differs from it for a game that was resumed, imported, picked
+	 * by ID, or played as classic because no puzzle of it could be made.
+	 */
+	 int preferred_variant;
+
+	/* The Variant no puzzle could be made of for the game being played, or
+	 * -1 if it is the one asked for
+	 */
+	 int failed_variant;
+
+	/* Regions of a jigsaw game and cages of a killer game. Only used when
+	 * variant says so.
+	 */
+	 Jigsaw jigsaw;
+	 Killer killer;
+
+	/* (puzzle, limit, solution) Counts solutions of puzzle under the rules
+	 * of the current variant. See count_variant_solutions in variants.h .
+	 */
+	 int count_with_rules (const Grid&, int, Grid*);
+
+	/* (random, puzzle, solution) Makes a new puzzle for a variant other
+	 * than classic, along with its regions or cages, and stores its
+	 * solution. Returns false if every one of VARIANT_ATTEMPTS searches
+	 * gave up.
+	 */
+	 bool generate_variant (Random&, Grid&, Grid&);
+
     /* The starting time.
      *
      */
@@ -82,11 +155,11 @@ class Board {
      */
     double fastest_time;
 
-	 /* A keyfile for reading and writing user data. Initialized in the
-	  * instantiation of the board object. Each user has a group in the keyfile,
-	  * and therefore only one keyfile is needed for all users.
+	 /* A keyfile for reading and writing user data, shared with every other
+	  * board. Each user has a group in the keyfile, and therefore only one
+	  * keyfile is needed for all users. See load_user_data.
 	  */
-	 Glib::KeyFile user_data;
+	 Glib::KeyFile& user_data;
 
 	 /* The username of whoever is currently playing
 	  *
@@ -104,16 +177,71 @@ class Board {
 	  */
 	 bool load_from_user_data;
 
+	 /* What is known about the puzzle being played, from the analysis cache
+	  * or the solver. Set by analyze.
+	  */
+	 Analysis analysis;
+
+	 /* A solution to the puzzle being played, in board coordinates. Only
+	  * meaningful if analysis.solutions is not 0 or solution_stored is set.
+	  * Packed, so checking the board against it is a few word compares.
+	  */
+	 PackedGrid solution;
+
+	 /* Whether solution came with the puzzle, from the generator or the
+	  * user data file. It is then the only solution, and nothing needs to
+	  * be solved while the game is played.
+	  */
+	 bool solution_stored;
+
+	 /* Returns true if solution is known to be the only one, without
+	  * running the solver
+	  */
+	 bool knows_solution (void);
+
+	 /* Whether analysis and solution belong to the puzzle being played
+	  *
+	  */
+	 bool analyzed;
+
+	 /* The committed state as of the last save_data or autosave, so
+	  * autosave only has to write the cells changed since
+	  */
+	 BoardState saved;
+
+	 /* Counts the user's calls to save_data. Stored in the keyfile and at
+	  * the top of the autosave journal, so a journal written before the
+	  * last save is never replayed over it.
+	  */
+	 int journal_generation;
+
+	 /* Returns the path of the current user's autosave journal in the data
+	  * directory
+	  */
+	 std::string journal_path (void);
+
+	 /* Copies the committed state into saved
+	  *
+	  */
+	 void snapshot (void);
+
+	 /* Replays the current user's autosave journal over the board loaded
+	  * from the keyfile. Returns false if there is nothing to replay.
+	  */
+	 bool restore_autosave (void);
+
   public:
 
-    /* Initialize with start_time = 0 to signify a game has not yet been started.
-     * This is used so users cannot click "Begin" again to reset the start time.
+    /* (user_data) Initialize with start_time = 0 to signify a game has not yet
+     * been started. This is used so users cannot click "Begin" again to reset
+     * the start time. user_data must outlive the board.
      */
-    Board (void);
+    Board (Glib::KeyFile&);
 
     /* (number, outer, inner) Sets number in this board where outer specifies the
     *  position in the outer array and inner specifies the position in the inner
-    *  array. Returns void.
+    *  array. Placing a number clears it from the pencil marks of its peers.
+    *  Returns void.
     */
     void set_number (int, int, int);
 
@@ -123,6 +251,26 @@ class Board {
     */
     int get_number (int, int);
 
+    /* (outer, inner) Returns the pencil marks of the cell, with bit n - 1 set
+     * for each candidate n
+     */
+    unsigned short get_marks (int, int);
+
+    /* (marks, outer, inner) Replaces the pencil marks of the cell. Used by
+     * undo and redo.
+     */
+    void set_marks (unsigned short, int, int);
+
+    /* (number, outer, inner) Adds number to the pencil marks of the cell, or
+     * removes it if it is already there
+     */
+    void toggle_mark (int, int, int);
+
+    /* Returns true if any cell has a pencil mark
+     *
+     */
+    bool has_marks (void);
+
     /* (outer, inner) References index outer in reserved, and compares inner to
     *  the value retrieved. If inner == value, this is a reserved position. Returns
     *  true if the position is reserved, false otherwise.
@@ -144,11 +292,70 @@ class Board {
      */
     void start (void);
 
-    /* Check that the current board configuration is a valid win. This means that
-     * no row or column has any digit 1-9 more than once.
+    /* Check that the current board configuration is a valid win. This means
+     * the board is full and follows the rules of the variant being played.
+     * When the solution is known this is just a comparison with it.
      */
     bool is_win (void);
 
+    /* Returns the cells the user filled in with a number that doesn't match
+     * the solution. Empty if the solution isn't known.
+     */
+    CellSet check_progress (void);
+
+    /* (outer, inner, number) Stores the number the solution has in the
+     * cell. Returns false if the cell is reserved or the solution isn't
+     * known.
+     */
+    bool reveal_cell (int, int, int&);
+
+    /* Returns every cell of the board, reserved or not
+     *
+     */
+    Grid get_grid (void);
+
+    /* Returns a snapshot of the numbers and pencil marks. Cheap enough to
+     * take before every move, or to hand to the solver.
+     */
+    BoardState get_state (void);
+
+    /* (state) Puts back a snapshot from get_state. Reserved cells are part
+     * of it, so it must come from the same game.
+     */
+    void set_state (const BoardState&);
+
+    /* Empties every cell that isn't reserved in one pass. Pencil marks stay.
+     *
+     */
+    void clear_entries (void);
+
+    /* (numbers) Copies numbers into every cell that isn't reserved in one
+     * pass, eg. for a pasted grid, clearing pencil marks like set_number.
+     * Returns the number of cells that changed.
+     */
+    int fill_entries (const Grid&);
+
+    /* Opens a what-if branch: the board plays as usual, but the moves made
+     * in it can be dropped all at once with discard_branch. Branches nest.
+     * Saves and autosaves keep the state from before the first branch.
+     */
+    void branch (void);
+
+    /* Keeps the moves of the innermost branch, as if they were made outside
+     * it. Returns false if there is no branch.
+     */
+    bool keep_branch (void);
+
+    /* Puts the board back the way it was when the innermost branch was
+     * opened. Returns false if there is no branch.
+     */
+    bool discard_branch (void);
+
+    /* Returns the number of open branches
+     *
+     */
+    int branch_depth (void);
+
      /* Check if the current time is faster than the last fastest time. If it is,
       * return true and set the fastest time in the keyfile
       */
@@ -169,8 +376,8 @@ class Board {
 	 */
 	 void reset_time (void);
 
-	/* Resets the board to all 0's when a new game is started
-	 *
+	/* Resets the board to all 0's and clears the pencil marks and branches
+	 * when a new game is started
 	 */
 	 void reset_board (void);
 
@@ -194,8 +401,9 @@ class Board {
 	 */
 	 Glib::ustring get_username (void);
 
-	 /* Set the username for this session
-	  *
+	 /* Set the username for this board. Loads the user's paused game, if
+	  * they have one, with any moves autosaved since it was saved, and their
+	  * fastest time.
 	  */
 	 void set_username (Glib::ustring);
 
@@ -209,11 +417,24 @@ class Board {
 	  */
 	  void save_time (void);
 
-	 /* Save the data in the private keyfile variable to the text file. This is
-	  * called when the game is exited.
+	 /* Save the data in the shared keyfile to the text file. This is called
+	  * when the game is exited. The file is written in the background, see
+	  * saver.h .
 	  */
 	 void save_data (void);
 
+	 /* Adds the cells changed since the last save or autosave, and the game
+	  * time, to the end of the user's autosave journal. Writes nothing if no
+	  * cell changed. The journal is started over by save_data, and replayed
+	  * by set_username if the game was not saved since, eg. after a crash.
+	  */
+	 void autosave (void);
+
+	 /* Empties the user's autosave journal, once the game it belongs to is
+	  * won or replaced
+	  */
+	 void discard_autosave (void);
+
 	 /* Used to check if the time is being updated so that the clock on the game
 	  * board doesn't get improperly updated
 	  */
@@ -234,20 +455,127 @@ class Board {
 	  */
 	  void set_reserved (void);
 
-	 /* Generates coordinates of reserved cells. Ensures that there are at least
-	  * RESERVED cells reserved (ie if the same coords are generated it doesn't
-	  * matter)
+	 /* Generates a new puzzle and stores the coordinates of its clues as the
+	  * reserved cells. The puzzle has a unique solution, follows the symmetry
+	  * set with set_symmetry, and every clue is needed. It is made from a
+	  * fresh seed, or the one given to set_puzzle_id.
 	  */
 	  void generate_reserved (void);
 
-	  /* Generate numbers for each of the reserved cells. Ensure that the
-	   * numbers and coordinates follow the rules of sudoku1
+	  /* Returns the ID of the puzzle being played, eg. "KR-0F3K9QW2ZB1X4":
+	   * a letter for the variant and one for the symmetry, then the seed.
+	   * The same ID always generates the same puzzle. Empty if the puzzle was
+	   * not generated from a seed.
+	   */
+	   std::string get_puzzle_id (void);
+
+	  /* (id) Makes the next new game generate the puzzle with the ID, setting
+	   * its variant and symmetry. Returns false if id is not a puzzle ID.
+	   */
+	   bool set_puzzle_id (const std::string&);
+
+	  /* (puzzle) Makes puzzle the one the next new game uses, in place of a
+	   * generated one. Imported puzzles are classic, but later games go back
+	   * to the variant set with set_variant. Returns false if the clues break
+	   * the rules or the puzzle does not have exactly one solution.
+	   */
+	   bool import_puzzle (const Grid&);
+
+	  /* (puzzle, solution, id) Same as import_puzzle for a classic puzzle
+	   * already generated from id, such as a race puzzle made during the
+	   * countdown. Nothing is solved, and the game keeps id as its ID.
+	   */
+	   void import_generated (const Grid&, const Grid&, const std::string&);
+
+	  /* (path) Adds the puzzle being played to the end of path, in the format
+	   * of its extension. See collection.h . Returns false if it can't be
+	   * written.
+	   */
+	   bool export_puzzle (const std::string&);
+
+	  /* Puts the numbers of the generated puzzle in the reserved cells, then
+	   * analyzes and saves the new game
 	   */
 	   void populate_reserved (void);
 
+	  /* (symmetry) Sets the Symmetry from generator.h that new puzzles follow.
+	   * Rotational by default.
+	   */
+	   void set_symmetry (int);
+
+	  /* (variant) Sets the Variant from variants.h that new games use.
+	   * Classic by default. A resumed game keeps the variant it was saved with.
+	   */
+	   void set_variant (int);
+
+	  /* Returns the Variant of the game being played
+	   *
+	   */
+	   int get_variant (void);
+
+	  /* Returns the Variant the game being played was meant to have, if no
+	   * puzzle of it could be made and the classic puzzle of the same seed
+	   * is played instead. -1 otherwise.
+	   */
+	   int get_failed_variant (void);
+
+	  /* (row, col) Returns the style classes the board view draws the cell
+	   * with to show the regions of the variant, eg. diagonals or cages
+	   */
+	   std::vector<std::string> cell_classes (int, int);
+
+	  /* (row, col) Returns the region of the cell, 0 to 8: its jigsaw region
+	   * in a jigsaw game, otherwise its block
+	   */
+	   int region_of (int, int);
+
+	  /* (row, col) Returns text to show in the cell while it is empty. In a
+	   * killer game this is the sum of the cage the cell starts.
+	   */
+	   std::string cell_label (int, int);
+
 	  /* Returns the reserved member variable. Not to be confused with
 	   * check_reserved
 	   */
 	   std::vector< std::vector< int>> get_reserved (void);
 
+	  /* Returns the puzzle being played, meaning the reserved cells and their
+	   * numbers only. Cells the user filled in are left empty.
+	   */
+	   Grid get_puzzle (void);
+
+	  /* Returns the canonical hash of the puzzle being played. Puzzles that
+	   * are the same up to the symmetries of sudoku share a hash.
+	   */
+	   PuzzleHash puzzle_hash (void);
+
+	  /* Looks the puzzle being played up in the shared analysis cache, and
+	   * only runs the solver and rater if it is not there. Called whenever the
+	   * reserved cells change.
+	   */
+	   void analyze (void);
+
+	  /* Returns the number of solutions the puzzle has: 0, 1, or 2 meaning two
+	   * or more. -1 if a variant puzzle took too long to count.
+	   */
+	   int solution_count (void);
+
+	  /* Returns the difficulty of the puzzle being played as one of the
+	   * Difficulty values in rater.h
+	   */
+	   int get_difficulty (void);
+
+	  /* (row, col, number) Finds the first cell that is empty or does not
+	   * match the solution and stores its coordinates and correct number.
+	   * Returns false if there is no such cell or the puzzle has no solution.
+	   */
+	   bool get_hint (int&, int&, int&);
+
 };
+
+/* (user_data) Loads the user data file from the data directory into
+ * user_data, for the boards to share
+ */
+void load_user_data (Glib::KeyFile&);
+
+#endif
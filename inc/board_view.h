@@ -0,0 +1,191 @@
+/*
+* Last Modified: 10/19/26
+* Author: Alex Eastman
+* Contact: alexeast@buffalo.edu
+* Summary: The game board as one custom drawn widget. Paints all 81 cells
+*          with Cairo from digit images rendered once per cell size, handles
+*          keyboard and mouse input itself, and only repaints cells that
+*          changed. Pencil marks are drawn as a 3 by 3 grid in empty cells.
+*          Changes to many cells at once can be batched, so that they are
+*          repainted together in a single frame.
+*/
+
+#ifndef BOARD_VIEW_H
+#define BOARD_VIEW_H
+
+#include <gtkmm/drawingarea.h>
+#include <cairomm/surface.h>
+#include "board.h"
+
+/* Smallest side of a cell in pixels. The board grows with its allocation.
+ *
+ */
+#define CELL_SIZE 56
+
+class BoardView : public Gtk::DrawingArea {
+
+  private:
+
+	/* The board being shown. Read when drawing, never written. Changes the
+	 * user makes are sent through signal_cell_changed instead.
+	 */
+	Board* board;
+
+	/* The cell keyboard input goes to
+	 *
+	 */
+	int selected_row;
+	int selected_col;
+
+	/* Side of a cell, and the top left corner of the board within the
+	 * widget. Set when the widget is resized.
+	 */
+	int cell_size;
+	int origin_x;
+	int origin_y;
+
+	/* Numbers flag_cells marked wrong, 0 in other cells. A cell only shows
+	 * as wrong while it still holds the number.
+	 */
+	Grid flagged;
+
+	/* Open begin_batch calls, and the cells refreshed since the first one.
+	 * Only those cells are repainted, not the rectangle around them, since
+	 * a cell and its peers span the whole board.
+	 */
+	int batch_depth;
+	CellSet dirty;
+
+	/* Each digit drawn at the current cell size, once for reserved cells and
+	 * once for the user's. Painted onto cells instead of laying out text
+	 * every time. Index 0 is unused.
+	 */
+	Cairo::RefPtr<Cairo::ImageSurface> given_glyphs[10];
+	Cairo::RefPtr<Cairo::ImageSurface> user_glyphs[10];
+
+	/* Each digit at a third of the cell size, for pencil marks
+	 *
+	 */
+	Cairo::RefPtr<Cairo::ImageSurface> mark_glyphs[10];
+
+	/* (row, col, number) Emitted when the user types or clears a cell
+	 *
+	 */
+	sigc::signal<void, int, int, int> cell_changed;
+
+	/* (row, col, number) Emitted when the user toggles a pencil mark
+	 *
+	 */
+	sigc::signal<void, int, int, int> mark_toggled;
+
+	/* (numbers) Emitted when the user pastes a whole grid
+	 *
+	 */
+	sigc::signal<void, const Grid&> board_pasted;
+
+	/* (given) Renders the glyphs for reserved or user cells at cell_size
+	 *
+	 */
+	void render_glyphs (bool);
+
+	/* Renders the pencil mark glyphs at a third of cell_size
+	 *
+	 */
+	void render_marks (void);
+
+	/* (context, row, col) Paints one cell: background, then digit or pencil
+	 * marks, then the label of the cell if it has one
+	 */
+	void draw_cell (const Cairo::RefPtr<Cairo::Context>&, int, int);
+
+	/* (context) Draws the lines between cells, thicker around blocks or
+	 * jigsaw regions
+	 */
+	void draw_lines (const Cairo::RefPtr<Cairo::Context>&);
+
+	/* (row, col, other_row, other_col) Returns true if a thick line separates
+	 * the two neighbouring cells
+	 */
+	bool region_edge (int, int, int, int);
+
+	/* (text) Called with the clipboard text when the user pastes. Emits
+	 * board_pasted if it holds a grid.
+	 */
+	void on_paste_text (const Glib::ustring&);
+
+  protected:
+
+	bool on_draw (const Cairo::RefPtr<Cairo::Context>&) override;
+	bool on_key_press_event (GdkEventKey*) override;
+	bool on_button_press_event (GdkEventButton*) override;
+	void on_size_allocate (Gtk::Allocation&) override;
+
+  public:
+
+	/* (board) Creates a view of board. The board must outlive the view.
+	 *
+	 */
+	BoardView (Board&);
+
+	/* (board) Shows board instead, eg. when another player's game is
+	 * opened, and repaints. The board must outlive the view or be replaced.
+	 */
+	void show_board (Board&);
+
+	/* (row, col) Repaints just that cell. Call after its number changes.
+	 *
+	 */
+	void refresh_cell (int, int);
+
+	/* (row, col) Repaints the cells that share a unit with the cell. Call
+	 * after a number is placed, since it clears their pencil marks.
+	 */
+	void refresh_peers (int, int);
+
+	/* Repaints every cell. Call after a new game is loaded.
+	 *
+	 */
+	void refresh (void);
+
+	/* Starts a batch: refreshes until the matching end_batch only note the
+	 * cells, which are then invalidated together as one region. Batches
+	 * nest.
+	 */
+	void begin_batch (void);
+	void end_batch (void);
+
+	/* (row, col) Moves the selection to the cell
+	 *
+	 */
+	void select (int, int);
+
+	/* (row, col) Stores the selected cell
+	 *
+	 */
+	void get_selection (int&, int&);
+
+	/* (cells) Shows cells as wrong until they change, and clears any flags
+	 * from before
+	 */
+	void flag_cells (const CellSet&);
+
+	/* Emitted with (row, col, number) when the user changes a cell, with 0
+	 * for a cleared cell. The handler should update the board and call
+	 * refresh_cell.
+	 */
+	sigc::signal<void, int, int, int>& signal_cell_changed (void);
+
+	/* Emitted with (row, col, number) when the user holds Control and types
+	 * a number into an empty cell. The handler should toggle the mark on the
+	 * board and call refresh_cell.
+	 */
+	sigc::signal<void, int, int, int>& signal_mark_toggled (void);
+
+	/* Emitted with the numbers when the user pastes a grid with Control+V,
+	 * 81 digits with '0' or '.' for empty cells, ignoring spaces and line
+	 * breaks. The handler should fill the board in and call refresh.
+	 */
+	sigc::signal<void, const Grid&>& signal_board_pasted (void);
+};
+
+#endif
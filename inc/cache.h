@@ -0,0 +1,161 @@
+/*
+* Last Modified: 10/19/26
+* Author: Alex Eastman
+* Contact: alexeast@buffalo.edu
+* Summary: Two tier cache of puzzle analysis (solution, solution count and
+*          difficulty) keyed by canonical puzzle hash. The first tier is a
+*          bounded in-memory LRU, the second is one small file per puzzle on
+*          disk.
+*/
+
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "canonical.h"
+
+#define CACHE_CAPACITY 1024
+#define CACHE_DIRECTORY "cache"  // Inside data_directory() from paths.h
+
+/* Everything known about a puzzle. The solution is in the canonical frame of
+ * the puzzle, so it is shared by every puzzle with the same hash. The rating
+ * fields match Rating in rater.h .
+ */
+struct Analysis {
+	PuzzleHash hash;
+
+	/* 0 if the puzzle cannot be solved, 1 if it has a unique solution and 2
+	 * if it has two or more
+	 */
+	int solutions;
+
+	/* Only meaningful if solutions is not 0
+	 *
+	 */
+	Grid solution;
+
+	/* Whether the fields below have been filled in by the rater
+	 *
+	 */
+	bool rated;
+	int difficulty;
+	int hardest;
+	int steps;
+};
+
+/* Counters for how well the cache is doing
+ *
+ */
+struct CacheStats {
+	long memory_hits;
+	long disk_hits;
+	long misses;
+	long evictions;
+};
+
+class AnalysisCache {
+
+  private:
+
+	/* Most recently used analysis at the front
+	 *
+	 */
+	std::list<Analysis> recent;
+
+	/* Finds an analysis in recent by its hash
+	 *
+	 */
+	std::unordered_map< PuzzleHash, std::list<Analysis>::iterator, PuzzleHashHasher> index;
+
+	/* Maximum number of entries kept in memory
+	 *
+	 */
+	size_t capacity;
+
+	/* Where the disk tier is kept. Empty to keep the cache in memory only.
+	 *
+	 */
+	std::string directory;
+
+	CacheStats stats;
+
+	/* Guards everything above. Batch rating uses the cache from many threads.
+	 *
+	 */
+	std::mutex lock;
+
+	/* (hash) Path of the file holding the analysis for hash
+	 *
+	 */
+	std::string path_for (const PuzzleHash&);
+
+	/* (analysis) Moves or inserts analysis at the front of recent, evicting
+	 * the least recently used entry if over capacity. Caller holds lock.
+	 */
+	void remember (const Analysis&);
+
+	/* (hash, analysis) Reads the analysis for hash from disk. Returns false
+	 * if it is not there.
+	 */
+	bool read_from_disk (const PuzzleHash&, Analysis&);
+
+	/* (analysis) Writes the analysis to disk
+	 *
+	 */
+	void write_to_disk (const Analysis&);
+
+  public:
+
+	/* (capacity, directory) Creates a cache holding at most capacity entries
+	 * in memory, backed by files under directory
+	 */
+	AnalysisCache (size_t, std::string);
+
+	/* (hash, analysis) Looks for the analysis of hash in memory, then on
+	 * disk. Returns true and fills analysis if found.
+	 */
+	bool lookup (const PuzzleHash&, Analysis&);
+
+	/* (analysis) Stores analysis in both tiers, replacing what was there
+	 *
+	 */
+	void store (const Analysis&);
+
+	/* Returns a copy of the hit, miss and eviction counters
+	 *
+	 */
+	CacheStats get_stats (void);
+
+	/* Returns hits over lookups, or 0 if nothing has been looked up
+	 *
+	 */
+	double hit_rate (void);
+
+	/* Drops every entry held in memory. The disk tier is kept.
+	 *
+	 */
+	void clear_memory (void);
+};
+
+/* The cache shared by the game, backed by CACHE_DIRECTORY in the data
+ * directory
+ */
+AnalysisCache& shared_cache (void);
+
+/* (puzzle, cache, solution) Returns the analysis of puzzle, running the solver
+ * only if the cache does not have it. If the puzzle can be solved, its
+ * solution in the frame of puzzle is stored in solution.
+ */
+Analysis analyze_puzzle (const Grid&, AnalysisCache&, Grid&);
+
+/* (puzzle, solution, cache) Same as analyze_puzzle for a puzzle whose only
+ * solution is already known, such as a generated one. Never runs the
+ * solver: on a cache miss the known solution is stored instead, so rating
+ * it does not solve it either.
+ */
+Analysis analyze_solved_puzzle (const Grid&, const Grid&, AnalysisCache&);
+
+#endif
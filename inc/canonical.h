@@ -0,0 +1,107 @@
+/*
+* Last Modified: 10/19/26
+* Author: Alex Eastman
+* Contact: alexeast@buffalo.edu
+* Summary: Canonical form of a puzzle under the sudoku symmetry group, and a
+*          stable 128 bit hash of that form used to dedupe puzzles and to key
+*          caches.
+*/
+
+#ifndef CANONICAL_H
+#define CANONICAL_H
+
+#include <stdint.h>
+#include <string>
+#include "grid.h"
+
+/* A 128 bit hash of a canonical grid. Two puzzles that are the same up to
+ * band/stack permutation, row/column permutation within bands/stacks,
+ * transposition and relabeling of digits have the same hash.
+ */
+struct PuzzleHash {
+	uint64_t high;
+	uint64_t low;
+
+	bool operator== (const PuzzleHash& other) const
+	{
+		return high == other.high && low == other.low;
+	}
+
+	bool operator!= (const PuzzleHash& other) const
+	{
+		return !(*this == other);
+	}
+
+	bool operator< (const PuzzleHash& other) const
+	{
+		return high < other.high || (high == other.high && low < other.low);
+	}
+};
+
+/* Lets PuzzleHash be used as the key of unordered containers
+ *
+ */
+struct PuzzleHashHasher {
+	size_t operator() (const PuzzleHash& hash) const
+	{
+		return (size_t) (hash.high ^ (hash.low * 0x9e3779b97f4a7c15ULL));
+	}
+};
+
+/* Maps a grid onto its canonical form. The canonical cell at (row, column) is
+ * digits[ source[rows[row]][columns[column]] ], where source is the original
+ * grid, transposed first if transposed is set. digits[0] is always 0.
+ */
+struct Transform {
+	bool transposed;
+	unsigned char rows[9];
+	unsigned char columns[9];
+	unsigned char digits[10];
+};
+
+/* The result of canonicalize. grid is the lexicographically smallest grid
+ * (empty cells count as 0) reachable from the input under the symmetry group,
+ * and transform is one of the symmetries that reaches it.
+ */
+struct CanonicalForm {
+	Grid grid;
+	Transform transform;
+	PuzzleHash hash;
+};
+
+/* (puzzle) Finds the canonical form of the puzzle. Uses a row by row search
+ * that only keeps the partial symmetries tied for the smallest rows so far.
+ */
+CanonicalForm canonicalize (const Grid&);
+
+/* (puzzle) Shortcut for canonicalize(puzzle).hash
+ *
+ */
+PuzzleHash canonical_hash (const Grid&);
+
+/* (grid) Hashes a grid as is, without canonicalizing it first
+ *
+ */
+PuzzleHash hash_grid (const Grid&);
+
+/* (transform, grid) Applies the transform to grid. Used to carry a solution
+ * into the canonical frame of its puzzle.
+ */
+Grid apply_transform (const Transform&, const Grid&);
+
+/* (transform, grid) Undoes apply_transform. Used to carry a canonical
+ * solution back into the frame of the puzzle on the board.
+ */
+Grid invert_transform (const Transform&, const Grid&);
+
+/* (hash) Returns the hash as 32 lowercase hex characters
+ *
+ */
+std::string hash_to_string (PuzzleHash);
+
+/* (text, hash) Parses 32 hex characters into hash. Returns false if the text
+ * is malformed.
+ */
+bool hash_from_string (const std::string&, PuzzleHash&);
+
+#endif
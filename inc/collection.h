@@ -0,0 +1,131 @@
+/*
+* Last Modified: 10/19/26
+* Author: Alex Eastman
+* Contact: alexeast@buffalo.edu
+* Summary: Reading and writing puzzle collections in the common text formats:
+*          one 81 character puzzle per line, SadMan Software .sdm collections
+*          and .sdk grids. A collection is memory mapped and only the start of
+*          each puzzle is indexed, so large files open quickly and a puzzle
+*          is parsed straight from the mapped file when it is asked for.
+*/
+
+#ifndef COLLECTION_H
+#define COLLECTION_H
+
+#include <string>
+#include <vector>
+#include <stddef.h>
+#include "grid.h"
+
+/* Collection file formats
+ *
+ */
+enum PuzzleFormat {
+	FORMAT_UNKNOWN,
+	FORMAT_LINE,  // 81 characters per line, '.' or '0' for empty cells
+	FORMAT_SDM,   // 81 characters per line, '0' for empty cells
+	FORMAT_SDK    // 9 lines of 9 characters per puzzle, '.' for empty cells
+};
+
+class Collection {
+
+  private:
+
+	/* The mapped file, or null if nothing is open
+	 *
+	 */
+	const char* data;
+	size_t length;
+
+	/* The PuzzleFormat of the open file
+	 *
+	 */
+	int format;
+
+	/* Offset into data of the first cell of each puzzle
+	 *
+	 */
+	std::vector<size_t> offsets;
+
+	/* Finds the puzzles of a file with one puzzle per line
+	 *
+	 */
+	void index_lines (void);
+
+	/* Finds the puzzles of an .sdk file, skipping '#' comment lines and the
+	 * '|', '-' and '+' some files draw between blocks
+	 */
+	void index_grids (void);
+
+  public:
+
+	Collection (void);
+	~Collection (void);
+
+	Collection (const Collection&) = delete;
+	Collection& operator= (const Collection&) = delete;
+
+	/* (path) Maps the file and indexes its puzzles, closing any file already
+	 * open. The format comes from the extension, or from the first puzzle if
+	 * the extension is not known. Returns false if the file can't be read.
+	 */
+	bool open (const std::string&);
+
+	/* (path) Like open, but without indexing. For when the offsets are
+	 * already known, eg. from a library index. Only puzzle_at works after.
+	 */
+	bool map (const std::string&);
+
+	/* Unmaps the file
+	 *
+	 */
+	void close (void);
+
+	/* Returns the number of puzzles found
+	 *
+	 */
+	int size (void);
+
+	/* Returns the PuzzleFormat of the open file
+	 *
+	 */
+	int get_format (void);
+
+	/* (index, puzzle) Parses puzzle number index into puzzle. Returns false
+	 * if index is out of range.
+	 */
+	bool puzzle (int, Grid&);
+
+	/* (index) Returns the offset of puzzle number index in the file
+	 *
+	 */
+	size_t offset (int);
+
+	/* (offset, puzzle) Parses the puzzle starting offset bytes into the file.
+	 * Returns false if there is no whole puzzle there.
+	 */
+	bool puzzle_at (size_t, Grid&);
+};
+
+/* (paths, puzzles) Adds every puzzle in the files to puzzles, in order.
+ * Returns false if a file could not be read.
+ */
+bool read_puzzles (const std::vector<std::string>&, std::vector<Grid>&);
+
+/* (path) Returns the PuzzleFormat matching the extension of path, eg.
+ * FORMAT_SDK for "hard.sdk". FORMAT_UNKNOWN if there is no match.
+ */
+int format_from_path (const std::string&);
+
+/* (puzzle, format) Returns puzzle written in format, ending in a newline.
+ * FORMAT_UNKNOWN is written as FORMAT_LINE.
+ */
+std::string puzzle_text (const Grid&, int);
+
+/* (path, puzzles, format, append) Writes puzzles to path in format, after
+ * what is already there if append is set. Puzzles in an .sdk file are
+ * separated by a blank line. Returns false if the file can't be written.
+ */
+bool write_puzzles (const std::string&, const std::vector<Grid>&, int, bool);
+
+#endif
@@ -0,0 +1,56 @@
+/*
+* Last Modified: 10/19/26
+* Author: Alex Eastman
+* Contact: alexeast@buffalo.edu
+* Summary: Puzzle generation. Makes a random solution, then removes clues in
+*          symmetric groups for as long as the solution stays unique, and
+*          only accepts puzzles where every clue is needed.
+*/
+
+#ifndef GENERATOR_H
+#define GENERATOR_H
+
+#include <vector>
+#include "grid.h"
+#include "random.h"
+
+/* Patterns the clues of a generated puzzle can follow
+ *
+ */
+enum Symmetry {
+	SYMMETRY_NONE,
+	SYMMETRY_ROTATIONAL,  // Unchanged by a half turn
+	SYMMETRY_DIAGONAL,    // Unchanged by flipping over the main diagonal
+	SYMMETRY_MIRROR       // Unchanged by flipping left to right
+};
+
+/* Tries this many solutions for a symmetric minimal puzzle. If none gives
+ * one, clues of the last are removed one at a time, breaking the symmetry,
+ * until every clue left is needed.
+ */
+#define GENERATE_ATTEMPTS 200
+
+/* (symmetry) Returns the groups of cells that must be given or removed
+ * together to keep the symmetry. Every cell is in exactly one group.
+ */
+std::vector< std::vector<int>> symmetry_orbits (int);
+
+/* (solution, random) Fills solution with a random complete grid
+ *
+ */
+void random_solution (Grid&, Random&);
+
+/* (puzzle, threads) Returns true if removing any single clue from puzzle
+ * gives more than one solution. The checks are spread over threads (0 for
+ * one per core) and all stop as soon as one clue turns out not to be needed.
+ */
+bool is_minimal (const Grid&, int);
+
+/* (symmetry, threads, solution, random) Generates a puzzle with a unique
+ * solution whose clues follow symmetry and are all needed. The solution is
+ * stored in solution if it is not null. The same random state always gives
+ * the same puzzle, whatever the number of threads.
+ */
+Grid generate_puzzle (int, int, Grid*, Random&);
+
+#endif
@@ -0,0 +1,163 @@
+/*
+* Last Modified: 10/19/26
+* Author: Alex Eastman
+* Contact: alexeast@buffalo.edu
+* Summary: Compact, trivially copyable 9x9 grid used by the solver side of the
+*          game (canonicalization, caching, rating, generation). Does not
+*          depend on glibmm so that command line tools can link against it.
+*/
+
+#ifndef GRID_H
+#define GRID_H
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+/* Cells are stored row major, so the cell at (row, column) is at index
+ * row * 9 + column. A value of 0 is an empty cell, otherwise 1-9.
+ */
+struct Grid {
+	unsigned char cells[81];
+};
+
+/* Smallest and largest box order of a LargeGrid
+ *
+ */
+#define MIN_ORDER 2
+#define MAX_ORDER 5
+
+/* A puzzle whose boxes are order by order cells, so order 3 is the usual
+ * 9x9, 4 is 16x16 and 5 is 25x25. Cells are row major like Grid, 0 for an
+ * empty cell, otherwise 1 to order * order. Only the solver handles these.
+ */
+struct LargeGrid {
+	int order;
+	std::vector<unsigned char> cells;
+};
+
+/* Everything a player has put on a board: its numbers, and pencil marks with
+ * bit n - 1 set for each candidate n, both row major. Trivially copyable like
+ * Grid, so a snapshot is one copy of a few hundred bytes however the board
+ * got there, and numbers can go straight to the solver.
+ */
+struct BoardState {
+	Grid numbers;
+	unsigned short marks[81];
+};
+
+/* A set of cells as a bitset, bit i for cell i of a Grid
+ *
+ */
+struct CellSet {
+	uint64_t low;   // Cells 0-63
+	uint64_t high;  // Cells 64-80
+};
+
+/* A Grid at four bits a cell, cell i in bits 4 * (i % 16) up of word
+ * i / 16. Half the size of a Grid, and two can be compared sixteen cells
+ * at a time.
+ */
+struct PackedGrid {
+	uint64_t words[6];
+};
+
+/* Lookup tables for the units of the board. Units 0-8 are rows, 9-17 are
+ * columns and 18-26 are blocks, numbered the same way as in board.h .
+ */
+struct UnitTables {
+	/* The cells of each unit
+	 *
+	 */
+	unsigned char units[27][9];
+
+	/* The row, column and block unit of each cell
+	 *
+	 */
+	unsigned char units_of[81][3];
+
+	/* The 20 cells that share a row, column or block with each cell
+	 *
+	 */
+	unsigned char peers[81][20];
+
+	UnitTables (void);
+};
+
+/* Returns the unit tables, built the first time this is called
+ *
+ */
+const UnitTables& unit_tables (void);
+
+/* Returns a grid with every cell empty
+ *
+ */
+Grid empty_grid (void);
+
+/* Returns a board state with every cell empty and no pencil marks
+ *
+ */
+BoardState empty_state (void);
+
+/* (grid) Returns the number of non-empty cells in grid
+ *
+ */
+int count_givens (const Grid&);
+
+/* (line, grid) Parses an 81 character line into grid. Digits 1-9 are givens,
+ * and '0' or '.' are empty cells. Returns false if the line is malformed.
+ */
+bool grid_from_string (const std::string&, Grid&);
+
+/* (grid) Returns the grid as an 81 character line with '.' for empty cells
+ *
+ */
+std::string grid_to_string (const Grid&);
+
+/* (line, grid) Parses a line of 16, 81, 256 or 625 characters into grid,
+ * picking the order from the length. Values above 9 are letters, A for 10.
+ * '0' and '.' are empty cells. Returns false if the line is malformed.
+ */
+bool large_grid_from_string (const std::string&, LargeGrid&);
+
+/* (grid) Returns the grid in the format read by large_grid_from_string, with
+ * '.' for empty cells
+ */
+std::string large_grid_to_string (const LargeGrid&);
+
+/* (a, b) Returns true if both grids have the same value in every cell
+ *
+ */
+bool grid_equal (const Grid&, const Grid&);
+
+/* (set, cell) Returns true if cell is in set
+ *
+ */
+bool in_cell_set (const CellSet&, int);
+
+/* (grid) Returns grid packed, see PackedGrid
+ *
+ */
+PackedGrid pack_grid (const Grid&);
+
+/* (packed) Returns the grid packed holds
+ *
+ */
+Grid unpack_grid (const PackedGrid&);
+
+/* (packed, cell) Returns the value of one cell of packed
+ *
+ */
+int packed_cell (const PackedGrid&, int);
+
+/* (entries, solution) Returns the cells that are filled in entries but
+ * hold a different value in solution
+ */
+CellSet wrong_cells (const PackedGrid&, const PackedGrid&);
+
+/* (packed) Returns the empty cells of packed
+ *
+ */
+CellSet empty_cells (const PackedGrid&);
+
+#endif
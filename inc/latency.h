@@ -0,0 +1,76 @@
+/*
+* Last Modified: 10/19/26
+* Author: Alex Eastman
+* Contact: alexeast@buffalo.edu
+* Summary: Rolling histogram of input latency. main.cpp records the time from
+*          a digit keypress to the next painted frame, and reports it on exit
+*          or in a debug label when SUDOKU_LATENCY is set.
+*/
+
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <string>
+
+/* Number of most recent samples the histogram covers
+ *
+ */
+#define LATENCY_WINDOW 512
+
+/* Number of histogram buckets. See latency_bucket_limits in latency.cpp .
+ *
+ */
+#define LATENCY_BUCKETS 10
+
+class LatencyHistogram {
+
+  private:
+
+	/* The last LATENCY_WINDOW samples in microseconds. next is where the
+	 * next one goes, wrapping around and overwriting the oldest.
+	 */
+	long samples[LATENCY_WINDOW];
+	int next;
+	int filled;
+
+	/* Every sample ever recorded, not just the ones in the window
+	 *
+	 */
+	long total;
+
+  public:
+
+	LatencyHistogram (void);
+
+	/* (micros) Adds a sample, dropping the oldest if the window is full
+	 *
+	 */
+	void record (long);
+
+	/* Returns the number of samples in the window
+	 *
+	 */
+	int size (void);
+
+	/* (fraction) Returns the sample below which fraction of the window
+	 * lies, eg. 0.95 for the 95th percentile. 0 if there are no samples.
+	 */
+	long percentile (double);
+
+	/* (counts) Fills counts[LATENCY_BUCKETS] with the number of samples in
+	 * the window that fall in each bucket
+	 */
+	void buckets (int*);
+
+	/* Returns one line with the sample count and the 50th, 95th and 99th
+	 * percentiles in milliseconds. Short enough for a label.
+	 */
+	std::string summary (void);
+
+	/* Returns the summary followed by one line per bucket with a bar
+	 * showing its share of the window
+	 */
+	std::string report (void);
+};
+
+#endif
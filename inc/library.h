@@ -0,0 +1,124 @@
+/*
+* Last Modified: 10/19/26
+* Author: Alex Eastman
+* Contact: alexeast@buffalo.edu
+* Summary: A puzzle collection with a sidecar index, so any puzzle can be
+*          opened by number, difficulty or canonical hash without reading
+*          the rest of the file. The index is kept next to the collection as
+*          <collection>.idx and rebuilt when the collection changes. It holds
+*          the offset, hash and rating of every puzzle, the puzzle numbers
+*          grouped by difficulty, and the puzzle numbers sorted by hash.
+*/
+
+#ifndef LIBRARY_H
+#define LIBRARY_H
+
+#include <atomic>
+#include <string>
+#include <stdint.h>
+#include "collection.h"
+#include "canonical.h"
+#include "cache.h"
+
+/* Added to the path of a collection to get the path of its index
+ *
+ */
+#define LIBRARY_EXTENSION ".idx"
+
+/* One group of puzzle numbers per Difficulty in rater.h, UNRATED first
+ *
+ */
+#define LIBRARY_BUCKETS 6
+
+struct LibraryHeader;
+struct LibraryEntry;
+
+class Library {
+
+  private:
+
+	/* The collection, mapped but not indexed, since the offsets are in the
+	 * index
+	 */
+	Collection collection;
+
+	/* The mapped index file, and the parts of it. Null if nothing is open.
+	 *
+	 */
+	const char* index;
+	size_t index_length;
+	const LibraryHeader* header;
+	const LibraryEntry* entries;
+	const uint32_t* by_difficulty;
+	const uint32_t* by_hash;
+
+	/* (path) Maps the index of the collection at path. Returns false if
+	 * there is none, or it was made from a different version of the file.
+	 */
+	bool map_index (const std::string&);
+
+  public:
+
+	Library (void);
+	~Library (void);
+
+	Library (const Library&) = delete;
+	Library& operator= (const Library&) = delete;
+
+	/* (path, build) Opens the collection at path using its index, closing
+	 * any library already open. If the index is missing or out of date it
+	 * is built first when build is set, which rates every puzzle. Returns
+	 * false if the library could not be opened.
+	 */
+	bool open (const std::string&, bool);
+
+	/* Unmaps the collection and its index
+	 *
+	 */
+	void close (void);
+
+	/* Returns the number of puzzles in the library
+	 *
+	 */
+	int size (void);
+
+	/* (number, puzzle) Reads puzzle number number, counting from 0. Returns
+	 * false if there is no such puzzle.
+	 */
+	bool puzzle (int, Grid&);
+
+	/* (number) Returns the Difficulty of puzzle number number
+	 *
+	 */
+	int difficulty (int);
+
+	/* (number) Returns the rater's score of puzzle number number
+	 *
+	 */
+	int score (int);
+
+	/* (difficulty) Returns how many puzzles have the Difficulty
+	 *
+	 */
+	int count_with (int);
+
+	/* (difficulty, n) Returns the number of the nth puzzle with the
+	 * Difficulty, in file order, or -1 if there are not that many
+	 */
+	int nth_with (int, int);
+
+	/* (hash) Returns the number of the first puzzle with the canonical hash,
+	 * or -1 if the library does not have it
+	 */
+	int find (const PuzzleHash&);
+};
+
+/* (path, threads, cache, cancel) Rates every puzzle in the collection at
+ * path with threads threads (0 for one per core) and writes its index.
+ * cache may be null. Gives up, writing nothing, as soon as cancel is set by
+ * another thread. cancel may be null. Returns false if the collection can't
+ * be read, the index can't be written or the build was cancelled.
+ */
+bool build_library_index (const std::string&, int, AnalysisCache*, const std::atomic<bool>*);
+
+#endif
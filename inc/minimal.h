@@ -0,0 +1,138 @@
+/*
+* Last Modified: 10/19/26
+* Author: Alex Eastman
+* Contact: alexeast@buffalo.edu
+* Summary: Exhaustive search for the minimal puzzles with few clues that a
+*          solution grid has. A set of cells is unavoidable if its digits can be
+*          swapped around to give another valid grid, so every puzzle of the
+*          grid needs a clue in each one. The search only tries clue sets
+*          that hit every unavoidable set it knows, learns a new one each
+*          time a candidate turns out to have two solutions, and checkpoints
+*          its progress so a long run can be resumed.
+*/
+
+#ifndef MINIMAL_H
+#define MINIMAL_H
+
+#include <string>
+#include <vector>
+#include <functional>
+#include "grid.h"
+
+/* Solutions listed per group of digits when looking for unavoidable sets
+ *
+ */
+#define UNAVOIDABLE_SOLUTION_LIMIT 4096
+
+/* The biggest unavoidable sets the search starts with. Bigger ones rarely
+ * prune anything the smaller ones don't, but every node has to look at them.
+ */
+#define MAX_UNAVOIDABLE_SIZE 16
+
+/* The most clues the search takes
+ *
+ */
+#define MAX_SEARCH_CLUES 40
+
+/* (solution) Returns unavoidable sets of solution of up to
+ * MAX_UNAVOIDABLE_SIZE cells, smallest first, with no set containing another. They are found by emptying the cells of two,
+ * three and four digits at a time and comparing every other way to fill
+ * them in. Always the same sets for the same grid.
+ */
+std::vector<CellSet> find_unavoidable_sets (const Grid&);
+
+/* A search for every minimal puzzle of one solution grid with up to some
+ * number of clues, that is every puzzle none of whose clues can be removed. The search tree is cut at a shallow depth into tasks, which the
+ * threads take in order. Each finished task, with the puzzles found in it,
+ * is added to the checkpoint file if there is one, and a search started
+ * again with the same file skips the tasks it lists.
+ */
+class MinimalSearch {
+
+  private:
+
+	Grid solution;
+	Grid base;
+	int clues;
+
+	/* What the search knew when it started
+	 *
+	 */
+	std::vector<CellSet> sets;
+
+	/* Roots of the subtrees the threads search. clues_set is the clues
+	 * chosen so far and dead the cells that may no longer be chosen.
+	 */
+	struct Task {
+		CellSet clues_set;
+		CellSet dead;
+		int count;
+	};
+	std::vector<Task> tasks;
+
+	/* Whether each task was finished, in this run or an earlier one. Chars
+	 * rather than bools, since threads set them side by side.
+	 */
+	std::vector<char> finished;
+
+	/* Puzzles read back from the checkpoint
+	 *
+	 */
+	std::vector<Grid> resumed;
+
+	/* Path of the checkpoint file, and whether it has its first line yet
+	 *
+	 */
+	std::string checkpoint;
+	bool started;
+
+	/* (depth) Cuts the search tree into tasks at depth clues past the
+	 * clues of base
+	 */
+	void make_tasks (int);
+
+	/* Returns the first line of the checkpoint
+	 *
+	 */
+	std::string checkpoint_header (void);
+
+  public:
+
+	/* (solution, clues, checkpoint) Prepares a search of solution for
+	 * puzzles with clues clues or fewer. checkpoint may be empty to not
+	 * keep one.
+	 */
+	MinimalSearch (const Grid&, int, const std::string&);
+
+	/* (solution, base, clues, checkpoint) Same as above, but only for
+	 * puzzles that have every clue of base, which must be a puzzle of
+	 * solution. Much quicker when base has most of the clues.
+	 */
+	MinimalSearch (const Grid&, const Grid&, int, const std::string&);
+
+	/* Reads the checkpoint, if it exists. Returns false if it belongs to a
+	 * different search or can't be read.
+	 */
+	bool resume (void);
+
+	/* (threads, found, finished) Searches every task not yet finished on
+	 * threads threads (0 for one per core), calling found with each puzzle
+	 * and finished after each task, from one thread at a time. Puzzles from
+	 * the checkpoint are passed to found first. finished may be empty.
+	 * Returns false if the checkpoint could not be written.
+	 */
+	bool run (int, const std::function<void(const Grid&)>&, const std::function<void(void)>&);
+
+	/* Returns the number of tasks, and how many are finished
+	 *
+	 */
+	int task_count (void);
+	int finished_count (void);
+
+	/* Returns how many unavoidable sets the search started with
+	 *
+	 */
+	int set_count (void);
+};
+
+#endif
@@ -0,0 +1,32 @@
+/*
+* Last Modified: 10/19/26
+* Author: Alex Eastman
+* Contact: alexeast@buffalo.edu
+* Summary: Where the game keeps its files, so it works from any directory.
+*          User data and the analysis cache live in one data directory. The
+*          UI and styles are compiled into the executable (see
+*          res/sudoku.gresource.xml).
+*/
+
+#ifndef PATHS_H
+#define PATHS_H
+
+#include <string>
+
+/* Prefix of every file in the compiled resource bundle
+ *
+ */
+#define RESOURCE_PREFIX "/alexeast/sudoku/"
+
+/* Returns the data directory, creating it if needed. This is SUDOKU_DATA_DIR
+ * if set, otherwise sudoku in XDG_DATA_HOME or ~/.local/share . The result is
+ * worked out once.
+ */
+std::string data_directory (void);
+
+/* (name) Returns the path of name inside the data directory
+ *
+ */
+std::string data_path (const std::string&);
+
+#endif
@@ -0,0 +1,299 @@
+/*
+* Last Modified: 10/19/26
+* Author: Alex Eastman
+* Contact: alexeast@buffalo.edu
+* Summary: Head to head races on one puzzle, for players on one machine or a
+*          LAN. A host hands every player the same puzzle ID, starts them all
+*          at the same moment and passes on how far each has got. Players
+*          connect over TCP and send one message per line:
+*
+*              JOIN name           -> WELCOME id, before the race starts
+*              SYNC t              -> SYNC t host_t
+*              PROGRESS filled     how many cells the player has filled
+*              DONE board          the finished board
+*
+*          and the host sends every player:
+*
+*              PLAYER name              someone joined
+*              START host_t             when the race starts
+*              PROGRESS name filled     someone filled or cleared a cell
+*              FINISHED name ms place   someone solved the puzzle
+*
+*          A player whose DONE board is not the solution gets WRONG, and a
+*          bad message gets "ERR reason". Times are race_clock microseconds
+*          of whoever sent them. Players turn START into their own clock
+*          with the offset SYNC measured, so everyone starts within half a
+*          round trip of each other however far apart the clocks are. Only
+*          classic puzzles race, like the puzzle server.
+*/
+
+#ifndef RACE_H
+#define RACE_H
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include "grid.h"
+
+/* Port races use unless told otherwise
+ *
+ */
+#define RACE_PORT 7249
+
+/* Longest message accepted. Longer ones close the connection.
+ *
+ */
+#define RACE_MAX_LINE 512
+
+/* SYNC round trips each player makes. The one that came back fastest gives
+ * the clock offset. The host doesn't start the race until every player has
+ * made them all.
+ */
+#define RACE_SYNC_ROUNDS 5
+
+/* Microseconds on a clock that only goes forward. Its zero differs between
+ * machines.
+ */
+long race_clock (void);
+
+/* (puzzle_id, puzzle, solution) Generates the puzzle of a classic puzzle
+ * ID and its solution, the same ones the game makes from it. Returns false
+ * if id is not a classic puzzle ID.
+ */
+bool race_puzzle (const std::string&, Grid&, Grid&);
+
+/* A player who finished, in the order they did
+ *
+ */
+struct RaceResult {
+	std::string name;
+	long milliseconds;
+	int place;
+};
+
+class RaceHost {
+
+  private:
+
+	/* A connection. name is empty until the player joins, and syncs is
+	 * how many SYNC messages they have sent.
+	 */
+	struct Player {
+		int fd;
+		std::string name;
+		std::string input;
+		std::string output;
+		int syncs;
+		bool finished;
+		bool closed;
+	};
+
+	std::string puzzle_id;
+	PackedGrid solution;
+
+	/* The listening socket, -1 if not open
+	 *
+	 */
+	int listener;
+
+	std::vector<Player> players;
+	std::vector<RaceResult> results;
+
+	/* When the race starts on race_clock, 0 until every player is in
+	 *
+	 */
+	long start_time;
+
+	/* Set to end run. Safe to set from a signal handler.
+	 *
+	 */
+	std::atomic<bool> stopping;
+
+	/* Accepts every waiting player
+	 *
+	 */
+	void accept_players (void);
+
+	/* (player) Reads what the player sent and handles each whole line.
+	 * Marks the player closed if they went away.
+	 */
+	void read_player (Player&);
+
+	/* (player, line) Handles one message
+	 *
+	 */
+	void handle (Player&, const std::string&);
+
+	/* (player, line) Queues a line for the player and sends as much as
+	 * the socket takes
+	 */
+	void send_line (Player&, const std::string&);
+
+	/* (line) Sends a line to every player who joined
+	 *
+	 */
+	void broadcast (const std::string&);
+
+	/* Returns the number of players who joined and are still connected
+	 *
+	 */
+	int joined_count (void);
+
+	/* Returns the number of those who have also made every SYNC round, so
+	 * that they can turn START into their own clock accurately
+	 */
+	int synced_count (void);
+
+  public:
+
+	/* (puzzle_id) Hosts a race on the puzzle. A fresh classic puzzle is
+	 * picked if puzzle_id is empty or not a classic puzzle ID.
+	 */
+	RaceHost (const std::string&);
+
+	/* Closes every socket
+	 *
+	 */
+	~RaceHost (void);
+
+	RaceHost (const RaceHost&) = delete;
+	RaceHost& operator= (const RaceHost&) = delete;
+
+	/* (port, lan) Listens on port, of every interface if lan is set or
+	 * only loopback if not. Port 0 picks a free one. Returns false if it
+	 * can't.
+	 */
+	bool listen (int, bool);
+
+	/* Returns the port being listened on
+	 *
+	 */
+	int get_port (void);
+
+	/* Returns the ID of the puzzle being raced
+	 *
+	 */
+	std::string get_puzzle_id (void);
+
+	/* (players, countdown) Waits for players to join, starts the race
+	 * countdown milliseconds after the last one has joined and finished
+	 * measuring its clock offset, and runs it until
+	 * every player has finished or gone, or stop is called. Then closes
+	 * every connection and stops listening. Returns false if it ended
+	 * before the race started.
+	 */
+	bool run (int, int);
+
+	/* Makes run return. Safe to call from a signal handler or another
+	 * thread.
+	 */
+	void stop (void);
+
+	/* Returns the players who finished, fastest first
+	 *
+	 */
+	std::vector<RaceResult> get_results (void);
+};
+
+/* What a RaceClient heard from the host
+ *
+ */
+enum RaceEventType {
+	RACE_WELCOME,   // Joined. name is the puzzle ID.
+	RACE_PLAYER,    // name joined
+	RACE_START,     // The race starts at value on this player's race_clock
+	RACE_PROGRESS,  // name has value cells filled
+	RACE_FINISHED,  // name finished in value milliseconds, coming place
+	RACE_WRONG,     // The board sent with send_done is not the solution
+	RACE_ERROR      // The host refused a message. name is why.
+};
+
+struct RaceEvent {
+	int type;
+	std::string name;
+	long value;
+	int place;
+};
+
+class RaceClient {
+
+  private:
+
+	int fd;
+	std::string input;
+	std::string output;
+
+	std::string puzzle_id;
+
+	/* The host's race_clock minus this one, measured by the SYNC with the
+	 * shortest round trip so far
+	 */
+	long offset;
+	long best_round_trip;
+	int syncs_left;
+
+	/* The last progress sent, so repeats are not
+	 *
+	 */
+	int sent_filled;
+
+	/* (line) Queues a line for the host and sends as much as the socket
+	 * takes
+	 */
+	void send_line (const std::string&);
+
+	/* (line, events) Handles one line from the host
+	 *
+	 */
+	void handle (const std::string&, std::vector<RaceEvent>&);
+
+  public:
+
+	RaceClient (void);
+
+	/* Leaves the race
+	 *
+	 */
+	~RaceClient (void);
+
+	RaceClient (const RaceClient&) = delete;
+	RaceClient& operator= (const RaceClient&) = delete;
+
+	/* (host, port, name) Connects to a race host, waiting until the
+	 * connection is made, and asks to join as name. host is a name or an
+	 * address. Returns false if it can't connect.
+	 */
+	bool join (const std::string&, int, const std::string&);
+
+	/* Returns the socket, to wait on for input. -1 if not connected.
+	 *
+	 */
+	int get_fd (void);
+
+	/* (events) Adds what the host has sent since the last call to events,
+	 * without waiting. Returns false once the host has gone.
+	 */
+	bool receive (std::vector<RaceEvent>&);
+
+	/* (events, timeout) Same as receive, but waits up to timeout
+	 * milliseconds for something to arrive first
+	 */
+	bool wait (std::vector<RaceEvent>&, int);
+
+	/* (filled) Tells the host how many cells are filled. Sent only if it
+	 * changed.
+	 */
+	void send_progress (int);
+
+	/* (board) Sends a finished board for the host to check
+	 *
+	 */
+	void send_done (const Grid&);
+
+	/* Returns the ID of the puzzle being raced, empty until welcomed
+	 *
+	 */
+	std::string get_puzzle_id (void);
+};
+
+#endif
@@ -0,0 +1,67 @@
+/*
+* Last Modified: 10/19/26
+* Author: Alex Eastman
+* Contact: alexeast@buffalo.edu
+* Summary: Seedable random numbers for puzzle generation. Each Random has its
+*          own xoshiro256** state, so generators running on different
+*          threads never share one, and the same seed always makes the same
+*          puzzle. Seeds are shared as short IDs.
+*/
+
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <stdint.h>
+#include <string>
+
+/* Characters in a seed ID, enough for 64 bits at 5 bits each
+ *
+ */
+#define SEED_ID_LENGTH 13
+
+class Random {
+
+  private:
+
+	uint64_t state[4];
+
+  public:
+
+	/* (seed) Starts the sequence for seed. Every seed, 0 included, gives a
+	 * different usable state.
+	 */
+	Random (uint64_t);
+
+	/* Returns the next 64 random bits
+	 *
+	 */
+	uint64_t next (void);
+
+	/* (bound) Returns a number from 0 up to but not including bound, with
+	 * every number equally likely. bound must be at least 1.
+	 */
+	int below (int);
+
+	/* Moves 2^128 numbers ahead. A copy made before jumping will not
+	 * overlap this one for that long, so threads can each take one.
+	 */
+	void jump (void);
+};
+
+/* Returns a seed that is different every time, from the system's entropy
+ * source and the clock
+ */
+uint64_t fresh_seed (void);
+
+/* (seed) Returns the seed as SEED_ID_LENGTH characters of Crockford's
+ * base 32, which avoids letters that look like digits
+ */
+std::string seed_to_id (uint64_t);
+
+/* (id, seed) Reads an ID made by seed_to_id into seed. Lowercase letters are
+ * accepted, as are 'O', 'I' and 'L' for the digits they look like. Returns
+ * false if id is not a seed ID.
+ */
+bool seed_from_id (const std::string&, uint64_t&);
+
+#endif
@@ -0,0 +1,98 @@
+/*
+* Last Modified: 10/19/26
+* Author: Alex Eastman
+* Contact: alexeast@buffalo.edu
+* Summary: Difficulty rating. Solves a puzzle step by step the way a person
+*          would, always using the easiest technique that makes progress, and
+*          scores it from the hardest technique needed and the number of steps.
+*/
+
+#ifndef RATER_H
+#define RATER_H
+
+#include <atomic>
+#include <string>
+#include <vector>
+#include <ostream>
+#include "grid.h"
+#include "cache.h"
+
+/* Techniques in the order they are tried, easiest first. GUESS means the
+ * techniques below it ran out and the rest needs trial and error.
+ */
+enum Technique {
+	NAKED_SINGLE,
+	HIDDEN_SINGLE,
+	LOCKED_CANDIDATES,
+	NAKED_PAIR,
+	HIDDEN_PAIR,
+	NAKED_TRIPLE,
+	HIDDEN_TRIPLE,
+	X_WING,
+	SWORDFISH,
+	GUESS,
+	TECHNIQUE_COUNT
+};
+
+/* Labels a puzzle is given, from its hardest technique
+ *
+ */
+enum Difficulty {
+	UNRATED = -1,
+	EASY,
+	MEDIUM,
+	HARD,
+	EXPERT,
+	DIABOLICAL
+};
+
+/* Result of rating one puzzle. score is the weight of the hardest technique
+ * times 100 plus the number of steps, so puzzles needing the same technique
+ * are ordered by length.
+ */
+struct Rating {
+	int hardest;
+	int steps;
+	int score;
+	int difficulty;
+};
+
+/* (puzzle) Rates the puzzle without looking at any cache. Puzzles that do
+ * not have exactly one solution are UNRATED.
+ */
+Rating rate (const Grid&);
+
+/* (puzzle, cache) Rates the puzzle, using and filling cache so a puzzle that
+ * was rated before is not solved again. cache may be null.
+ */
+Rating rate_puzzle (const Grid&, AnalysisCache*);
+
+/* (puzzles, threads, cache) Rates every puzzle using up to threads worker
+ * threads (0 for one per core). Results are in the same order as puzzles.
+ */
+std::vector<Rating> rate_batch (const std::vector<Grid>&, int, AnalysisCache*);
+
+/* (puzzles, threads, cache, cancel) Same as above, but stops as soon as
+ * cancel is set by another thread. The ratings are meaningless if cancel
+ * was set. cancel may be null.
+ */
+std::vector<Rating> rate_batch (const std::vector<Grid>&, int, AnalysisCache*, const std::atomic<bool>*);
+
+/* (paths, threads, cache, out) Rates every puzzle in the files, in any of
+ * the formats in collection.h, and writes "puzzle score difficulty" lines to
+ * out in input order. cache may be null. Returns false if a file could not be
+ * read.
+ */
+bool rate_files (const std::vector<std::string>&, int, AnalysisCache*, std::ostream&);
+
+/* (difficulty) Returns the name shown to players, eg. "Medium"
+ *
+ */
+std::string difficulty_name (int);
+
+/* (technique) Returns the name of the technique, eg. "X-Wing"
+ *
+ */
+std::string technique_name (int);
+
+#endif
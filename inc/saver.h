@@ -0,0 +1,158 @@
+/*
+* Last Modified: 10/19/26
+* Author: Alex Eastman
+* Contact: alexeast@buffalo.edu
+* Summary: Writes files on a background thread so a slow disk never holds up
+*          the game. Saves of the same file that come in quick succession are
+*          merged, and only the latest contents are written. Each file is
+*          written beside the old one and renamed over it, so a crash leaves
+*          either the old or the new version, never half of one. Files can
+*          also be appended to, for journals. Files are written in the order
+*          they were queued, and a file can be made to wait for another.
+*/
+
+#ifndef SAVER_H
+#define SAVER_H
+
+#include <string>
+#include <map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "latency.h"
+
+/* Milliseconds the writer waits after a save for more to merge with it
+ *
+ */
+#define SAVE_DELAY_MS 200
+
+/* Counters for how the saver is doing
+ *
+ */
+struct SaveStats {
+	long requests;  // Calls to save and append
+	long writes;    // Files written, fewer than requests when saves merge
+	long failures;  // Writes that failed
+};
+
+class BackgroundSaver {
+
+  private:
+
+	/* Text waiting to be written to a file. replace is set if it is the
+	 * whole file, otherwise it is added to the end. Files are written in
+	 * order of sequence. after is a file that must be written first, and if
+	 * writing it fails this one is not written either. Empty for none.
+	 */
+	struct PendingFile {
+		std::string contents;
+		bool replace;
+		long sequence;
+		std::string after;
+	};
+
+	/* Files waiting to be written, and the ones of the batch being written
+	 * that are not done yet, by path
+	 */
+	std::map<std::string, PendingFile> pending;
+	std::map<std::string, PendingFile> in_flight;
+	long next_sequence;
+
+	/* Whether the writer is writing a batch taken from pending, how many
+	 * callers are waiting in flush, and whether the saver is shutting down
+	 */
+	bool writing;
+	int flushing;
+	bool stopping;
+
+	SaveStats stats;
+
+	/* Microseconds each write took, including syncing it to disk
+	 *
+	 */
+	LatencyHistogram write_times;
+
+	/* Guards everything above. pending_changed wakes the writer and
+	 * batch_written wakes flush and read, after each file.
+	 */
+	std::mutex lock;
+	std::condition_variable pending_changed;
+	std::condition_variable batch_written;
+
+	std::thread writer;
+
+	/* Writes pending files until the saver is destroyed
+	 *
+	 */
+	void run (void);
+
+  public:
+
+	/* Starts the writer thread
+	 *
+	 */
+	BackgroundSaver (void);
+
+	/* Writes whatever is pending and stops the writer
+	 *
+	 */
+	~BackgroundSaver (void);
+
+	BackgroundSaver (const BackgroundSaver&) = delete;
+	BackgroundSaver& operator= (const BackgroundSaver&) = delete;
+
+	/* (path, contents) Queues contents to be written to path, replacing any
+	 * contents queued for it before. Returns at once.
+	 */
+	void save (const std::string&, const std::string&);
+
+	/* (path, contents, after) Same as save, but path is not written before
+	 * what is queued for after, even if more is queued for after later, and
+	 * not at all if writing after fails. For a file that must never be
+	 * newer than another.
+	 */
+	void save_after (const std::string&, const std::string&, const std::string&);
+
+	/* (path, text) Queues text to be added to the end of path, after
+	 * anything queued for it before. Returns at once.
+	 */
+	void append (const std::string&, const std::string&);
+
+	/* Writes everything queued now instead of after SAVE_DELAY_MS, and waits
+	 * until it is on disk
+	 */
+	void flush (void);
+
+	/* (path) Returns what path will hold once everything queued for it is
+	 * written, without waiting for the writes. Empty if it does not exist.
+	 * Waits only if an append to path is being written right then.
+	 */
+	std::string read (const std::string&);
+
+	/* Returns a copy of the counters
+	 *
+	 */
+	SaveStats get_stats (void);
+
+	/* Returns the counters and the write time percentiles, one line each
+	 *
+	 */
+	std::string report (void);
+};
+
+/* (path, contents) Writes contents to path through a temporary file that is
+ * synced and renamed over it. Returns false if it could not be written.
+ */
+bool write_file_atomically (const std::string&, const std::string&);
+
+/* (path, text) Adds text to the end of path, creating it if needed, and
+ * syncs it. Returns false if it could not be written.
+ */
+bool append_to_file (const std::string&, const std::string&);
+
+/* The saver used for the user data file
+ *
+ */
+BackgroundSaver& shared_saver (void);
+
+#endif
@@ -0,0 +1,215 @@
+/*
+* Last Modified: 10/19/26
+* Author: Alex Eastman
+* Contact: alexeast@buffalo.edu
+* Summary: A puzzle service for many clients on one machine, so they share
+*          one generator, solver and analysis cache. Clients connect over a
+*          Unix socket or loopback TCP and send one request per line:
+*
+*              PING                        -> OK
+*              NEW difficulty [id]         -> OK id difficulty puzzle
+*              CHECK puzzle board          -> OK solved|incomplete|mistakes count
+*              HINT puzzle board           -> OK row col number, or OK none
+*              SAVE name id|puzzle seconds -> OK
+*
+*          difficulty is a name such as "hard", or "any". Puzzles and boards
+*          are 81 characters with '0' or '.' for empty cells. id is a puzzle
+*          ID as shown in the game, and the same ID always gives the same
+*          puzzle. Rows and columns count from 0. Failed requests get
+*          "ERR reason". Replies come back in the order the requests were
+*          sent, so a client may send several before reading, up to
+*          SERVER_MAX_PENDING.
+*
+*          One thread waits on every socket with epoll and only moves bytes.
+*          Requests are handled by a pool of worker threads.
+*/
+
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include "cache.h"
+
+/* Socket the server listens on by default, in the data directory
+ *
+ */
+#define SERVER_SOCKET "sudoku.sock"
+
+/* Results saved with SAVE, one "name id seconds" line each, in the data
+ * directory
+ */
+#define SERVER_RESULTS_FILE "results.txt"
+
+/* Longest request accepted. Longer ones close the connection.
+ *
+ */
+#define SERVER_MAX_LINE 512
+
+/* Puzzles generated for one NEW before giving up on the difficulty
+ *
+ */
+#define SERVER_MAX_TRIES 200
+
+/* Requests a client may have waiting for replies, and bytes of replies it
+ * may leave unread, before the server stops reading from it. A client that
+ * sends without reading would otherwise fill the server's memory.
+ */
+#define SERVER_MAX_PENDING 64
+#define SERVER_MAX_OUTPUT 65536
+
+/* (request, cache) Handles one request line, without its newline, and
+ * returns the reply line without one. cache may be null. Safe to call from
+ * many threads at once.
+ */
+std::string handle_request (const std::string&, AnalysisCache*);
+
+class PuzzleServer {
+
+  private:
+
+	/* A client. Requests are numbered as they arrive, and replies are held
+	 * in finished until every earlier one has been written.
+	 */
+	struct Connection {
+		int fd;
+		std::string input;
+		std::string output;
+		long next_request;
+		long next_reply;
+		std::map<long, std::string> finished;
+		bool closing;  // The client is done sending
+	};
+
+	/* A request waiting for a worker, or a reply waiting for the loop
+	 *
+	 */
+	struct Job {
+		long connection;
+		long number;
+		std::string text;
+	};
+
+	/* Listening sockets, the epoll instance, and the eventfd workers use to
+	 * wake the loop when replies are ready. -1 if not open.
+	 */
+	std::vector<int> listeners;
+	int epoll_fd;
+	int wake_fd;
+
+	/* Path of the Unix socket, removed when the server stops
+	 *
+	 */
+	std::string socket_path;
+
+	/* Open connections by id. Ids are never reused, unlike fds, so a reply
+	 * for a closed connection can't reach a new one. Only the loop uses it.
+	 */
+	std::unordered_map<long, Connection> connections;
+	long next_connection;
+
+	/* Requests and replies passed between the loop and the workers, guarded
+	 * by lock
+	 */
+	std::deque<Job> requests;
+	std::vector<Job> replies;
+	std::mutex lock;
+	std::condition_variable work_ready;
+
+	std::vector<std::thread> workers;
+	AnalysisCache* cache;
+
+	/* Set to end run. Safe to set from a signal handler.
+	 *
+	 */
+	std::atomic<bool> stopping;
+
+	/* (fd) Adds a socket to epoll and starts listening on it
+	 *
+	 */
+	bool add_listener (int);
+
+	/* (listener) Accepts every waiting client
+	 *
+	 */
+	void accept_clients (int);
+
+	/* (id) Reads what the client sent and queues each whole line, until
+	 * the client has too much waiting. See SERVER_MAX_PENDING.
+	 */
+	void read_client (long);
+
+	/* (client) Returns true if client has as many replies waiting as it may
+	 *
+	 */
+	bool backed_up (const Connection&);
+
+	/* (id) Writes as much pending output as the socket takes, and closes the
+	 * connection if the client is done and nothing is left
+	 */
+	void write_client (long);
+
+	/* (id) Watches the connection for output space only while it has
+	 * output, and for input only while it is not backed up
+	 */
+	void update_events (long);
+
+	/* (id) Closes the connection. Replies still being worked on are dropped.
+	 *
+	 */
+	void close_client (long);
+
+	/* Moves finished replies to their connections
+	 *
+	 */
+	void collect_replies (void);
+
+	/* Takes requests from the queue until the server stops
+	 *
+	 */
+	void work (void);
+
+  public:
+
+	/* (cache) cache may be null. It must outlive the server.
+	 *
+	 */
+	PuzzleServer (AnalysisCache*);
+
+	/* Stops the workers and closes every socket
+	 *
+	 */
+	~PuzzleServer (void);
+
+	PuzzleServer (const PuzzleServer&) = delete;
+	PuzzleServer& operator= (const PuzzleServer&) = delete;
+
+	/* (path) Listens on a Unix socket at path, replacing a stale one. Returns
+	 * false if it can't.
+	 */
+	bool listen_unix (const std::string&);
+
+	/* (port) Listens on port of the loopback interface only. Returns false
+	 * if it can't.
+	 */
+	bool listen_tcp (int);
+
+	/* (threads) Serves clients with threads workers (0 for one per core)
+	 * until stop is called
+	 */
+	void run (int);
+
+	/* Makes run return. Safe to call from a signal handler.
+	 *
+	 */
+	void stop (void);
+};
+
+#endif
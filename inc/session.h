@@ -0,0 +1,151 @@
+/*
+* Last Modified: 10/19/26
+* Author: Alex Eastman
+* Contact: alexeast@buffalo.edu
+* Summary: Games open at the same time, eg. one per player on a shared
+*          machine. Each Game has its own board, clock and undo history. The
+*          SessionManager hands them out from blocks allocated up front and
+*          reuses the space of closed games, so opening and closing games
+*          does not go to the heap once a block is there.
+*/
+
+#ifndef SESSION_H
+#define SESSION_H
+
+#include <vector>
+#include <stack>
+#include <glibmm/ustring.h>
+#include <glibmm/keyfile.h>
+#include "board.h"
+
+/* Games allocated at a time when every open slot is taken
+ *
+ */
+#define SESSION_BLOCK 8
+
+/* An undo entry: the cell that changed and a snapshot of the board from
+ * before the change, since placing a number also clears pencil marks from
+ * the cell's peers. row and col are -1 when the whole board changed at
+ * once, eg. for a paste.
+ */
+struct Action {
+	int row;
+	int col;
+	BoardState before;
+};
+
+/* A stack of undo entries. Kept on a vector, which unlike the default deque
+ * does not allocate until something is pushed.
+ */
+typedef std::stack<Action, std::vector<Action>> ActionStack;
+
+struct Game {
+
+	/* The board, which also keeps the clock
+	 *
+	 */
+	Board board;
+
+	/* Stores user actions, and actions that were undone so they can be
+	 * redone
+	 */
+	ActionStack user_stack;
+	ActionStack undone_stack;
+
+	/* The undo history from outside each open branch of the board, innermost
+	 * last. Moves in a branch can only be undone back to where it opened.
+	 */
+	std::vector<std::pair<ActionStack, ActionStack>> branch_stacks;
+
+	/* (user_data) See Board
+	 *
+	 */
+	Game (Glib::KeyFile&);
+
+	/* Opens a branch of the board, see Board::branch, with an undo history
+	 * of its own
+	 */
+	void branch (void);
+
+	/* Keeps the moves of the innermost branch. They stay undoable, after
+	 * the moves from before it. Returns false if there is no branch.
+	 */
+	bool keep_branch (void);
+
+	/* Drops the moves of the innermost branch and brings back the undo
+	 * history from before it. Returns false if there is no branch.
+	 */
+	bool discard_branch (void);
+
+	/* Closes every branch without keeping it, and clears the undo history.
+	 * Used when a new game starts.
+	 */
+	void clear_history (void);
+};
+
+class SessionManager {
+
+  private:
+
+	/* Every user's data, shared by the boards of all games
+	 *
+	 */
+	Glib::KeyFile user_data;
+
+	/* Space for SESSION_BLOCK games each, never freed until the manager is
+	 *
+	 */
+	std::vector<Game*> blocks;
+
+	/* Slots in blocks with no game in them
+	 *
+	 */
+	std::vector<Game*> free_slots;
+
+	/* Open games, in the order they were opened
+	 *
+	 */
+	std::vector<Game*> games;
+
+  public:
+
+	/* Loads the user data file
+	 *
+	 */
+	SessionManager (void);
+
+	/* Closes every game and frees the blocks
+	 *
+	 */
+	~SessionManager (void);
+
+	SessionManager (const SessionManager&) = delete;
+	SessionManager& operator= (const SessionManager&) = delete;
+
+	/* Returns a new game with an empty board and no user. Stays valid until
+	 * it is closed.
+	 */
+	Game* open (void);
+
+	/* (game) Destroys game and keeps its slot for the next one opened. Save
+	 * it first if it should be resumed later.
+	 */
+	void close (Game*);
+
+	/* (username) Returns the open game of the user, or null if they have none
+	 *
+	 */
+	Game* find (const Glib::ustring&);
+
+	/* Returns the number of open games
+	 *
+	 */
+	int size (void);
+
+	/* (index) Returns open game number index, counting from 0 in the order
+	 * they were opened
+	 */
+	Game* get (int);
+};
+
+#endif
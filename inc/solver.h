@@ -0,0 +1,59 @@
+/*
+* Last Modified: 10/19/26
+* Author: Alex Eastman
+* Contact: alexeast@buffalo.edu
+* Summary: Backtracking solver over Grid. Used to find solutions and to check
+*          that a puzzle has exactly one. Also solves the larger grids of
+*          LargeGrid, with the search split between threads.
+*/
+
+#ifndef SOLVER_H
+#define SOLVER_H
+
+#include <atomic>
+#include <vector>
+#include "grid.h"
+
+/* (puzzle, limit, solution) Counts the solutions of puzzle, stopping once
+ * limit have been found. If solution is not null, the first solution found is
+ * stored in it. Returns the number found, between 0 and limit.
+ */
+int count_solutions (const Grid&, int, Grid*);
+
+/* (puzzle, limit, solution, cancel) Same as above, but gives up as soon as
+ * cancel is set by another thread. The result is meaningless if cancel was
+ * set. cancel may be null.
+ */
+int count_solutions (const Grid&, int, Grid*, const std::atomic<bool>*);
+
+/* (puzzle, limit, solutions) Adds every solution of puzzle to solutions,
+ * stopping once limit have been found. Returns the number added.
+ */
+int list_solutions (const Grid&, int, std::vector<Grid>&);
+
+/* (puzzle, limit, solution, threads) Same as count_solutions, but splits the
+ * search tree between threads (0 for one per core), which steal subtrees
+ * from each other as they run out. Every thread stops once limit solutions
+ * are found. Only worth it for searches that take a thread long, eg.
+ * counting the solutions of a sparse puzzle. The solution stored may not be
+ * the one count_solutions would find.
+ */
+int count_solutions_parallel (const Grid&, int, Grid*, int);
+
+/* (puzzle, limit, solution, threads) Counts the solutions of a puzzle of any
+ * order like count_solutions_parallel. If solution is not null, the first
+ * solution found is stored in it. Returns 0 if puzzle is malformed.
+ */
+int count_large_solutions (const LargeGrid&, int, LargeGrid*, int);
+
+/* (puzzle) Returns true if the puzzle has exactly one solution
+ *
+ */
+bool has_unique_solution (const Grid&);
+
+/* (grid) Returns true if no row, column or block has a digit more than once.
+ * Empty cells are ignored.
+ */
+bool is_consistent (const Grid&);
+
+#endif
@@ -0,0 +1,80 @@
+/*
+* Last Modified: 10/19/26
+* Author: Alex Eastman
+* Contact: alexeast@buffalo.edu
+* Summary: Tracing of hot paths. Scoped spans and counters are recorded when
+*          the SUDOKU_TRACE environment variable names a file, and written to
+*          it as Chrome trace events (load it in chrome://tracing or Perfetto)
+*          when the program exits. When SUDOKU_TRACE is unset every span and
+*          counter is a single branch.
+*/
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdlib.h>
+
+/* Returns true if SUDOKU_TRACE was set when the program started. Inline so a
+ * disabled span costs one load and branch.
+ */
+inline bool trace_enabled (void)
+{
+	static const bool enabled = getenv("SUDOKU_TRACE") != NULL;
+	return enabled;
+}
+
+/* Microseconds since the first call. Only meant for comparing with other
+ * trace times.
+ */
+long trace_now (void);
+
+/* (name, start) Records a span called name that started at start, as given
+ * by trace_now, and ends now. name must be a string literal.
+ */
+void trace_span (const char*, long);
+
+/* (name, value) Records the value of a counter called name. Chrome draws
+ * each counter as a graph over time. name must be a string literal.
+ */
+void trace_counter (const char*, long);
+
+/* Writes every event recorded so far to the SUDOKU_TRACE file. Called once
+ * on exit. Does nothing if tracing is disabled.
+ */
+void trace_flush (void);
+
+/* Records a span from its construction to the end of the enclosing scope
+ *
+ */
+class TraceScope {
+
+  private:
+
+	const char* name;
+	long start;
+
+  public:
+
+	TraceScope (const char* span) : name(span), start(trace_enabled() ? trace_now() : 0) {}
+
+	~TraceScope (void)
+	{
+		if (trace_enabled()) trace_span(name, start);
+	}
+};
+
+#define TRACE_JOIN(a, b) a##b
+#define TRACE_NAME(line) TRACE_JOIN(trace_scope_, line)
+
+/* (name) Traces the rest of the enclosing scope as a span called name
+ *
+ */
+#define TRACE_SCOPE(name) TraceScope TRACE_NAME(__LINE__)(name)
+
+/* (name, value) Records a counter, skipping the call when tracing is off
+ *
+ */
+#define TRACE_COUNTER(name, value) \
+	do { if (trace_enabled()) trace_counter(name, value); } while (0)
+
+#endif
@@ -0,0 +1,72 @@
+/*
+* Last Modified: 10/19/26
+* Author: Alex Eastman
+* Contact: alexeast@buffalo.edu
+* Summary: Checks many finished grids at once, eg. to audit submitted
+*          solutions. Grids are packed into batches laid out cell by cell,
+*          so that one step checks a cell of every grid in the batch
+*          together. Only grids that fail are looked at one at a time, to
+*          find where.
+*/
+
+#ifndef VALIDATE_H
+#define VALIDATE_H
+
+#include <vector>
+#include <stdint.h>
+#include "grid.h"
+
+/* Grids in a batch
+ *
+ */
+#define BATCH_WIDTH 16
+
+/* BATCH_WIDTH grids, structure of arrays: cells[i][lane] is cell i of grid
+ * lane, with cells numbered like Grid. Lanes past the last grid are empty.
+ */
+struct GridBatch {
+	unsigned char cells[81][BATCH_WIDTH];
+};
+
+/* What validate_grids found, one entry per grid
+ *
+ */
+struct ValidationReport {
+	/* Bit i % 64 of word i / 64 is set if grid i is a valid solution
+	 *
+	 */
+	std::vector<uint64_t> passed;
+
+	/* The first cell of each grid, in row major order, that is empty or
+	 * repeats a digit of its row, column or block, as row * 9 + column.
+	 * -1 for grids that passed.
+	 */
+	std::vector<short> conflicts;
+};
+
+/* (grids) Packs grids into batches of BATCH_WIDTH, the last one padded with
+ * empty grids
+ */
+std::vector<GridBatch> pack_grids (const std::vector<Grid>&);
+
+/* (batch) Returns a mask with bit lane set for each grid of batch that is
+ * full and has no digit twice in a row, column or block
+ */
+uint32_t validate_batch (const GridBatch&);
+
+/* (batches, count) Checks the first count grids of batches. See
+ * ValidationReport.
+ */
+ValidationReport validate_grids (const std::vector<GridBatch>&, int);
+
+/* (grid) Returns the first cell of grid that is empty or repeats a digit of
+ * its row, column or block, as row * 9 + column, or -1 if there is none
+ */
+int first_conflict (const Grid&);
+
+/* (report, i) Returns true if grid i passed
+ *
+ */
+bool grid_passed (const ValidationReport&, int);
+
+#endif
@@ -0,0 +1,456 @@
+/*
+* Last Modified: 10/19/26
+* Author: Alex Eastman
+* Contact: alexeast@buffalo.edu
+* Summary: Rules for sudoku variants, composed at compile time. A rule set is
+*          a ConstraintSet of small constraint classes, and the solver,
+*          validator and generator below are templates over the rule set, so
+*          each variant gets its own specialized code with no virtual calls.
+*/
+
+#ifndef VARIANTS_H
+#define VARIANTS_H
+
+#include <string>
+#include <tuple>
+#include <vector>
+#include "grid.h"
+#include "generator.h"
+#include "random.h"
+
+/* Nodes a variant search visits before giving up, so a layout with no
+ * solution or a puzzle with too few clues can't hold up the game
+ */
+#define VARIANT_SEARCH_NODES 200000
+
+/* Fresh starts, with a new layout where the variant has one, before
+ * generating a variant puzzle fails
+ */
+#define VARIANT_ATTEMPTS 20
+
+enum Variant {
+	VARIANT_CLASSIC,
+	VARIANT_DIAGONAL,     // Both long diagonals also hold 1-9
+	VARIANT_JIGSAW,       // Irregular regions replace the blocks
+	VARIANT_KILLER,       // Cages of cells add up to a sum without repeats
+	VARIANT_ANTI_KNIGHT,  // Cells a knight's move apart differ
+	VARIANT_COUNT
+};
+
+/* Each constraint below has three members:
+ *
+ *   unsigned short blocked (const unsigned char* cells, int cell) const
+ *       Digits (bit 0 for 1) that cell may not hold because of the other
+ *       cells. cells is the 81 cells of a Grid, 0 for empty.
+ *
+ *   bool accepts (const unsigned char* cells) const
+ *       Checks a full grid for anything blocked can't decide cell by cell.
+ *
+ *   void style (int cell, std::vector<std::string>& classes) const
+ *       Adds the style classes the board view draws cell with.
+ */
+
+// Digits held by the cells of group other than skip
+inline unsigned short digits_in (const unsigned char* cells, const unsigned char* group,
+  int count, int skip)
+{
+	unsigned short digits = 0;
+	int i;
+	for (i=0; i<count; i++) {
+		int other = group[i];
+		if (other != skip && cells[other] != 0) digits |= 1 << (cells[other] - 1);
+	}
+	return digits;
+}
+
+struct Rows {
+	unsigned short blocked (const unsigned char* cells, int cell) const
+	{
+		return digits_in(cells, unit_tables().units[cell / 9], 9, cell);
+	}
+	bool accepts (const unsigned char*) const { return true; }
+	void style (int, std::vector<std::string>&) const {}
+};
+
+struct Columns {
+	unsigned short blocked (const unsigned char* cells, int cell) const
+	{
+		return digits_in(cells, unit_tables().units[9 + cell % 9], 9, cell);
+	}
+	bool accepts (const unsigned char*) const { return true; }
+	void style (int, std::vector<std::string>&) const {}
+};
+
+struct Blocks {
+	unsigned short blocked (const unsigned char* cells, int cell) const
+	{
+		return digits_in(cells, unit_tables().units[unit_tables().units_of[cell][2]], 9, cell);
+	}
+	bool accepts (const unsigned char*) const { return true; }
+	void style (int, std::vector<std::string>&) const {}
+};
+
+struct Diagonals {
+	unsigned short blocked (const unsigned char* cells, int cell) const
+	{
+		static const unsigned char main[9] = {0, 10, 20, 30, 40, 50, 60, 70, 80};
+		static const unsigned char anti[9] = {8, 16, 24, 32, 40, 48, 56, 64, 72};
+
+		int row = cell / 9;
+		int column = cell % 9;
+		unsigned short digits = 0;
+		if (row == column) digits |= digits_in(cells, main, 9, cell);
+		if (row + column == 8) digits |= digits_in(cells, anti, 9, cell);
+		return digits;
+	}
+	bool accepts (const unsigned char*) const { return true; }
+	void style (int cell, std::vector<std::string>& classes) const
+	{
+		int row = cell / 9;
+		int column = cell % 9;
+		if (row == column || row + column == 8) classes.push_back("diagonal");
+	}
+};
+
+/* Nine irregular regions of nine connected cells, used in place of Blocks
+ *
+ */
+struct Jigsaw {
+	unsigned char region[81];
+	unsigned char members[9][9];
+	unsigned char color[9];  // For shading only, neighbours can share one
+
+	Jigsaw (void);
+
+	/* (regions) Builds the lookup tables from the region of each cell
+	 *
+	 */
+	Jigsaw (const unsigned char*);
+
+	unsigned short blocked (const unsigned char* cells, int cell) const
+	{
+		return digits_in(cells, members[region[cell]], 9, cell);
+	}
+	bool accepts (const unsigned char*) const { return true; }
+	void style (int cell, std::vector<std::string>& classes) const
+	{
+		classes.push_back("region_" + std::to_string(color[region[cell]]));
+	}
+};
+
+/* One killer cage: its cells and what they add up to
+ *
+ */
+struct Cage {
+	std::vector<unsigned char> cells;
+	int sum;
+};
+
+struct Killer {
+	std::vector<Cage> cages;
+	short cage_of[81];
+	unsigned char color[81];  // Color of each cage. Touching cages differ.
+
+	Killer (void);
+
+	/* (cages) Builds the lookup tables for cages
+	 *
+	 */
+	Killer (const std::vector<Cage>&);
+
+	/* No repeats within a cage, and digit must leave a sum the other open
+	 * cells of the cage can still make
+	 */
+	unsigned short blocked (const unsigned char* cells, int cell) const
+	{
+		if (cage_of[cell] < 0) return 0;
+		const Cage& cage = cages[cage_of[cell]];
+
+		unsigned short digits = digits_in(cells, cage.cells.data(), cage.cells.size(), cell);
+		int remaining = cage.sum;
+		int open = 0;
+		for (int other : cage.cells) {
+			if (other == cell) continue;
+			if (cells[other] == 0) open++;
+			else remaining -= cells[other];
+		}
+
+		// The open cells hold distinct digits, so their total is bounded
+		int least = open * (open + 1) / 2;
+		int most = open * (19 - open) / 2;
+		int digit;
+		for (digit=1; digit<=9; digit++) {
+			int left = remaining - digit;
+			if (left < least || left > most) digits |= 1 << (digit - 1);
+		}
+
+		return digits;
+	}
+	bool accepts (const unsigned char* cells) const
+	{
+		for (const Cage& cage : cages) {
+			int total = 0;
+			for (int cell : cage.cells) total += cells[cell];
+			if (total != cage.sum) return false;
+		}
+		return true;
+	}
+	void style (int cell, std::vector<std::string>& classes) const
+	{
+		if (cage_of[cell] < 0) return;
+		classes.push_back("cage_" + std::to_string(color[cage_of[cell]]));
+	}
+};
+
+struct AntiKnight {
+	unsigned short blocked (const unsigned char* cells, int cell) const
+	{
+		static const int moves[8][2] = {
+			{-2, -1}, {-2, 1}, {-1, -2}, {-1, 2}, {1, -2}, {1, 2}, {2, -1}, {2, 1}
+		};
+
+		int row = cell / 9;
+		int column = cell % 9;
+		unsigned short digits = 0;
+		int i;
+		for (i=0; i<8; i++) {
+			int r = row + moves[i][0];
+			int c = column + moves[i][1];
+			if (r < 0 || r > 8 || c < 0 || c > 8 || cells[r*9 + c] == 0) continue;
+			digits |= 1 << (cells[r*9 + c] - 1);
+		}
+		return digits;
+	}
+	bool accepts (const unsigned char*) const { return true; }
+	void style (int, std::vector<std::string>&) const {}
+};
+
+/* A rule set made of the constraints given as template parameters. Each
+ * member forwards to every constraint through a fold, which the compiler
+ * flattens into straight line code.
+ */
+template <class... Constraints>
+class ConstraintSet {
+
+  public:
+
+	std::tuple<Constraints...> constraints;
+
+	ConstraintSet (void) {}
+
+	ConstraintSet (Constraints... parts) : constraints(parts...) {}
+
+	unsigned short blocked (const unsigned char* cells, int cell) const
+	{
+		return std::apply([&](const Constraints&... part) {
+			return (unsigned short) (0 | ... | part.blocked(cells, cell));
+		}, constraints);
+	}
+
+	bool accepts (const unsigned char* cells) const
+	{
+		return std::apply([&](const Constraints&... part) {
+			return (true && ... && part.accepts(cells));
+		}, constraints);
+	}
+
+	void style (int cell, std::vector<std::string>& classes) const
+	{
+		std::apply([&](const Constraints&... part) {
+			(part.style(cell, classes), ...);
+		}, constraints);
+	}
+};
+
+typedef ConstraintSet<Rows, Columns, Blocks> ClassicRules;
+typedef ConstraintSet<Rows, Columns, Blocks, Diagonals> DiagonalRules;
+typedef ConstraintSet<Rows, Columns, Jigsaw> JigsawRules;
+typedef ConstraintSet<Rows, Columns, Blocks, Killer> KillerRules;
+typedef ConstraintSet<Rows, Columns, Blocks, AntiKnight> AntiKnightRules;
+
+
+/* Solver, validator and generator, specialized for each rule set
+ *
+ */
+
+/* (rules, grid) Returns true if no filled cell breaks rules. Checks accepts
+ * too if the grid is full.
+ */
+template <class Rules>
+bool satisfies (const Rules& rules, const Grid& grid)
+{
+	bool full = true;
+	int i;
+	for (i=0; i<81; i++) {
+		int digit = grid.cells[i];
+		if (digit == 0) {
+			full = false;
+			continue;
+		}
+		if (rules.blocked(grid.cells, i) & (1 << (digit - 1))) return false;
+	}
+
+	return !full || rules.accepts(grid.cells);
+}
+
+/* (rules, grid) Returns true if the grid is full and follows rules
+ *
+ */
+template <class Rules>
+bool is_solved (const Rules& rules, const Grid& grid)
+{
+	return count_givens(grid) == 81 && satisfies(rules, grid);
+}
+
+/* Depth first search shared by the solver and the random fill. Branches on
+ * the open cell with the fewest candidates, trying them in random order if
+ * random is not null. nodes counts down and the search gives up at 0.
+ */
+template <class Rules>
+int search_variant (const Rules& rules, Grid& grid, int limit, int found, Grid* solution,
+  Random* random, long& nodes)
+{
+	if (--nodes <= 0) return limit;
+
+	int best_cell = -1;
+	int best_count = 10;
+	unsigned short best_mask = 0;
+
+	int i;
+	for (i=0; i<81; i++) {
+		if (grid.cells[i] != 0) continue;
+
+		unsigned short mask = ~rules.blocked(grid.cells, i) & 0x1ff;
+		int count = __builtin_popcount(mask);
+		if (count == 0) return found;
+		if (count < best_count) {
+			best_cell = i;
+			best_count = count;
+			best_mask = mask;
+			if (count == 1) break;
+		}
+	}
+
+	if (best_cell == -1) {
+		if (!rules.accepts(grid.cells)) return found;
+		if (found == 0 && solution != nullptr) *solution = grid;
+		return found + 1;
+	}
+
+	int digits[9];
+	int count = 0;
+	while (best_mask) {
+		digits[count++] = __builtin_ctz(best_mask) + 1;
+		best_mask &= best_mask - 1;
+	}
+	if (random) {
+		for (i=count - 1; i>0; i--) std::swap(digits[i], digits[random -> below(i + 1)]);
+	}
+
+	for (i=0; i<count; i++) {
+		grid.cells[best_cell] = digits[i];
+		found = search_variant(rules, grid, limit, found, solution, random, nodes);
+		grid.cells[best_cell] = 0;
+		if (found >= limit) break;
+	}
+
+	return found;
+}
+
+/* (rules, puzzle, limit, solution) Counts solutions of puzzle under rules
+ * up to limit, storing the first in solution if it is not null. Returns -1
+ * if it gave up after VARIANT_SEARCH_NODES nodes.
+ */
+template <class Rules>
+int count_variant_solutions (const Rules& rules, const Grid& puzzle, int limit, Grid* solution)
+{
+	if (!satisfies(rules, puzzle)) return 0;
+
+	Grid grid = puzzle;
+	long nodes = VARIANT_SEARCH_NODES;
+	int found = search_variant(rules, grid, limit, 0, solution, (Random*) nullptr, nodes);
+	return nodes > 0 ? found : -1;
+}
+
+/* (rules, solution, random) Fills solution with a random grid that follows
+ * rules. Returns false if none was found within VARIANT_SEARCH_NODES nodes.
+ */
+template <class Rules>
+bool random_variant_solution (const Rules& rules, Grid& solution, Random& random)
+{
+	Grid grid = empty_grid();
+	long nodes = VARIANT_SEARCH_NODES;
+	return search_variant(rules, grid, 1, 0, &solution, &random, nodes) == 1 && nodes > 0;
+}
+
+/* (rules, solution, symmetry, random) Removes clues from solution in
+ * symmetric groups for as long as it has one solution under rules. A group
+ * whose count gives up is kept.
+ */
+template <class Rules>
+Grid reduce_variant (const Rules& rules, const Grid& solution, int symmetry, Random& random)
+{
+	Grid puzzle = solution;
+	std::vector< std::vector<int>> orbits = symmetry_orbits(symmetry);
+
+	int i;
+	for (i=(int) orbits.size() - 1; i>0; i--) std::swap(orbits[i], orbits[random.below(i + 1)]);
+
+	for (const std::vector<int>& orbit : orbits) {
+		Grid trial = puzzle;
+		for (int cell : orbit) trial.cells[cell] = 0;
+		if (count_variant_solutions(rules, trial, 2, nullptr) == 1) puzzle = trial;
+	}
+
+	return puzzle;
+}
+
+
+/* Helpers for building variant layouts. See variants.cpp .
+ *
+ */
+
+/* (random) Returns a random jigsaw layout, made by trading cells between
+ * the standard blocks while keeping every region connected
+ */
+Jigsaw random_jigsaw (Random&);
+
+/* (solution, random) Returns random cages of 1-4 cells over solution with
+ * sums taken from it
+ */
+Killer random_killer (const Grid&, Random&);
+
+/* (jigsaw) Saves the region of each cell as 81 digits
+ *
+ */
+std::string jigsaw_to_string (const Jigsaw&);
+bool jigsaw_from_string (const std::string&, Jigsaw&);
+
+/* (killer) Saves the cage of each cell followed by the sums
+ *
+ */
+std::string killer_to_string (const Killer&);
+bool killer_from_string (const std::string&, Killer&);
+
+/* (variant) Returns the name of the variant, eg. "anti-knight"
+ *
+ */
+std::string variant_name (int);
+
+/* (name) Returns the Variant with that name, or VARIANT_CLASSIC
+ *
+ */
+int variant_from_name (const std::string&);
+
+/* (variant, symmetry, seed) Returns the ID of the puzzle generated from
+ * seed, eg. "KR-0F3K9QW2ZB1X4": a letter for the Variant and one for the
+ * Symmetry, then the seed as in seed_to_id
+ */
+std::string make_puzzle_id (int, int, uint64_t);
+
+/* (id, variant, symmetry, seed) Reads an ID made by make_puzzle_id.
+ * Letters may be lowercase. Returns false if id is not a puzzle ID.
+ */
+bool parse_puzzle_id (const std::string&, int&, int&, uint64_t&);
+
+#endif
@@ -1,4 +1,4 @@
-/* Last Modified: 01/19/21
+/* Last Modified: 10/19/26
  * Author: Alex Eastman
  * Contact: alexeast@buffalo.edu
  * Summary: Definitions for function prototypes found in board.h . See board.h
@@ -7,13 +7,51 @@
 
 
 #include "board.h"
+#include "trace.h"
+#include "paths.h"
+#include "solver.h"
+#include "saver.h"
+#include <glibmm/fileutils.h>
 #include <time.h>
 #include <iostream>
 #include <algorithm>
+#include <sstream>
 #include <stdlib.h>
+#include <stdio.h>
+
+const std::vector< std::vector< int>> Board::blocksLookup =
+	{ {0, 1, 2},
+	  {3, 4, 5},
+	  {6, 7, 8}
+	};
+
+namespace {
+
+// Usernames can hold any character, so the journal is named by their bytes in hex
+std::string hex_name (const Glib::ustring& name)
+{
+	std::string hex;
+	char digits[3];
+	for (unsigned char c : name.raw()) {
+		snprintf(digits, sizeof(digits), "%02x", c);
+		hex += digits;
+	}
+	return hex;
+}
+
+}
+
+void load_user_data (Glib::KeyFile& user_data)
+{
+	// Saves from before the data directory were kept in the working directory
+	std::string path = data_path(USER_DATA_FILE);
+	if (!Glib::file_test(path, Glib::FILE_TEST_EXISTS)) path = "data/" USER_DATA_FILE;
+	if (Glib::file_test(path, Glib::FILE_TEST_EXISTS)) user_data.load_from_file(path);
+	return;
+}
 
 // Initializes the board
-Board::Board (void)
+Board::Board (Glib::KeyFile& shared_data) : user_data(shared_data)
 {
     start_time = 0;
     total_time = 0;
@@ -21,34 +59,83 @@ Board::Board (void)
 	username = "";
 	load_from_user_data = false;
 	reserved_set = false;
-	reserved.resize(RESERVED);
+	analyzed = false;
+	solution_stored = false;
+	symmetry = SYMMETRY_ROTATIONAL;
+	variant = VARIANT_CLASSIC;
+	preferred_variant = VARIANT_CLASSIC;
+	failed_variant = -1;
+	generated = empty_grid();
+	imported = false;
+	chosen_seed = 0;
+	chosen_variant = VARIANT_CLASSIC;
+	seed_chosen = false;
+	state = empty_state();
+	saved = empty_state();
+	journal_generation = 0;
+}
+
+void Board::set_number (int number, int outer, int inner)
+{
+	TRACE_SCOPE("Board::set_number");
+
+    state.numbers.cells[outer*9 + inner] = number;
+	if (number > 0) eliminate_mark(number, outer*9 + inner);
+	return;
+}
+
+void Board::eliminate_mark (int number, int cell)
+{
+	const UnitTables& tables = unit_tables();
+	unsigned short bit = 1 << (number - 1);
 
 	int i;
-	for (i=0; i<RESERVED; i++) {
-		reserved[i] = {0, 0, 0};
+	if (variant != VARIANT_JIGSAW) {
+		for (i=0; i<20; i++) state.marks[tables.peers[cell][i]] &= ~bit;
+		return;
 	}
 
-	user_data.load_from_file("data/user_data.txt");
+	// Row, column and region. The cell itself keeps its marks.
+	const unsigned char* row = tables.units[tables.units_of[cell][0]];
+	const unsigned char* col = tables.units[tables.units_of[cell][1]];
+	const unsigned char* region = jigsaw.members[jigsaw.region[cell]];
+	for (i=0; i<9; i++) {
+		if (row[i] != cell) state.marks[row[i]] &= ~bit;
+		if (col[i] != cell) state.marks[col[i]] &= ~bit;
+		if (region[i] != cell) state.marks[region[i]] &= ~bit;
+	}
+	return;
 }
 
-void Board::set_number (int number, int outer, int inner)
+unsigned short Board::get_marks (int outer, int inner)
 {
-    // Can't use push back bc want to set specific position
-    game_board[outer][inner] = number;
-
-    // Get the block to insert into. Get position within block to insert into
-    int blockIndex = blocksLookup.at(outer/3).at(inner/3);
-    int blockPosition = blocksLookup.at(outer%3).at(inner%3);
+	return state.marks[outer*9 + inner];
+}
 
-    // Insert into block
-    blocks[blockIndex][blockPosition] = number;
+void Board::set_marks (unsigned short cell_marks, int outer, int inner)
+{
+	state.marks[outer*9 + inner] = cell_marks & 0x1ff;
+	return;
+}
 
+void Board::toggle_mark (int number, int outer, int inner)
+{
+	state.marks[outer*9 + inner] ^= 1 << (number - 1);
 	return;
 }
 
+bool Board::has_marks (void)
+{
+	int i;
+	for (i=0; i<81; i++) {
+		if (state.marks[i] != 0) return true;
+	}
+	return false;
+}
+
 int Board::get_number (int outer, int inner)
 {
-    return game_board.at(outer).at(inner);
+    return state.numbers.cells[outer*9 + inner];
 }
 
 bool Board::check_reserved (int outer, int inner)
@@ -56,8 +143,8 @@ bool Board::check_reserved (int outer, int inner)
 	bool rsrv = false;
 
     int i;
-	for (i=0; i<RESERVED; i++) {
-		std::vector<int> coordinate = reserved[i];
+	for (i=0; i<(int) reserved.size(); i++) {
+		const std::vector<int>& coordinate = reserved[i];
 		if (coordinate[0] == outer && coordinate[1] == inner) {
 			rsrv = true;
 			break;
@@ -99,45 +186,103 @@ void Board::set_total_time (void)
 
 bool Board::is_win (void)
 {
-	int i, j;
-	std::vector< std::vector<int> > sorted(9, std::vector<int>(9));
+	TRACE_SCOPE("Board::is_win");
 
-	for (i=0; i<9; i++) {
+	if (knows_solution()) {
+		PackedGrid entries = pack_grid(state.numbers);
+		CellSet empty = empty_cells(entries);
+		CellSet wrong = wrong_cells(entries, solution);
+		return (empty.low | empty.high | wrong.low | wrong.high) == 0;
+	}
 
-		std::vector<int> column;
-    	std::vector<int> row = game_board.at(i);
-    	std::vector<int> block = blocks.at(i);
+	// Puzzles with more than one solution are won by any of them
+	Grid grid = get_grid();
 
-    	// Populate column with values at i'th column across all rows
-    	for (j=0; j<9; j++) {
-			column.push_back(game_board.at(j).at(i));
-		}
+	// Each case is its own copy of is_solved, specialized for those rules
+	switch (variant) {
+		case VARIANT_DIAGONAL: return is_solved(DiagonalRules(), grid);
+		case VARIANT_JIGSAW: return is_solved(JigsawRules(Rows(), Columns(), jigsaw), grid);
+		case VARIANT_KILLER: return is_solved(KillerRules(Rows(), Columns(), Blocks(), killer), grid);
+		case VARIANT_ANTI_KNIGHT: return is_solved(AntiKnightRules(), grid);
+		default: return is_solved(ClassicRules(), grid);
+	}
+}
+
+Grid Board::get_grid (void)
+{
+	return state.numbers;
+}
+
+BoardState Board::get_state (void)
+{
+	return state;
+}
+
+void Board::set_state (const BoardState& snapshot)
+{
+	state = snapshot;
+	return;
+}
+
+void Board::clear_entries (void)
+{
+	TRACE_SCOPE("Board::clear_entries");
+
+	int i;
+	for (i=0; i<81; i++) {
+		if ( !check_reserved(i / 9, i % 9)) state.numbers.cells[i] = 0;
+	}
+	return;
+}
+
+int Board::fill_entries (const Grid& numbers)
+{
+	TRACE_SCOPE("Board::fill_entries");
+
+	int changed = 0;
+	int i;
+	for (i=0; i<81; i++) {
+		if (numbers.cells[i] > 9 || numbers.cells[i] == state.numbers.cells[i]) continue;
+		if (check_reserved(i / 9, i % 9)) continue;
+
+		state.numbers.cells[i] = numbers.cells[i];
+		if (numbers.cells[i] > 0) eliminate_mark(numbers.cells[i], i);
+		changed++;
+	}
+	return changed;
+}
+
+void Board::branch (void)
+{
+	branches.push_back(state);
+	return;
+}
 
-		// Remove duplicates and check size. Wrong size means duplicate, therefore invalid.
-    	std::sort (row.begin(), row.end());
-    	row.erase ( std::unique(row.begin(), row.end()), row.end());
-    	if (row.size() != 9 && std::find(row.begin(), row.end(), 0) != row.end()) {
-      		printf("Failed at row\n");
-      		return false;
-    	}
+bool Board::keep_branch (void)
+{
+	if (branches.empty()) return false;
+
+	branches.pop_back();
+	return true;
+}
 
-    	std::sort (block.begin(), block.end());
-    	block.erase ( std::unique(block.begin(), block.end()), block.end());
-    	if (block.size() != 9 && std::find(block.begin(), block.end(), 0) != block.end()) {
-      		printf("Failed at block\n");
-      		return false;
-    	}
+bool Board::discard_branch (void)
+{
+	if (branches.empty()) return false;
 
-    	std::sort (column.begin(), column.end());
-    	column.erase( std::unique(column.begin(), column.end()), column.end());
-    	if (column.size() != 9 && std::find(column.begin(), column.end(), 0) != column.end()) {
-      		printf("Failed at column\n");
-      		return false;
-    	}
+	state = branches.back();
+	branches.pop_back();
+	return true;
+}
 
-  }
+int Board::branch_depth (void)
+{
+	return branches.size();
+}
 
-  return true;
+const BoardState& Board::committed_state (void)
+{
+	return branches.empty() ? state : branches.front();
 }
 
 bool Board::new_record (void)
@@ -181,19 +326,17 @@ void Board::reset_time (void)
 
 void Board::reset_board (void)
 {
-	game_board = initial;
-	blocks = initial;
+	state = empty_state();
+	branches.clear();
 	return;
 }
 
 void Board::reset_reserved (void)
 {
 	reserved_set = false;
-
-	int i;
-	for (i=0; i<RESERVED; i++) {
-		reserved[i] = {0, 0, 0};
-	}
+	analyzed = false;
+	solution_stored = false;
+	reserved.clear();
 }
 
 void Board::reset (void)
@@ -206,6 +349,7 @@ void Board::reset (void)
 	// scenario is, board data should not be loaded from the keyfile when a new
 	// game is requested
 	load_from_user_data = false;
+	discard_autosave();
 
 	return;
 }
@@ -225,6 +369,8 @@ Glib::ustring Board::get_username (void)
 void Board::set_username (Glib::ustring name)
 {
 	username = name;
+	fastest_time = 0;  // Unless this user has one below
+	journal_generation = 0;
 
 	if (user_data.has_group(name)) {  // If this user has played before
 
@@ -234,6 +380,9 @@ void Board::set_username (Glib::ustring name)
 		if (has_fastest) {  // User has a fastest time
 			fastest_time = user_data.get_double(name, "fastest_time");
 		}
+		if (user_data.has_key(name, "journal")) {
+			journal_generation = user_data.get_integer(name, "journal");
+		}
 
 		// If user is in the middle of a game
 		if (has_paused && user_data.get_double(name, "paused_time") != 0) {
@@ -241,7 +390,21 @@ void Board::set_username (Glib::ustring name)
 			load_from_user_data = true;
 			set_reserved();
 			load_board_state();
+			restore_autosave();
+
+		// Or was, when the game stopped without saving
+		} else if (user_data.has_key(name, "reserved_count")) {
+			load_from_user_data = true;
+			set_reserved();
+			load_board_state();
 
+			// No moves since, so the next game is a new one as before
+			if (!restore_autosave()) {
+				reset_board();
+				reset_reserved();
+				load_from_user_data = false;
+				variant = preferred_variant;
+			}
 		}
 
 
@@ -257,13 +420,13 @@ void Board::set_username (Glib::ustring name)
 // TODO: This is being called when a board is being made. Should it be?
 void Board::save_board_state (void)
 {
-	std::vector<int> game_row;
+	const BoardState& committed = committed_state();
 	std::vector<int> coordinate;
 	std::string game_row_string = "";
 	std::string coordinate_string = "";
 
 	int i, j;
-	for (i=0; i<RESERVED; i++) {
+	for (i=0; i<(int) reserved.size(); i++) {
 		// Save reserved coordinates
 		coordinate = reserved[i];
 		coordinate_string.push_back(coordinate[0] + '0');  // +'0' to convert to char
@@ -271,19 +434,30 @@ void Board::save_board_state (void)
 		coordinate_string.push_back(coordinate[2] + '0');
 		user_data.set_string(username, "r" + std::to_string(i), coordinate_string);
 		coordinate_string.clear();
+	}
+	user_data.set_integer(username, "reserved_count", reserved.size());
 
+	// The layout of the variant is part of the puzzle
+	user_data.set_string(username, "variant", variant_name(variant));
+	if (variant == VARIANT_JIGSAW) user_data.set_string(username, "regions", jigsaw_to_string(jigsaw));
+	if (variant == VARIANT_KILLER) user_data.set_string(username, "cages", killer_to_string(killer));
+	user_data.set_string(username, "puzzle_id", puzzle_id);
+	user_data.set_string(username, "solution", knows_solution() ? grid_to_string(unpack_grid(solution)) : "");
+
+	for (i=0; i<9; i++) {
 		// Save i'th row of the game board
-    if (i < 9) {
-      game_row = game_board[i];
-  		for (j=0; j<9; j++) {
-  			char tile = game_row[j] + '0';
-  			game_row_string.push_back(tile);
-  		}
-  		user_data.set_string(username, std::to_string(i), game_row_string);
-  		game_row_string.clear();
-    }
+		for (j=0; j<9; j++) {
+			char tile = committed.numbers.cells[i*9 + j] + '0';
+			game_row_string.push_back(tile);
+		}
+		user_data.set_string(username, std::to_string(i), game_row_string);
+		game_row_string.clear();
 	}
 
+	// Pencil marks as one mask per cell, row major
+	std::vector<int> cell_marks(committed.marks, committed.marks + 81);
+	user_data.set_integer_list(username, "marks", cell_marks);
+
 	return;
 }
 
@@ -296,12 +470,130 @@ void Board::save_time (void)
 
 void Board::save_data (void)
 {
+	TRACE_SCOPE("Board::save_data");
+
 	save_board_state();
 	save_time();
-	user_data.save_to_file("data/user_data.txt");
+
+	// Everything the journal held is in the keyfile now, so it starts over
+	if (username != "") {
+		journal_generation++;
+		user_data.set_integer(username, "journal", journal_generation);
+	}
+	snapshot();
+
+	// Only the text is made here. A background thread writes it, so a slow
+	// disk never holds up the game.
+	shared_saver().save(data_path(USER_DATA_FILE), user_data.to_data());
+
+	// The journal starts over only once the keyfile is on disk. Before then
+	// a crash still finds the old keyfile and the journal that goes with it.
+	if (username != "") {
+		shared_saver().save_after(journal_path(), "G " + std::to_string(journal_generation) + " " +
+		  grid_to_string(get_puzzle()) + "\n", data_path(USER_DATA_FILE));
+	}
+	return;
+}
+
+std::string Board::journal_path (void)
+{
+	return data_path("autosave-" + hex_name(username) + ".journal");
+}
+
+void Board::snapshot (void)
+{
+	saved = committed_state();
 	return;
 }
 
+void Board::autosave (void)
+{
+	TRACE_SCOPE("Board::autosave");
+
+	if (username == "" || reserved.empty()) return;
+
+	// Moves inside a branch are only guesses until kept
+	const BoardState& committed = committed_state();
+
+	std::string changes;
+	int i;
+	for (i=0; i<81; i++) {
+		int number = committed.numbers.cells[i];
+		if (number == saved.numbers.cells[i] && committed.marks[i] == saved.marks[i]) continue;
+
+		changes += "C " + std::to_string(i) + " " + std::to_string(number) + " " +
+		  std::to_string(committed.marks[i]) + "\n";
+	}
+	if (changes.empty()) return;
+
+	// A game with moves in it has started, even in its first second
+	long elapsed = total_time + (start_time != 0 ? time(NULL) - start_time : 0);
+	if (elapsed < 1) elapsed = 1;
+
+	shared_saver().append(journal_path(), "T " + std::to_string(elapsed) + "\n" + changes);
+	snapshot();
+	return;
+}
+
+void Board::discard_autosave (void)
+{
+	if (username != "") shared_saver().save(journal_path(), "");
+	return;
+}
+
+bool Board::restore_autosave (void)
+{
+	TRACE_SCOPE("Board::restore_autosave");
+
+	// A journal written this session may still be queued. It is read from
+	// the queue rather than waiting for the disk.
+	std::istringstream journal( shared_saver().read( journal_path()));
+	std::string line, kind;
+
+	// Only the journal of the save the board was just loaded from applies
+	int generation;
+	std::string puzzle;
+	if (!std::getline(journal, line)) return false;
+	std::istringstream header(line);
+	if (!(header >> kind >> generation >> puzzle) || kind != "G") return false;
+	if (generation != journal_generation || puzzle != grid_to_string(get_puzzle())) return false;
+
+	// The last change to each cell wins
+	int numbers[81];
+	int cell_marks[81];
+	std::fill(numbers, numbers + 81, -1);
+	long elapsed = -1;
+
+	while (std::getline(journal, line)) {
+		std::istringstream fields(line);
+		int cell, number, mask;
+		long seconds;
+
+		if (!(fields >> kind)) continue;
+		if (kind == "T" && fields >> seconds) {
+			elapsed = seconds;
+		} else if (kind == "C" && fields >> cell >> number >> mask && cell >= 0 && cell < 81 &&
+		  number >= 0 && number <= 9) {
+			numbers[cell] = number;
+			cell_marks[cell] = mask;
+		}
+	}
+	if (elapsed < 0) return false;  // Nothing after the header, or cut off
+
+	// Numbers first, which would otherwise clear marks from their peers
+	int i;
+	for (i=0; i<81; i++) {
+		if (numbers[i] >= 0 && !check_reserved(i / 9, i % 9)) set_number(numbers[i], i / 9, i % 9);
+	}
+	for (i=0; i<81; i++) {
+		if (numbers[i] >= 0) set_marks(cell_marks[i], i / 9, i % 9);
+	}
+
+	total_time = std::max<double>(total_time, elapsed);
+	snapshot();
+	return true;
+}
+
 bool Board::get_checking_win (void)
 {
 	return checking_win;
@@ -316,8 +608,20 @@ void Board::set_checking_win (bool checking)
 
 void Board::load_board_state (void)
 {
+	TRACE_SCOPE("Board::load_board_state");
+
 	if (!load_from_user_data) return;
 
+	// Saved with the game, but only trusted if it agrees with the clues
+	solution_stored = false;
+	Grid saved_solution;
+	if (user_data.has_key(username, "solution") &&
+	  grid_from_string(user_data.get_string(username, "solution"), saved_solution) &&
+	  count_givens(saved_solution) == 81) {
+		solution = pack_grid(saved_solution);
+		solution_stored = true;
+	}
+
 	std::string key;
 	std::string row;
 
@@ -334,6 +638,18 @@ void Board::load_board_state (void)
 		}
 	}
 
+	// After the numbers, which would otherwise clear marks from their peers
+	if (user_data.has_key(username, "marks")) {
+		std::vector<int> cell_marks = user_data.get_integer_list(username, "marks");
+		for (i=0; i<81 && i<(int) cell_marks.size(); i++) set_marks(cell_marks[i], i / 9, i % 9);
+	}
+
+	for (auto coordinate : reserved) {
+		int cell = coordinate[0]*9 + coordinate[1];
+		if (packed_cell(solution, cell) != state.numbers.cells[cell]) solution_stored = false;
+	}
+
+	analyze();  // Known puzzles come straight from the cache
 	return;
 }
 
@@ -344,106 +660,390 @@ void Board::set_reserved (void)
 	std::string key = "r";
 	std::string row;
 
+	// Games saved before the count was stored always had RESERVED cells
+	int count = RESERVED;
+	if (user_data.has_key(username, "reserved_count")) {
+		count = user_data.get_integer(username, "reserved_count");
+	}
+	reserved.resize(count);
+
 	int i;
-	for (i=0; i<RESERVED; i++) {
+	for (i=0; i<count; i++) {
 		key = key + std::to_string(i);
 		row = user_data.get_string(username, key);
 
-		reserved[i][0] = row[0] - '0';
-		reserved[i][1] = row[1] - '0';
-		reserved[i][2] = row[2] - '0';
+		reserved[i] = {row[0] - '0', row[1] - '0', row[2] - '0'};
 
 		key = "r";
 	}
 
+	// Games saved before variants existed are classic
+	failed_variant = -1;
+	variant = VARIANT_CLASSIC;
+	if (user_data.has_key(username, "variant")) {
+		variant = variant_from_name(user_data.get_string(username, "variant"));
+	}
+	if (variant == VARIANT_JIGSAW && (!user_data.has_key(username, "regions") ||
+	  !jigsaw_from_string(user_data.get_string(username, "regions"), jigsaw))) {
+		variant = VARIANT_CLASSIC;
+	}
+	if (variant == VARIANT_KILLER && (!user_data.has_key(username, "cages") ||
+	  !killer_from_string(user_data.get_string(username, "cages"), killer))) {
+		variant = VARIANT_CLASSIC;
+	}
+
+	puzzle_id = "";
+	if (user_data.has_key(username, "puzzle_id")) puzzle_id = user_data.get_string(username, "puzzle_id");
+
 	reserved_set = true;
 	return;
 }
 
 void Board::generate_reserved (void)
 {
+	TRACE_SCOPE("Board::generate_reserved");
+
 	// If this user already has reserved tiles, don't set
 	if (reserved_set) return;
 
-	srand( time(NULL));  // Initialize random seed
+	failed_variant = -1;
+	if (imported) {
+		imported = false;  // Already in generated
+		variant = VARIANT_CLASSIC;
+		puzzle_id = imported_id;
+		if (imported_id != "") {
+			solution = imported_solution;
+			solution_stored = true;
+		}
+		imported_id = "";
+	} else {
+		uint64_t seed = seed_chosen ? chosen_seed : fresh_seed();
+		variant = seed_chosen ? chosen_variant : preferred_variant;
+		seed_chosen = false;
+
+		puzzle_id = make_puzzle_id(variant, symmetry, seed);
+
+		Random random(seed);
+		Grid full;
+		if (variant == VARIANT_CLASSIC) {
+			generated = generate_puzzle(symmetry, 0, &full, random);
+		} else if (!generate_variant(random, generated, full)) {
+			// The classic puzzle of the same seed is played instead, for
+			// this game only
+			failed_variant = variant;
+			variant = VARIANT_CLASSIC;
+			puzzle_id = make_puzzle_id(variant, symmetry, seed);
+			Random classic(seed);
+			generated = generate_puzzle(symmetry, 0, &full, classic);
+		}
+
+		solution = pack_grid(full);
+		solution_stored = true;
+	}
 
+	reserved.clear();
 	int i;
-	for (i=0; i<RESERVED; i++) {
-		// Generate between 0 and 9
-		int row = rand() % 10;
-		int col = rand() % 10;
-
-		// Must be between 0 and 8 since reserved has size 9
-		while (row == 9) row = rand() % 10;
-		while (col == 9) col = rand() % 10;
-
-		if ( !check_reserved(row, col)) {
-			reserved[i][0] = row;
-			reserved[i][1] = col;
-			reserved[i][2] = blocksLookup.at(row/3).at(col/3);
-		}
-		else i -= 1;
+	for (i=0; i<81; i++) {
+		if (generated.cells[i] == 0) continue;
 
+		int row = i / 9;
+		int col = i % 9;
+		reserved.push_back({row, col, blocksLookup.at(row/3).at(col/3)});
 	}
 
 	reserved_set = true;
+	TRACE_COUNTER("clues", reserved.size());
 	populate_reserved();
 	return;
 }
 
-void Board::populate_reserved (void)
+std::string Board::get_puzzle_id (void)
 {
-	srand( time(NULL)); // Initialize random seed
+	return puzzle_id;
+}
 
-	// Breaks rules if same row as other reserved with same number or if same
-	// column as other reserved with same number or if same block as other
-	// reserved with same number
+bool Board::set_puzzle_id (const std::string& id)
+{
+	if (!parse_puzzle_id(id, chosen_variant, symmetry, chosen_seed)) return false;
 
-	// Two loops since we must compare each generated value with each previously
-	// generated value
+	seed_chosen = true;
+	return true;
+}
 
-	int i, j;
-	for (i=0; i<RESERVED; i++) {
-		int value = rand() % 10;
-		while (value == 0) value = rand() % 10;
-
-		std::vector<int> coordinate = reserved[i];
-		int x1 = coordinate[0];
-		int y1 = coordinate[1];
-		int z1 = coordinate[2]; // Block index
-
-		for (j=0; j<RESERVED; j++) {
-			if (i != j) {
-				std::vector<int> compare = reserved[j];
-				int x2 = compare[0];
-				int y2 = compare[1];
-				int z2 = compare[2];
-
-				int comp_value = get_number(x2, y2);
-
-				bool same_value = comp_value == value;
-				bool same_row = x1 == x2;
-				bool same_col = y1 == y2;
-				bool same_block = z1 == z2;
-
-				// Breaks rule, regenerate value
-				if ((same_row || same_col || same_block) && same_value) {
-					i -= 1;
-
-				// Doesn't break rules, add to internal board state
-				} else {
-					set_number(value, x1, y1);
-				}
+bool Board::import_puzzle (const Grid& puzzle)
+{
+	// A puzzle with more than one solution can't be checked against one answer
+	if (count_solutions(puzzle, 2, nullptr) != 1) return false;
 
-			}
-		}
+	generated = puzzle;
+	imported = true;
+	imported_id = "";
+	return true;
+}
+
+void Board::import_generated (const Grid& puzzle, const Grid& full, const std::string& id)
+{
+	generated = puzzle;
+	imported = true;
+	imported_id = id;
+	imported_solution = pack_grid(full);
+	return;
+}
 
+bool Board::export_puzzle (const std::string& path)
+{
+	return write_puzzles(path, {get_puzzle()}, format_from_path(path), true);
+}
+
+void Board::populate_reserved (void)
+{
+	// The generator already made sure the numbers follow the rules of the variant
+	for (auto coordinate : reserved) {
+		int row = coordinate[0];
+		int col = coordinate[1];
+		set_number(generated.cells[row*9 + col], row, col);
 	}
+
+	analyze();
 	if (username != "") save_data();
 	return;
 }
 
+void Board::set_symmetry (int pattern)
+{
+	symmetry = pattern;
+	return;
+}
+
+void Board::set_variant (int rules)
+{
+	preferred_variant = rules;
+	if (!reserved_set) variant = rules;  // No game yet to keep its own
+	return;
+}
+
+int Board::get_variant (void)
+{
+	return variant;
+}
+
+int Board::get_failed_variant (void)
+{
+	return failed_variant;
+}
+
+bool Board::generate_variant (Random& random, Grid& puzzle, Grid& full)
+{
+	// A search that gives up starts over, with a new layout for jigsaws since
+	// some layouts have no solution at all
+	int attempt;
+	for (attempt=0; attempt<VARIANT_ATTEMPTS; attempt++) {
+		switch (variant) {
+			case VARIANT_DIAGONAL:
+				if (!random_variant_solution(DiagonalRules(), full, random)) continue;
+				puzzle = reduce_variant(DiagonalRules(), full, symmetry, random);
+				return true;
+
+			case VARIANT_JIGSAW:
+				jigsaw = random_jigsaw(random);
+				if (!random_variant_solution(JigsawRules(Rows(), Columns(), jigsaw), full, random)) continue;
+				puzzle = reduce_variant(JigsawRules(Rows(), Columns(), jigsaw), full, symmetry, random);
+				return true;
+
+			case VARIANT_KILLER:
+				// Cages are cut from a classic solution. The sums do the work of
+				// most clues, so far fewer are left.
+				random_solution(full, random);
+				killer = random_killer(full, random);
+				puzzle = reduce_variant(KillerRules(Rows(), Columns(), Blocks(), killer), full, symmetry,
+				  random);
+				return true;
+
+			case VARIANT_ANTI_KNIGHT:
+				if (!random_variant_solution(AntiKnightRules(), full, random)) continue;
+				puzzle = reduce_variant(AntiKnightRules(), full, symmetry, random);
+				return true;
+
+			default:
+				puzzle = generate_puzzle(symmetry, 0, &full, random);
+				return true;
+		}
+	}
+
+	return false;
+}
+
+int Board::count_with_rules (const Grid& puzzle, int limit, Grid* found)
+{
+	switch (variant) {
+		case VARIANT_DIAGONAL:
+			return count_variant_solutions(DiagonalRules(), puzzle, limit, found);
+		case VARIANT_JIGSAW:
+			return count_variant_solutions(JigsawRules(Rows(), Columns(), jigsaw), puzzle, limit, found);
+		case VARIANT_KILLER:
+			return count_variant_solutions(KillerRules(Rows(), Columns(), Blocks(), killer), puzzle,
+			  limit, found);
+		case VARIANT_ANTI_KNIGHT:
+			return count_variant_solutions(AntiKnightRules(), puzzle, limit, found);
+		default:
+			return count_variant_solutions(ClassicRules(), puzzle, limit, found);
+	}
+}
+
+std::vector<std::string> Board::cell_classes (int row, int col)
+{
+	std::vector<std::string> classes;
+	int cell = row*9 + col;
+
+	// Only these constraints add classes. Called for every cell on every
+	// repaint, so the layouts are not copied into a rule set.
+	switch (variant) {
+		case VARIANT_DIAGONAL: Diagonals().style(cell, classes); break;
+		case VARIANT_JIGSAW: jigsaw.style(cell, classes); break;
+		case VARIANT_KILLER: killer.style(cell, classes); break;
+		default: break;
+	}
+
+	return classes;
+}
+
+int Board::region_of (int row, int col)
+{
+	if (variant == VARIANT_JIGSAW) return jigsaw.region[row*9 + col];
+	return (row / 3) * 3 + col / 3;
+}
+
+std::string Board::cell_label (int row, int col)
+{
+	if (variant != VARIANT_KILLER) return "";
+
+	int cell = row*9 + col;
+	int cage = killer.cage_of[cell];
+	if (cage < 0) return "";
+
+	// The sum goes in the first cell of the cage, reading left to right
+	for (int member : killer.cages[cage].cells) {
+		if (member < cell) return "";
+	}
+	return std::to_string(killer.cages[cage].sum);
+}
+
 std::vector< std::vector< int>> Board::get_reserved (void)
 {
 	return reserved;
 }
+
+Grid Board::get_puzzle (void)
+{
+	Grid puzzle = empty_grid();
+
+	for (auto coordinate : reserved) {
+		int row = coordinate[0];
+		int col = coordinate[1];
+		puzzle.cells[row*9 + col] = get_number(row, col);
+	}
+
+	return puzzle;
+}
+
+PuzzleHash Board::puzzle_hash (void)
+{
+	return canonical_hash(get_puzzle());
+}
+
+void Board::analyze (void)
+{
+	TRACE_SCOPE("Board::analyze");
+
+	Grid puzzle = get_puzzle();
+	Grid found = empty_grid();
+
+	// The cache and rater only know classic rules, and a variant puzzle can
+	// share a hash with an unrelated classic one
+	if (variant != VARIANT_CLASSIC) {
+		analysis = Analysis();
+		if (solution_stored) {
+			analysis.solutions = 1;  // Generated puzzles have only one
+		} else {
+			analysis.solutions = count_with_rules(puzzle, 2, &found);
+			solution = pack_grid(found);
+		}
+		analysis.rated = false;
+		analysis.difficulty = UNRATED;
+		analyzed = true;
+		return;
+	}
+
+	// A generated puzzle came with its solution, so it is only rated
+	if (solution_stored) {
+		analysis = analyze_solved_puzzle(puzzle, unpack_grid(solution), shared_cache());
+	} else {
+		analysis = analyze_puzzle(puzzle, shared_cache(), found);
+		solution = pack_grid(found);
+	}
+
+	if (!analysis.rated) {  // Only new puzzles need rating
+		Rating rating = rate_puzzle(puzzle, &shared_cache());
+		analysis.rated = true;
+		analysis.difficulty = rating.difficulty;
+		analysis.hardest = rating.hardest;
+		analysis.steps = rating.steps;
+	}
+
+	analyzed = true;
+	return;
+}
+
+int Board::solution_count (void)
+{
+	if (!analyzed) analyze();
+	return analysis.solutions;
+}
+
+int Board::get_difficulty (void)
+{
+	if (!analyzed) analyze();
+	return analysis.difficulty;
+}
+
+bool Board::get_hint (int& row, int& col, int& number)
+{
+	if (!solution_stored && !analyzed) analyze();
+	if (!solution_stored && analysis.solutions <= 0) return false;
+
+	PackedGrid entries = pack_grid(state.numbers);
+	CellSet wrong = wrong_cells(entries, solution);
+	CellSet empty = empty_cells(entries);
+
+	// The first cell in row major order that is wrong or empty
+	uint64_t low = wrong.low | empty.low;
+	uint64_t high = wrong.high | empty.high;
+	if (low == 0 && high == 0) return false;
+
+	int cell = low != 0 ? __builtin_ctzll(low) : 64 + __builtin_ctzll(high);
+	row = cell / 9;
+	col = cell % 9;
+	number = packed_cell(solution, cell);
+	return true;
+}
+
+bool Board::knows_solution (void)
+{
+	return solution_stored || (analyzed && analysis.solutions == 1);
+}
+
+CellSet Board::check_progress (void)
+{
+	TRACE_SCOPE("Board::check_progress");
+
+	if (!knows_solution()) return CellSet{0, 0};
+	return wrong_cells(pack_grid(state.numbers), solution);
+}
+
+bool Board::reveal_cell (int row, int col, int& number)
+{
+	if (!knows_solution() || check_reserved(row, col)) return false;
+
+	number = packed_cell(solution, row*9 + col);
+	return true;
+}
@@ -0,0 +1,460 @@
+/* Last Modified: 10/19/26
+ * Author: Alex Eastman
+ * Contact: alexeast@buffalo.edu
+ * Summary: Definitions for function prototypes found in board_view.h . See
+ *          board_view.h for explanation of functions
+ */
+
+
+#include "board_view.h"
+#include "trace.h"
+#include <gdk/gdkkeysyms.h>
+#include <gtkmm/clipboard.h>
+#include <cairomm/region.h>
+#include <pangomm/layout.h>
+#include <algorithm>
+
+namespace {
+
+struct Color {
+	double red, green, blue;
+};
+
+const Color white = {1, 1, 1};
+const Color selected = {1, 0.96, 0.8};
+const Color wrong = {0.98, 0.8, 0.8};
+const Color given_digit = {0, 0, 0};
+const Color user_digit = {0.2, 0.36, 0.69};
+const Color mark_digit = {0.45, 0.45, 0.45};
+const Color thin_line = {0.7, 0.7, 0.7};
+const Color thick_line = {0, 0, 0};
+
+/* Backgrounds for the style classes from Board::cell_classes. Regions and
+ * cages use five colors so that touching ones differ.
+ */
+struct StyleColor {
+	const char* name;
+	Color color;
+};
+
+const StyleColor style_colors[] = {
+	{"diagonal", {0.894, 0.925, 0.957}},
+	{"region_0", {0.965, 0.906, 0.847}}, {"cage_0", {0.965, 0.906, 0.847}},
+	{"region_1", {0.863, 0.922, 0.863}}, {"cage_1", {0.863, 0.922, 0.863}},
+	{"region_2", {0.867, 0.898, 0.949}}, {"cage_2", {0.867, 0.898, 0.949}},
+	{"region_3", {0.937, 0.863, 0.925}}, {"cage_3", {0.937, 0.863, 0.925}},
+	{"region_4", {0.949, 0.941, 0.839}}, {"cage_4", {0.949, 0.941, 0.839}}
+};
+
+void set_color (const Cairo::RefPtr<Cairo::Context>& cr, const Color& color)
+{
+	cr -> set_source_rgb(color.red, color.green, color.blue);
+	return;
+}
+
+}
+
+BoardView::BoardView (Board& shown)
+{
+	board = &shown;
+	selected_row = 0;
+	selected_col = 0;
+	cell_size = 0;
+	origin_x = 0;
+	origin_y = 0;
+	flagged = empty_grid();
+	batch_depth = 0;
+	dirty = {0, 0};
+
+	set_size_request(CELL_SIZE * 9, CELL_SIZE * 9);
+	set_hexpand(true);
+	set_vexpand(true);
+	set_can_focus(true);
+	add_events(Gdk::KEY_PRESS_MASK | Gdk::BUTTON_PRESS_MASK);
+}
+
+void BoardView::show_board (Board& shown)
+{
+	board = &shown;
+	refresh();
+	return;
+}
+
+sigc::signal<void, int, int, int>& BoardView::signal_cell_changed (void)
+{
+	return cell_changed;
+}
+
+sigc::signal<void, int, int, int>& BoardView::signal_mark_toggled (void)
+{
+	return mark_toggled;
+}
+
+sigc::signal<void, const Grid&>& BoardView::signal_board_pasted (void)
+{
+	return board_pasted;
+}
+
+void BoardView::on_size_allocate (Gtk::Allocation& allocation)
+{
+	Gtk::DrawingArea::on_size_allocate(allocation);
+
+	int size = std::min(allocation.get_width(), allocation.get_height()) / 9;
+	origin_x = (allocation.get_width() - size * 9) / 2;
+	origin_y = (allocation.get_height() - size * 9) / 2;
+
+	// Glyphs only need rendering again when the cells change size
+	if (size != cell_size) {
+		cell_size = size;
+		render_glyphs(true);
+		render_glyphs(false);
+		render_marks();
+	}
+
+	return;
+}
+
+void BoardView::render_glyphs (bool given)
+{
+	TRACE_SCOPE("BoardView::render_glyphs");
+
+	Pango::FontDescription font = get_style_context() -> get_font();
+	font.set_absolute_size(cell_size * 0.55 * PANGO_SCALE);
+	font.set_weight(given ? Pango::WEIGHT_BOLD : Pango::WEIGHT_NORMAL);
+
+	int digit;
+	for (digit=1; digit<=9; digit++) {
+		auto surface = Cairo::ImageSurface::create(Cairo::FORMAT_ARGB32, cell_size, cell_size);
+		auto cr = Cairo::Context::create(surface);
+
+		auto layout = create_pango_layout( std::to_string(digit));
+		layout -> set_font_description(font);
+
+		int width, height;
+		layout -> get_pixel_size(width, height);
+		cr -> move_to((cell_size - width) / 2.0, (cell_size - height) / 2.0);
+		set_color(cr, given ? given_digit : user_digit);
+		layout -> show_in_cairo_context(cr);
+
+		if (given) given_glyphs[digit] = surface;
+		else user_glyphs[digit] = surface;
+	}
+
+	return;
+}
+
+void BoardView::render_marks (void)
+{
+	TRACE_SCOPE("BoardView::render_marks");
+
+	int side = cell_size / 3;
+	Pango::FontDescription font = get_style_context() -> get_font();
+	font.set_absolute_size(side * 0.6 * PANGO_SCALE);
+
+	int digit;
+	for (digit=1; digit<=9; digit++) {
+		auto surface = Cairo::ImageSurface::create(Cairo::FORMAT_ARGB32, side, side);
+		auto cr = Cairo::Context::create(surface);
+
+		auto layout = create_pango_layout( std::to_string(digit));
+		layout -> set_font_description(font);
+
+		int width, height;
+		layout -> get_pixel_size(width, height);
+		cr -> move_to((side - width) / 2.0, (side - height) / 2.0);
+		set_color(cr, mark_digit);
+		layout -> show_in_cairo_context(cr);
+
+		mark_glyphs[digit] = surface;
+	}
+
+	return;
+}
+
+bool BoardView::on_draw (const Cairo::RefPtr<Cairo::Context>& cr)
+{
+	TRACE_SCOPE("BoardView::on_draw");
+
+	// Only cells inside the area being repainted need drawing
+	double left, top, right, bottom;
+	cr -> get_clip_extents(left, top, right, bottom);
+
+	int i, j;
+	for (i=0; i<9; i++) {
+		int y = origin_y + i * cell_size;
+		if (y + cell_size < top || y > bottom) continue;
+
+		for (j=0; j<9; j++) {
+			int x = origin_x + j * cell_size;
+			if (x + cell_size < left || x > right) continue;
+			draw_cell(cr, i, j);
+		}
+	}
+
+	draw_lines(cr);
+	return true;
+}
+
+void BoardView::draw_cell (const Cairo::RefPtr<Cairo::Context>& cr, int row, int col)
+{
+	int x = origin_x + col * cell_size;
+	int y = origin_y + row * cell_size;
+
+	// Background from the variant, unless selected
+	Color background = white;
+	for (auto style_class : board -> cell_classes(row, col)) {
+		for (const StyleColor& style : style_colors) {
+			if (style_class == style.name) background = style.color;
+		}
+	}
+	if (row == selected_row && col == selected_col) background = selected;
+
+	int number = board -> get_number(row, col);
+	if (number != 0 && flagged.cells[row*9 + col] == number) background = wrong;
+
+	set_color(cr, background);
+	cr -> rectangle(x, y, cell_size, cell_size);
+	cr -> fill();
+
+	if (number > 0 && number <= 9) {
+		auto& glyphs = board -> check_reserved(row, col) ? given_glyphs : user_glyphs;
+		cr -> set_source(glyphs[number], x, y);
+		cr -> rectangle(x, y, cell_size, cell_size);
+		cr -> fill();
+	} else {
+		// Each mark has its own spot, 1 top left to 9 bottom right
+		unsigned short marks = board -> get_marks(row, col);
+		int side = cell_size / 3;
+		int digit;
+		for (digit=1; digit<=9; digit++) {
+			if ( !(marks & (1 << (digit - 1)))) continue;
+			int mark_x = x + (digit - 1) % 3 * side;
+			int mark_y = y + (digit - 1) / 3 * side;
+			cr -> set_source(mark_glyphs[digit], mark_x, mark_y);
+			cr -> rectangle(mark_x, mark_y, side, side);
+			cr -> fill();
+		}
+	}
+
+	// Killer cage sums go small in the top left corner
+	std::string label = board -> cell_label(row, col);
+	if (!label.empty()) {
+		auto layout = create_pango_layout(label);
+		Pango::FontDescription font = get_style_context() -> get_font();
+		font.set_absolute_size(cell_size * 0.2 * PANGO_SCALE);
+		layout -> set_font_description(font);
+
+		cr -> move_to(x + 3, y + 1);
+		set_color(cr, given_digit);
+		layout -> show_in_cairo_context(cr);
+	}
+
+	return;
+}
+
+bool BoardView::region_edge (int row, int col, int other_row, int other_col)
+{
+	return board -> region_of(row, col) != board -> region_of(other_row, other_col);
+}
+
+void BoardView::draw_lines (const Cairo::RefPtr<Cairo::Context>& cr)
+{
+	int size = cell_size * 9;
+	int i, j;
+
+	// Thin lines everywhere first, then thick ones over them
+	set_color(cr, thin_line);
+	cr -> set_line_width(1);
+	for (i=1; i<9; i++) {
+		cr -> move_to(origin_x + i * cell_size + 0.5, origin_y);
+		cr -> line_to(origin_x + i * cell_size + 0.5, origin_y + size);
+		cr -> move_to(origin_x, origin_y + i * cell_size + 0.5);
+		cr -> line_to(origin_x + size, origin_y + i * cell_size + 0.5);
+	}
+	cr -> stroke();
+
+	set_color(cr, thick_line);
+	cr -> set_line_width(2);
+	for (i=0; i<9; i++) {
+		for (j=0; j<9; j++) {
+			int x = origin_x + j * cell_size;
+			int y = origin_y + i * cell_size;
+			if (j < 8 && region_edge(i, j, i, j + 1)) {
+				cr -> move_to(x + cell_size, y);
+				cr -> line_to(x + cell_size, y + cell_size);
+			}
+			if (i < 8 && region_edge(i, j, i + 1, j)) {
+				cr -> move_to(x, y + cell_size);
+				cr -> line_to(x + cell_size, y + cell_size);
+			}
+		}
+	}
+	cr -> rectangle(origin_x + 1, origin_y + 1, size - 2, size - 2);
+	cr -> stroke();
+
+	return;
+}
+
+void BoardView::refresh_cell (int row, int col)
+{
+	if (batch_depth > 0) {
+		int cell = row*9 + col;
+		if (cell < 64) dirty.low |= (uint64_t) 1 << cell;
+		else dirty.high |= (uint64_t) 1 << (cell - 64);
+		return;
+	}
+
+	// One pixel extra on each side covers the lines around the cell
+	queue_draw_area(origin_x + col * cell_size - 1, origin_y + row * cell_size - 1,
+	  cell_size + 2, cell_size + 2);
+	return;
+}
+
+void BoardView::refresh_peers (int row, int col)
+{
+	// Jigsaw regions are not in the unit tables
+	if (board -> get_variant() == VARIANT_JIGSAW) {
+		refresh();
+		return;
+	}
+
+	const UnitTables& tables = unit_tables();
+	int cell = row*9 + col;
+	int i;
+	for (i=0; i<20; i++) refresh_cell(tables.peers[cell][i] / 9, tables.peers[cell][i] % 9);
+	return;
+}
+
+void BoardView::refresh (void)
+{
+	if (batch_depth > 0) {
+		dirty = {~(uint64_t) 0, ((uint64_t) 1 << 17) - 1};
+		return;
+	}
+
+	queue_draw();
+	return;
+}
+
+void BoardView::begin_batch (void)
+{
+	batch_depth++;
+	return;
+}
+
+void BoardView::end_batch (void)
+{
+	if (batch_depth == 0 || --batch_depth > 0) return;
+	if (dirty.low == 0 && dirty.high == 0) return;  // Nothing changed
+
+	// Each cell with the pixel around it that refresh_cell would invalidate
+	Cairo::RefPtr<Cairo::Region> region = Cairo::Region::create();
+	int cell;
+	for (cell=0; cell<81; cell++) {
+		if (!in_cell_set(dirty, cell)) continue;
+		Cairo::RectangleInt area = {origin_x + (cell % 9) * cell_size - 1,
+		  origin_y + (cell / 9) * cell_size - 1, cell_size + 2, cell_size + 2};
+		region -> do_union(area);
+	}
+	queue_draw_region(region);
+
+	dirty = {0, 0};
+	return;
+}
+
+void BoardView::select (int row, int col)
+{
+	refresh_cell(selected_row, selected_col);
+	selected_row = std::max(0, std::min(8, row));
+	selected_col = std::max(0, std::min(8, col));
+	refresh_cell(selected_row, selected_col);
+	return;
+}
+
+void BoardView::get_selection (int& row, int& col)
+{
+	row = selected_row;
+	col = selected_col;
+	return;
+}
+
+void BoardView::flag_cells (const CellSet& cells)
+{
+	flagged = empty_grid();
+
+	int i;
+	for (i=0; i<81; i++) {
+		if (in_cell_set(cells, i)) flagged.cells[i] = board -> get_number(i / 9, i % 9);
+	}
+
+	refresh();
+	return;
+}
+
+bool BoardView::on_key_press_event (GdkEventKey* event)
+{
+	guint key = event -> keyval;
+	int number = -1;
+
+	if (key >= GDK_KEY_1 && key <= GDK_KEY_9) number = key - GDK_KEY_0;
+	else if (key >= GDK_KEY_KP_1 && key <= GDK_KEY_KP_9) number = key - GDK_KEY_KP_0;
+	else if (key == GDK_KEY_0 || key == GDK_KEY_KP_0 || key == GDK_KEY_BackSpace ||
+	  key == GDK_KEY_Delete) number = 0;
+
+	switch (key) {
+		case GDK_KEY_Up: select(selected_row - 1, selected_col); return true;
+		case GDK_KEY_Down: select(selected_row + 1, selected_col); return true;
+		case GDK_KEY_Left: select(selected_row, selected_col - 1); return true;
+		case GDK_KEY_Right: select(selected_row, selected_col + 1); return true;
+		default: break;
+	}
+
+	// Control and V pastes a whole grid
+	if ((event -> state & GDK_CONTROL_MASK) && (key == GDK_KEY_v || key == GDK_KEY_V)) {
+		Gtk::Clipboard::get() -> request_text( sigc::mem_fun(*this, &BoardView::on_paste_text));
+		return true;
+	}
+
+	if (number == -1) return Gtk::DrawingArea::on_key_press_event(event);
+
+	// Control and a number notes it as a candidate for an empty cell
+	if (event -> state & GDK_CONTROL_MASK) {
+		if (number > 0 && board -> get_number(selected_row, selected_col) == 0) {
+			mark_toggled.emit(selected_row, selected_col, number);
+		}
+		return true;
+	}
+
+	// Reserved cells and no-op changes are swallowed
+	if ( !board -> check_reserved(selected_row, selected_col) &&
+	  board -> get_number(selected_row, selected_col) != number) {
+		cell_changed.emit(selected_row, selected_col, number);
+	}
+
+	return true;
+}
+
+void BoardView::on_paste_text (const Glib::ustring& text)
+{
+	// Grids are often copied as nine lines of nine, or with spaces between
+	std::string line;
+	for (char c : text.raw()) {
+		if (c != ' ' && c != '\t' && c != '\r' && c != '\n') line += c;
+	}
+
+	Grid numbers;
+	if (grid_from_string(line, numbers)) board_pasted.emit(numbers);
+	return;
+}
+
+bool BoardView::on_button_press_event (GdkEventButton* event)
+{
+	grab_focus();
+
+	if (cell_size == 0) return true;
+	int row = ((int) event -> y - origin_y) / cell_size;
+	int col = ((int) event -> x - origin_x) / cell_size;
+	if (event -> y >= origin_y && event -> x >= origin_x && row < 9 && col < 9) select(row, col);
+
+	return true;
+}
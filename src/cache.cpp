@@ -0,0 +1,217 @@
+/* Last Modified: 10/19/26
+ * Author: Alex Eastman
+ * Contact: alexeast@buffalo.edu
+ * Summary: Definitions for function prototypes found in cache.h . See cache.h
+ *          for explanation of functions
+ */
+
+
+#include "cache.h"
+#include "solver.h"
+#include "rater.h"
+#include "paths.h"
+#include <fstream>
+#include <sys/stat.h>
+#include <stdio.h>
+
+AnalysisCache::AnalysisCache (size_t max_entries, std::string root)
+{
+	capacity = max_entries;
+	directory = root;
+	stats = {0, 0, 0, 0};
+}
+
+std::string AnalysisCache::path_for (const PuzzleHash& hash)
+{
+	// Shard by the first two hex digits so no directory gets too large
+	std::string name = hash_to_string(hash);
+	return directory + "/" + name.substr(0, 2) + "/" + name;
+}
+
+void AnalysisCache::remember (const Analysis& analysis)
+{
+	auto found = index.find(analysis.hash);
+	if (found != index.end()) {
+		*found -> second = analysis;
+		recent.splice(recent.begin(), recent, found -> second);
+		return;
+	}
+
+	recent.push_front(analysis);
+	index[analysis.hash] = recent.begin();
+
+	if (recent.size() > capacity) {
+		index.erase(recent.back().hash);
+		recent.pop_back();
+		stats.evictions++;
+	}
+
+	return;
+}
+
+bool AnalysisCache::read_from_disk (const PuzzleHash& hash, Analysis& analysis)
+{
+	if (directory.empty()) return false;
+
+	std::ifstream file(path_for(hash));
+	if (!file) return false;
+
+	std::string key;
+	std::string solution;
+	analysis.hash = hash;
+	analysis.solutions = 0;
+	analysis.solution = empty_grid();
+	analysis.rated = false;
+	analysis.difficulty = UNRATED;
+	analysis.hardest = -1;
+	analysis.steps = 0;
+
+	while (file >> key) {
+		if (key == "solutions") file >> analysis.solutions;
+		else if (key == "solution") file >> solution;
+		else if (key == "rated") file >> analysis.rated;
+		else if (key == "difficulty") file >> analysis.difficulty;
+		else if (key == "hardest") file >> analysis.hardest;
+		else if (key == "steps") file >> analysis.steps;
+	}
+
+	// A solvable puzzle without a readable solution is a damaged entry
+	if (analysis.solutions != 0 && !grid_from_string(solution, analysis.solution)) {
+		return false;
+	}
+
+	return true;
+}
+
+void AnalysisCache::write_to_disk (const Analysis& analysis)
+{
+	if (directory.empty()) return;
+
+	std::string path = path_for(analysis.hash);
+	std::string shard = path.substr(0, path.rfind('/'));
+	mkdir(directory.c_str(), 0755);  // Fails harmlessly if it already exists
+	mkdir(shard.c_str(), 0755);
+
+	// Write beside the entry and rename over it so readers never see half a file
+	std::string temporary = path + ".tmp";
+	std::ofstream file(temporary);
+	if (!file) return;
+
+	file << "solutions " << analysis.solutions << "\n";
+	if (analysis.solutions != 0) {
+		file << "solution " << grid_to_string(analysis.solution) << "\n";
+	}
+	if (analysis.rated) {
+		file << "rated 1\n";
+		file << "difficulty " << analysis.difficulty << "\n";
+		file << "hardest " << analysis.hardest << "\n";
+		file << "steps " << analysis.steps << "\n";
+	}
+	file.close();
+
+	rename(temporary.c_str(), path.c_str());
+	return;
+}
+
+bool AnalysisCache::lookup (const PuzzleHash& hash, Analysis& analysis)
+{
+	std::lock_guard<std::mutex> guard(lock);
+
+	auto found = index.find(hash);
+	if (found != index.end()) {
+		recent.splice(recent.begin(), recent, found -> second);
+		analysis = *found -> second;
+		stats.memory_hits++;
+		return true;
+	}
+
+	if (read_from_disk(hash, analysis)) {
+		remember(analysis);
+		stats.disk_hits++;
+		return true;
+	}
+
+	stats.misses++;
+	return false;
+}
+
+void AnalysisCache::store (const Analysis& analysis)
+{
+	std::lock_guard<std::mutex> guard(lock);
+	remember(analysis);
+	write_to_disk(analysis);
+	return;
+}
+
+CacheStats AnalysisCache::get_stats (void)
+{
+	std::lock_guard<std::mutex> guard(lock);
+	return stats;
+}
+
+double AnalysisCache::hit_rate (void)
+{
+	std::lock_guard<std::mutex> guard(lock);
+
+	long hits = stats.memory_hits + stats.disk_hits;
+	long lookups = hits + stats.misses;
+	if (lookups == 0) return 0;
+	return (double) hits / lookups;
+}
+
+void AnalysisCache::clear_memory (void)
+{
+	std::lock_guard<std::mutex> guard(lock);
+	recent.clear();
+	index.clear();
+	return;
+}
+
+AnalysisCache& shared_cache (void)
+{
+	static AnalysisCache cache(CACHE_CAPACITY, data_path(CACHE_DIRECTORY));
+	return cache;
+}
+
+Analysis analyze_puzzle (const Grid& puzzle, AnalysisCache& cache, Grid& solution)
+{
+	CanonicalForm form = canonicalize(puzzle);
+
+	Analysis analysis;
+	if (!cache.lookup(form.hash, analysis)) {
+		// Solve in the canonical frame so the solution can be shared
+		analysis.hash = form.hash;
+		analysis.solution = empty_grid();
+		analysis.solutions = count_solutions(form.grid, 2, &analysis.solution);
+		analysis.rated = false;
+		analysis.difficulty = UNRATED;
+		analysis.hardest = -1;
+		analysis.steps = 0;
+		cache.store(analysis);
+	}
+
+	if (analysis.solutions != 0) {
+		solution = invert_transform(form.transform, analysis.solution);
+	}
+
+	return analysis;
+}
+
+Analysis analyze_solved_puzzle (const Grid& puzzle, const Grid& solution, AnalysisCache& cache)
+{
+	CanonicalForm form = canonicalize(puzzle);
+
+	Analysis analysis;
+	if (!cache.lookup(form.hash, analysis)) {
+		analysis.hash = form.hash;
+		analysis.solution = apply_transform(form.transform, solution);
+		analysis.solutions = 1;
+		analysis.rated = false;
+		analysis.difficulty = UNRATED;
+		analysis.hardest = -1;
+		analysis.steps = 0;
+		cache.store(analysis);
+	}
+
+	return analysis;
+}
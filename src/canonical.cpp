@@ -0,0 +1,409 @@
+/* Last Modified: 10/19/26
+ * Author: Alex Eastman
+ * Contact: alexeast@buffalo.edu
+ * Summary: Definitions for function prototypes found in canonical.h . See
+ *          canonical.h for explanation of functions
+ */
+
+
+#include "canonical.h"
+#include <vector>
+#include <algorithm>
+#include <stdio.h>
+#include <string.h>
+
+namespace {
+
+/* The six orderings of three rows, columns, bands or stacks
+ *
+ */
+const unsigned char triples[6][3] = {
+	{0, 1, 2}, {0, 2, 1}, {1, 0, 2}, {1, 2, 0}, {2, 0, 1}, {2, 1, 0}
+};
+
+/* Every column permutation allowed by the symmetry group: 6 stack orders
+ * times 6 orders within each of the 3 stacks. perms[k][column] is the source
+ * column placed at column.
+ */
+struct ColumnTable {
+	unsigned char perms[1296][9];
+
+	ColumnTable (void)
+	{
+		int k = 0;
+		int s, a, b, c, stack, position;
+		for (s=0; s<6; s++) {
+			for (a=0; a<6; a++) {
+				for (b=0; b<6; b++) {
+					for (c=0; c<6; c++) {
+						const unsigned char* within[3] = {triples[a], triples[b], triples[c]};
+						for (stack=0; stack<3; stack++) {
+							for (position=0; position<3; position++) {
+								perms[k][stack*3 + position] =
+									triples[s][stack]*3 + within[stack][position];
+							}
+						}
+						k++;
+					}
+				}
+			}
+		}
+	}
+};
+
+/* A partial symmetry: the transposition and column permutation are fixed,
+ * rows[0..n) are the source rows chosen so far, and digits holds the labels
+ * given to digits in the order they first appeared.
+ */
+struct SearchState {
+	unsigned char transposed;
+	unsigned char next_label;
+	unsigned short column;
+	unsigned short used_rows;
+	unsigned char rows[9];
+	unsigned char digits[10];
+};
+
+/* Two states with the same key lead to the same canonical rows from here
+ * on, so only one of them needs to be searched
+ */
+uint64_t state_key (const SearchState& state)
+{
+	uint64_t key = state.transposed;
+	key = (key << 11) | state.column;
+	key = (key << 9) | state.used_rows;
+
+	int i;
+	for (i=1; i<10; i++) {
+		key = (key << 4) | state.digits[i];
+	}
+
+	return key;
+}
+
+/* Labels the source row as it would appear in the canonical grid under
+ * state, storing it in out and the new labels in state. Returns -1, 0 or 1
+ * as the row compares to best. Stops early once the row is known to be larger.
+ */
+int label_row (const unsigned char* source, const unsigned char* perm,
+  SearchState& state, const unsigned char* best, unsigned char* out)
+{
+	int comparison = 0;
+
+	int i;
+	for (i=0; i<9; i++) {
+		unsigned char value = source[perm[i]];
+		unsigned char label = 0;
+
+		if (value != 0) {
+			if (state.digits[value] == 0) state.digits[value] = state.next_label++;
+			label = state.digits[value];
+		}
+		out[i] = label;
+
+		if (comparison == 0) {
+			if (label > best[i]) return 1;
+			if (label < best[i]) comparison = -1;
+		}
+	}
+
+	return comparison;
+}
+
+/* Keeps candidate if it ties the best row so far, or replaces every state
+ * kept so far if it beats it
+ */
+void keep_if_best (int comparison, const SearchState& candidate, const unsigned char* row,
+  unsigned char* best, std::vector<SearchState>& kept)
+{
+	if (comparison > 0) return;
+
+	if (comparison < 0) {
+		memcpy(best, row, 9);
+		kept.clear();
+	}
+	kept.push_back(candidate);
+
+	return;
+}
+
+/* Finds the column permutations that make source the smallest first row.
+ * Stacks are placed one at a time so that a stack order whose prefix is
+ * already larger than the best row is never expanded.
+ */
+void search_first_row (const unsigned char* source, const SearchState& state, int stack,
+  int* chosen, int* within, unsigned char* row, unsigned char* best,
+  std::vector<SearchState>& kept)
+{
+	// The best row may have changed since the parent compared its prefix
+	int comparison = memcmp(row, best, stack*3);
+	if (comparison > 0) return;
+
+	if (stack == 3) {
+		int order;
+		for (order=0; order<6; order++) {
+			if (triples[order][0] == chosen[0] && triples[order][1] == chosen[1]) break;
+		}
+
+		SearchState leaf = state;
+		leaf.column = order*216 + within[0]*36 + within[1]*6 + within[2];
+		keep_if_best(comparison < 0 ? -1 : 0, leaf, row, best, kept);
+		return;
+	}
+
+	int source_stack, order, position;
+	for (source_stack=0; source_stack<3; source_stack++) {
+		if (source_stack == chosen[0] && stack > 0) continue;
+		if (source_stack == chosen[1] && stack > 1) continue;
+
+		for (order=0; order<6; order++) {
+			SearchState next = state;
+
+			for (position=0; position<3; position++) {
+				unsigned char value = source[source_stack*3 + triples[order][position]];
+				unsigned char label = 0;
+
+				if (value != 0) {
+					if (next.digits[value] == 0) next.digits[value] = next.next_label++;
+					label = next.digits[value];
+				}
+				row[stack*3 + position] = label;
+			}
+
+			chosen[stack] = source_stack;
+			within[stack] = order;
+			search_first_row(source, next, stack + 1, chosen, within, row, best, kept);
+		}
+	}
+
+	return;
+}
+
+/* Removes states that share a key with an earlier state. Keys are computed
+ * once up front since the sort compares each state many times.
+ */
+void remove_equivalent (std::vector<SearchState>& states,
+  std::vector< std::pair<uint64_t, int>>& keys, std::vector<SearchState>& scratch)
+{
+	if (states.size() < 2) return;
+
+	keys.clear();
+	int i;
+	for (i=0; i<(int) states.size(); i++) {
+		keys.push_back(std::make_pair(state_key(states[i]), i));
+	}
+	std::sort(keys.begin(), keys.end());
+
+	scratch.clear();
+	for (i=0; i<(int) keys.size(); i++) {
+		if (i > 0 && keys[i].first == keys[i-1].first) continue;
+		scratch.push_back(states[keys[i].second]);
+	}
+	states.swap(scratch);
+
+	return;
+}
+
+// murmur3 64 bit finalizer
+uint64_t mix (uint64_t x)
+{
+	x ^= x >> 33;
+	x *= 0xff51afd7ed558ccdULL;
+	x ^= x >> 33;
+	x *= 0xc4ceb9fe1a85ec53ULL;
+	x ^= x >> 33;
+	return x;
+}
+
+}
+
+CanonicalForm canonicalize (const Grid& puzzle)
+{
+	static const ColumnTable table;
+
+	// Source grids as given and transposed
+	unsigned char sources[2][81];
+	int i, j;
+	for (i=0; i<9; i++) {
+		for (j=0; j<9; j++) {
+			sources[0][i*9 + j] = puzzle.cells[i*9 + j];
+			sources[1][i*9 + j] = puzzle.cells[j*9 + i];
+		}
+	}
+
+	CanonicalForm form;
+	std::vector<SearchState> states;
+	std::vector<SearchState> next;
+	std::vector<SearchState> scratch;
+	std::vector< std::pair<uint64_t, int>> keys;
+	unsigned char best[9];
+	unsigned char row[9];
+
+	// First row: every transposition and source row, pruned over column permutations
+	memset(best, 10, sizeof(best));
+	int transposed, source_row;
+	for (transposed=0; transposed<2; transposed++) {
+		for (source_row=0; source_row<9; source_row++) {
+			SearchState state;
+			memset(&state, 0, sizeof(state));
+			state.transposed = transposed;
+			state.next_label = 1;
+			state.used_rows = 1 << source_row;
+			state.rows[0] = source_row;
+
+			int chosen[3] = {-1, -1, -1};
+			int within[3] = {0, 0, 0};
+			search_first_row(&sources[transposed][source_row*9], state, 0, chosen, within,
+				row, best, states);
+		}
+	}
+	remove_equivalent(states, keys, scratch);
+	memcpy(form.grid.cells, best, 9);
+
+	// Remaining rows: extend each kept state by every row it is allowed next
+	int out_row;
+	for (out_row=1; out_row<9; out_row++) {
+		memset(best, 10, sizeof(best));
+		next.clear();
+
+		for (const SearchState& state : states) {
+			int first, last;
+			if (out_row % 3 == 0) {  // Starting a new band, any unused band
+				first = 0;
+				last = 9;
+			} else {  // Must stay in the band started by the previous rows
+				first = (state.rows[out_row - out_row%3] / 3) * 3;
+				last = first + 3;
+			}
+
+			for (source_row=first; source_row<last; source_row++) {
+				if (state.used_rows & (1 << source_row)) continue;
+				if (out_row % 3 == 0 && (state.used_rows & (7 << (source_row/3)*3))) continue;
+
+				SearchState candidate = state;
+				candidate.rows[out_row] = source_row;
+				candidate.used_rows |= 1 << source_row;
+
+				int comparison = label_row(&sources[candidate.transposed][source_row*9],
+					table.perms[candidate.column], candidate, best, row);
+				keep_if_best(comparison, candidate, row, best, next);
+			}
+		}
+
+		remove_equivalent(next, keys, scratch);
+		states.swap(next);
+		memcpy(&form.grid.cells[out_row*9], best, 9);
+	}
+
+	// Every state left reaches the canonical grid. Use the first.
+	const SearchState& found = states.front();
+	form.transform.transposed = found.transposed;
+	memcpy(form.transform.rows, found.rows, 9);
+	memcpy(form.transform.columns, table.perms[found.column], 9);
+	memcpy(form.transform.digits, found.digits, 10);
+
+	// Digits that never appeared take the remaining labels in order
+	unsigned char label = found.next_label;
+	for (i=1; i<10; i++) {
+		if (form.transform.digits[i] == 0) form.transform.digits[i] = label++;
+	}
+
+	form.hash = hash_grid(form.grid);
+	return form;
+}
+
+PuzzleHash canonical_hash (const Grid& puzzle)
+{
+	return canonicalize(puzzle).hash;
+}
+
+PuzzleHash hash_grid (const Grid& grid)
+{
+	// Pack cells into 4 bits each, 16 cells per word
+	uint64_t words[6] = {0, 0, 0, 0, 0, 0};
+	int i;
+	for (i=0; i<81; i++) {
+		words[i/16] |= (uint64_t) (grid.cells[i] & 0xf) << ((i%16) * 4);
+	}
+
+	uint64_t high = 0x243f6a8885a308d3ULL;
+	uint64_t low = 0x13198a2e03707344ULL;
+	for (i=0; i<6; i++) {
+		high = mix(high ^ words[i]) + low;
+		low = mix(low ^ ((words[i] << 31) | (words[i] >> 33))) + high;
+	}
+
+	PuzzleHash hash;
+	hash.high = mix(high ^ 81);
+	hash.low = mix(low + hash.high);
+	return hash;
+}
+
+Grid apply_transform (const Transform& transform, const Grid& grid)
+{
+	Grid out;
+
+	int i, j;
+	for (i=0; i<9; i++) {
+		for (j=0; j<9; j++) {
+			int row = transform.rows[i];
+			int column = transform.columns[j];
+			unsigned char value = transform.transposed ?
+				grid.cells[column*9 + row] : grid.cells[row*9 + column];
+			out.cells[i*9 + j] = transform.digits[value];
+		}
+	}
+
+	return out;
+}
+
+Grid invert_transform (const Transform& transform, const Grid& grid)
+{
+	unsigned char inverse[10];
+	int i, j;
+	for (i=0; i<10; i++) {
+		inverse[transform.digits[i]] = i;
+	}
+
+	Grid out;
+	for (i=0; i<9; i++) {
+		for (j=0; j<9; j++) {
+			int row = transform.rows[i];
+			int column = transform.columns[j];
+			unsigned char value = inverse[grid.cells[i*9 + j]];
+			if (transform.transposed) out.cells[column*9 + row] = value;
+			else out.cells[row*9 + column] = value;
+		}
+	}
+
+	return out;
+}
+
+std::string hash_to_string (PuzzleHash hash)
+{
+	char text[33];
+	snprintf(text, sizeof(text), "%016llx%016llx",
+		(unsigned long long) hash.high, (unsigned long long) hash.low);
+	return std::string(text);
+}
+
+bool hash_from_string (const std::string& text, PuzzleHash& hash)
+{
+	if (text.size() != 32) return false;
+
+	uint64_t parts[2] = {0, 0};
+	int i;
+	for (i=0; i<32; i++) {
+		char c = text[i];
+		int nibble;
+		if (c >= '0' && c <= '9') nibble = c - '0';
+		else if (c >= 'a' && c <= 'f') nibble = c - 'a' + 10;
+		else if (c >= 'A' && c <= 'F') nibble = c - 'A' + 10;
+		else return false;
+		parts[i/16] = (parts[i/16] << 4) | nibble;
+	}
+
+	hash.high = parts[0];
+	hash.low = parts[1];
+	return true;
+}
@@ -0,0 +1,294 @@
+/* Last Modified: 10/19/26
+ * Author: Alex Eastman
+ * Contact: alexeast@buffalo.edu
+ * Summary: Definitions for function prototypes found in collection.h . See
+ *          collection.h for explanation of functions
+ */
+
+
+#include "collection.h"
+#include "trace.h"
+#include <algorithm>
+#include <fstream>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace {
+
+// The value of a cell character, 0 for empty, or -1 if c is not a cell
+inline int cell_value (char c)
+{
+	if (c >= '1' && c <= '9') return c - '0';
+	if (c == '0' || c == '.') return 0;
+	return -1;
+}
+
+// Whether the next 81 characters are all cells
+bool valid_line (const char* text)
+{
+	int i;
+	for (i=0; i<81; i++) {
+		if (cell_value(text[i]) < 0) return false;
+	}
+	return true;
+}
+
+/* Reads the next 81 cells of a grid starting at text, skipping anything that
+ * is not a cell and lines starting with '#'. Returns the offset just past the
+ * last cell, or 0 if the text ends first.
+ */
+size_t read_grid (const char* text, size_t length, Grid* grid)
+{
+	int cells = 0;
+	bool line_start = true;
+
+	size_t i;
+	for (i=0; i<length; i++) {
+		char c = text[i];
+
+		if (line_start && c == '#') {
+			const char* end = (const char*) memchr(text + i, '\n', length - i);
+			if (end == nullptr) return 0;
+			i = end - text;
+			continue;
+		}
+		line_start = (c == '\n');
+
+		int value = cell_value(c);
+		if (value < 0) continue;
+		if (grid) grid -> cells[cells] = value;
+		if (++cells == 81) return i + 1;
+	}
+
+	return 0;
+}
+
+}
+
+Collection::Collection (void)
+{
+	data = nullptr;
+	length = 0;
+	format = FORMAT_UNKNOWN;
+}
+
+Collection::~Collection (void)
+{
+	close();
+}
+
+bool Collection::open (const std::string& path)
+{
+	TRACE_SCOPE("Collection::open");
+
+	if (!map(path)) return false;
+
+	// Indexing reads the file front to back
+	if (data) madvise((void*) data, length, MADV_SEQUENTIAL);
+
+	if (format == FORMAT_SDK) index_grids();
+	else index_lines();
+
+	TRACE_COUNTER("collection puzzles", offsets.size());
+	return true;
+}
+
+bool Collection::map (const std::string& path)
+{
+	close();
+
+	int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0) return false;
+
+	struct stat info;
+	if (fstat(fd, &info) != 0) {
+		::close(fd);
+		return false;
+	}
+
+	length = info.st_size;
+	if (length > 0) {
+		void* mapped = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (mapped == MAP_FAILED) {
+			::close(fd);
+			length = 0;
+			return false;
+		}
+		data = (const char*) mapped;
+	}
+	::close(fd);  // The mapping stays valid without it
+
+	format = format_from_path(path);
+	if (format == FORMAT_UNKNOWN) {
+		// One puzzle per line if the first line that is not a comment is long enough
+		size_t start = 0;
+		while (start < length && (data[start] == '#' || data[start] == '\n' || data[start] == '\r')) {
+			const char* end = (const char*) memchr(data + start, '\n', length - start);
+			start = end ? end - data + 1 : length;
+		}
+		const char* end = start < length ? (const char*) memchr(data + start, '\n', length - start) : nullptr;
+		size_t line_length = (end ? end - data : length) - start;
+		format = line_length >= 81 ? FORMAT_LINE : FORMAT_SDK;
+	}
+
+	return true;
+}
+
+void Collection::close (void)
+{
+	if (data) munmap((void*) data, length);
+	data = nullptr;
+	length = 0;
+	format = FORMAT_UNKNOWN;
+	offsets.clear();
+	return;
+}
+
+void Collection::index_lines (void)
+{
+	size_t start = 0;
+	while (start < length) {
+		const char* line = data + start;
+		const char* end = (const char*) memchr(line, '\n', length - start);
+		size_t line_length = end ? end - line : length - start;
+
+		// Anything after the 81 cells, eg. a rating, is ignored
+		if (line_length >= 81 && valid_line(line)) offsets.push_back(start);
+		start += line_length + 1;
+	}
+
+	return;
+}
+
+void Collection::index_grids (void)
+{
+	size_t start = 0;
+	while (start < length) {
+		// The puzzle starts at its first cell, after any comments
+		size_t first = start;
+		while (first < length && cell_value(data[first]) < 0) {
+			if (data[first] == '#') {
+				const char* end = (const char*) memchr(data + first, '\n', length - first);
+				first = end ? end - data : length;
+			}
+			first++;
+		}
+		if (first >= length) break;
+
+		size_t read = read_grid(data + first, length - first, nullptr);
+		if (read == 0) break;
+
+		offsets.push_back(first);
+		start = first + read;
+	}
+
+	return;
+}
+
+int Collection::size (void)
+{
+	return offsets.size();
+}
+
+int Collection::get_format (void)
+{
+	return format;
+}
+
+bool Collection::puzzle (int index, Grid& grid)
+{
+	if (index < 0 || index >= (int) offsets.size()) return false;
+	return puzzle_at(offsets[index], grid);
+}
+
+size_t Collection::offset (int index)
+{
+	return offsets.at(index);
+}
+
+bool Collection::puzzle_at (size_t start, Grid& grid)
+{
+	if (format != FORMAT_SDK) {
+		if (start + 81 > length || !valid_line(data + start)) return false;
+
+		int i;
+		for (i=0; i<81; i++) grid.cells[i] = cell_value(data[start + i]);
+		return true;
+	}
+
+	if (start >= length) return false;
+	return read_grid(data + start, length - start, &grid) != 0;
+}
+
+bool read_puzzles (const std::vector<std::string>& paths, std::vector<Grid>& puzzles)
+{
+	Collection collection;
+	bool all_read = true;
+
+	for (const std::string& path : paths) {
+		if (!collection.open(path)) {
+			all_read = false;
+			continue;
+		}
+
+		Grid puzzle;
+		int i;
+		for (i=0; i<collection.size(); i++) {
+			if (collection.puzzle(i, puzzle)) puzzles.push_back(puzzle);
+		}
+	}
+
+	return all_read;
+}
+
+int format_from_path (const std::string& path)
+{
+	size_t dot = path.rfind('.');
+	if (dot == std::string::npos) return FORMAT_UNKNOWN;
+
+	std::string extension = path.substr(dot + 1);
+	if (extension == "sdk") return FORMAT_SDK;
+	if (extension == "sdm") return FORMAT_SDM;
+	if (extension == "txt") return FORMAT_LINE;
+	return FORMAT_UNKNOWN;
+}
+
+std::string puzzle_text (const Grid& puzzle, int format)
+{
+	std::string text = grid_to_string(puzzle);
+
+	if (format == FORMAT_SDM) {
+		std::replace(text.begin(), text.end(), '.', '0');
+		return text + "\n";
+	}
+
+	if (format != FORMAT_SDK) return text + "\n";
+
+	// Nine rows of nine
+	std::string grid;
+	int i;
+	for (i=0; i<9; i++) grid += text.substr(i * 9, 9) + "\n";
+	return grid;
+}
+
+bool write_puzzles (const std::string& path, const std::vector<Grid>& puzzles, int format,
+  bool append)
+{
+	// Grids appended to an .sdk file need a blank line before them
+	struct stat info;
+	bool after_grid = append && stat(path.c_str(), &info) == 0 && info.st_size > 0;
+
+	std::ofstream file(path, append ? std::ios::app : std::ios::trunc);
+	if (!file) return false;
+
+	size_t i;
+	for (i=0; i<puzzles.size(); i++) {
+		if (format == FORMAT_SDK && (i > 0 || after_grid)) file << "\n";
+		file << puzzle_text(puzzles[i], format);
+	}
+
+	return file.good();
+}
@@ -0,0 +1,247 @@
+/* Last Modified: 10/19/26
+ * Author: Alex Eastman
+ * Contact: alexeast@buffalo.edu
+ * Summary: Definitions for function prototypes found in generator.h . See
+ *          generator.h for explanation of functions
+ */
+
+
+#include "generator.h"
+#include "solver.h"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+
+namespace {
+
+int thread_count (int threads)
+{
+	if (threads <= 0) threads = std::thread::hardware_concurrency();
+	if (threads <= 0) threads = 1;
+	return threads;
+}
+
+/* Runs task(i) for every i below count on up to threads threads, this one
+ * included. Returns once every task has finished.
+ */
+template <class Task>
+void run_parallel (int count, int threads, const Task& task)
+{
+	std::atomic<int> next(0);
+	auto worker = [&]() {
+		int i;
+		while ((i = next.fetch_add(1)) < count) task(i);
+	};
+
+	std::vector<std::thread> workers;
+	int i;
+	for (i=1; i<std::min(threads, count); i++) workers.push_back(std::thread(worker));
+	worker();
+	for (auto& t : workers) t.join();
+
+	return;
+}
+
+// Fisher-Yates shuffle
+template <class T>
+void shuffle (std::vector<T>& items, Random& random)
+{
+	int i;
+	for (i=(int) items.size() - 1; i>0; i--) {
+		std::swap(items[i], items[random.below(i + 1)]);
+	}
+	return;
+}
+
+/* Fills cells from cell onward, trying digits in random order. Returns true
+ * once the grid is full.
+ */
+bool fill (Grid& grid, unsigned short* rows, unsigned short* columns, unsigned short* blocks,
+  int cell, Random& random)
+{
+	if (cell == 81) return true;
+
+	int row = cell / 9;
+	int column = cell % 9;
+	int block = (row / 3) * 3 + column / 3;
+	unsigned short used = rows[row] | columns[column] | blocks[block];
+
+	std::vector<int> digits;
+	int digit;
+	for (digit=1; digit<=9; digit++) {
+		if (!(used & (1 << (digit - 1)))) digits.push_back(digit);
+	}
+	shuffle(digits, random);
+
+	for (int d : digits) {
+		unsigned short bit = 1 << (d - 1);
+		rows[row] |= bit;
+		columns[column] |= bit;
+		blocks[block] |= bit;
+		grid.cells[cell] = d;
+
+		if (fill(grid, rows, columns, blocks, cell + 1, random)) return true;
+
+		rows[row] &= ~bit;
+		columns[column] &= ~bit;
+		blocks[block] &= ~bit;
+	}
+
+	grid.cells[cell] = 0;
+	return false;
+}
+
+/* Removes orbits of clues from solution for as long as the solution stays
+ * unique. Each round checks the next few orbits in parallel and removes the
+ * first one that can go. Orbits checked before it are needed for good: taking
+ * away more clues can only add solutions. Checks after it are cancelled since
+ * they have to be redone against the smaller puzzle. The result is the same
+ * as checking one orbit at a time, so it does not depend on threads. Orbits
+ * that are already empty are skipped, so it can thin out a puzzle too.
+ */
+Grid remove_clues (const Grid& solution, int symmetry, int threads, Random& random)
+{
+	Grid puzzle = solution;
+	std::vector< std::vector<int>> pending;
+	for (const std::vector<int>& orbit : symmetry_orbits(symmetry)) {
+		for (int cell : orbit) {
+			if (puzzle.cells[cell] != 0) {
+				pending.push_back(orbit);
+				break;
+			}
+		}
+	}
+	shuffle(pending, random);
+
+	while (!pending.empty()) {
+		int batch = std::min((int) pending.size(), threads);
+		std::vector<char> removable(batch, 0);
+		std::unique_ptr< std::atomic<bool>[]> cancel(new std::atomic<bool>[batch]);
+
+		int i;
+		for (i=0; i<batch; i++) cancel[i] = false;
+
+		run_parallel(batch, threads, [&](int task) {
+			Grid trial = puzzle;
+			for (int cell : pending[task]) trial.cells[cell] = 0;
+
+			int found = count_solutions(trial, 2, nullptr, &cancel[task]);
+			if (cancel[task] || found != 1) return;
+
+			removable[task] = 1;
+			int later;
+			for (later=task+1; later<batch; later++) cancel[later] = true;
+		});
+
+		int chosen = -1;
+		for (i=0; i<batch; i++) {
+			if (removable[i]) {
+				chosen = i;
+				break;
+			}
+		}
+
+		if (chosen == -1) {  // Every orbit in the batch is needed
+			pending.erase(pending.begin(), pending.begin() + batch);
+		} else {
+			for (int cell : pending[chosen]) puzzle.cells[cell] = 0;
+			pending.erase(pending.begin(), pending.begin() + chosen + 1);
+		}
+	}
+
+	return puzzle;
+}
+
+}
+
+std::vector< std::vector<int>> symmetry_orbits (int symmetry)
+{
+	std::vector< std::vector<int>> orbits;
+	bool seen[81] = {false};
+
+	int cell;
+	for (cell=0; cell<81; cell++) {
+		if (seen[cell]) continue;
+
+		int row = cell / 9;
+		int column = cell % 9;
+		int image;
+		switch (symmetry) {
+			case SYMMETRY_ROTATIONAL: image = 80 - cell; break;
+			case SYMMETRY_DIAGONAL: image = column * 9 + row; break;
+			case SYMMETRY_MIRROR: image = row * 9 + (8 - column); break;
+			default: image = cell; break;
+		}
+
+		std::vector<int> orbit = {cell};
+		if (image != cell) orbit.push_back(image);
+
+		seen[cell] = true;
+		seen[image] = true;
+		orbits.push_back(orbit);
+	}
+
+	return orbits;
+}
+
+void random_solution (Grid& solution, Random& random)
+{
+	unsigned short rows[9] = {0};
+	unsigned short columns[9] = {0};
+	unsigned short blocks[9] = {0};
+
+	solution = empty_grid();
+	fill(solution, rows, columns, blocks, 0, random);
+	return;
+}
+
+bool is_minimal (const Grid& puzzle, int threads)
+{
+	std::vector<int> clues;
+	int i;
+	for (i=0; i<81; i++) {
+		if (puzzle.cells[i] != 0) clues.push_back(i);
+	}
+
+	// Set by whichever check first finds a clue that is not needed
+	std::atomic<bool> spare(false);
+
+	run_parallel((int) clues.size(), thread_count(threads), [&](int task) {
+		if (spare) return;
+
+		Grid trial = puzzle;
+		trial.cells[clues[task]] = 0;
+
+		int found = count_solutions(trial, 2, nullptr, &spare);
+		if (!spare && found == 1) spare = true;
+	});
+
+	return !spare;
+}
+
+Grid generate_puzzle (int symmetry, int threads, Grid* solution, Random& random)
+{
+	threads = thread_count(threads);
+
+	Grid full;
+	Grid puzzle;
+	bool minimal = false;
+	int attempt;
+	for (attempt=0; attempt<GENERATE_ATTEMPTS && !minimal; attempt++) {
+		random_solution(full, random);
+		puzzle = remove_clues(full, symmetry, threads, random);
+
+		// Without symmetry every clue left failed to come out on its own,
+		// so the puzzle is already minimal
+		minimal = symmetry == SYMMETRY_NONE || is_minimal(puzzle, threads);
+	}
+
+	// The symmetry gives way before minimality does
+	if (!minimal) {
+		puzzle = remove_clues(puzzle, SYMMETRY_NONE, threads, random);
+	}
+
+	if (solution != nullptr) *solution = full;
+	return puzzle;
+}
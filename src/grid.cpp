@@ -0,0 +1,231 @@
+/* Last Modified: 10/19/26
+ * Author: Alex Eastman
+ * Contact: alexeast@buffalo.edu
+ * Summary: Definitions for function prototypes found in grid.h . See grid.h
+ *          for explanation of functions
+ */
+
+
+#include "grid.h"
+#include <string.h>
+#include <ctype.h>
+#include <type_traits>
+
+// Snapshots of a board are plain copies, see BoardState
+static_assert(std::is_trivially_copyable<BoardState>::value, "BoardState must stay trivially copyable");
+
+UnitTables::UnitTables (void)
+{
+	int cell, i;
+	for (cell=0; cell<81; cell++) {
+		int row = cell / 9;
+		int col = cell % 9;
+		int block = (row / 3) * 3 + col / 3;
+		int position = (row % 3) * 3 + col % 3;
+
+		units[row][col] = cell;
+		units[9 + col][row] = cell;
+		units[18 + block][position] = cell;
+
+		units_of[cell][0] = row;
+		units_of[cell][1] = 9 + col;
+		units_of[cell][2] = 18 + block;
+	}
+
+	for (cell=0; cell<81; cell++) {
+		int count = 0;
+		for (i=0; i<81; i++) {
+			if (i == cell) continue;
+
+			bool same_row = units_of[i][0] == units_of[cell][0];
+			bool same_col = units_of[i][1] == units_of[cell][1];
+			bool same_block = units_of[i][2] == units_of[cell][2];
+			if (same_row || same_col || same_block) peers[cell][count++] = i;
+		}
+	}
+}
+
+const UnitTables& unit_tables (void)
+{
+	static const UnitTables tables;
+	return tables;
+}
+
+Grid empty_grid (void)
+{
+	Grid grid;
+	memset(grid.cells, 0, sizeof(grid.cells));
+	return grid;
+}
+
+BoardState empty_state (void)
+{
+	BoardState state;
+	state.numbers = empty_grid();
+	memset(state.marks, 0, sizeof(state.marks));
+	return state;
+}
+
+int count_givens (const Grid& grid)
+{
+	int givens = 0;
+
+	int i;
+	for (i=0; i<81; i++) {
+		if (grid.cells[i] != 0) givens++;
+	}
+
+	return givens;
+}
+
+bool grid_from_string (const std::string& line, Grid& grid)
+{
+	if (line.size() < 81) return false;
+
+	int i;
+	for (i=0; i<81; i++) {
+		char c = line[i];
+		if (c >= '1' && c <= '9') grid.cells[i] = c - '0';
+		else if (c == '0' || c == '.') grid.cells[i] = 0;
+		else return false;
+	}
+
+	return true;
+}
+
+std::string grid_to_string (const Grid& grid)
+{
+	std::string line(81, '.');
+
+	int i;
+	for (i=0; i<81; i++) {
+		if (grid.cells[i] != 0) line[i] = grid.cells[i] + '0';
+	}
+
+	return line;
+}
+
+bool large_grid_from_string (const std::string& line, LargeGrid& grid)
+{
+	int order;
+	for (order=MIN_ORDER; order<=MAX_ORDER; order++) {
+		if ((int) line.size() == order * order * order * order) break;
+	}
+	if (order > MAX_ORDER) return false;
+
+	int size = order * order;
+	grid.order = order;
+	grid.cells.assign(size * size, 0);
+
+	int i;
+	for (i=0; i<size*size; i++) {
+		char c = toupper(line[i]);
+		int value;
+		if (c == '0' || c == '.') value = 0;
+		else if (c >= '1' && c <= '9') value = c - '0';
+		else if (c >= 'A' && c <= 'Z') value = c - 'A' + 10;
+		else return false;
+
+		if (value > size) return false;
+		grid.cells[i] = value;
+	}
+
+	return true;
+}
+
+std::string large_grid_to_string (const LargeGrid& grid)
+{
+	std::string line(grid.cells.size(), '.');
+
+	int i;
+	for (i=0; i<(int) grid.cells.size(); i++) {
+		int value = grid.cells[i];
+		if (value >= 10) line[i] = 'A' + value - 10;
+		else if (value != 0) line[i] = '0' + value;
+	}
+
+	return line;
+}
+
+bool grid_equal (const Grid& a, const Grid& b)
+{
+	return memcmp(a.cells, b.cells, sizeof(a.cells)) == 0;
+}
+
+bool in_cell_set (const CellSet& set, int cell)
+{
+	return cell < 64 ? (set.low >> cell) & 1 : (set.high >> (cell - 64)) & 1;
+}
+
+PackedGrid pack_grid (const Grid& grid)
+{
+	PackedGrid packed = {{0}};
+
+	int i;
+	for (i=0; i<81; i++) packed.words[i / 16] |= (uint64_t) (grid.cells[i] & 0xf) << (i % 16 * 4);
+	return packed;
+}
+
+Grid unpack_grid (const PackedGrid& packed)
+{
+	Grid grid;
+
+	int i;
+	for (i=0; i<81; i++) grid.cells[i] = packed_cell(packed, i);
+	return grid;
+}
+
+int packed_cell (const PackedGrid& packed, int cell)
+{
+	return (packed.words[cell / 16] >> (cell % 16 * 4)) & 0xf;
+}
+
+namespace {
+
+// The low bit of every four
+const uint64_t nibble_low = 0x1111111111111111ull;
+
+// Turns a mask with the low bit of each four set into a set of cells
+void add_cells (CellSet& set, int word, uint64_t mask)
+{
+	while (mask != 0) {
+		int cell = word * 16 + __builtin_ctzll(mask) / 4;
+		if (cell < 64) set.low |= (uint64_t) 1 << cell;
+		else set.high |= (uint64_t) 1 << (cell - 64);
+		mask &= mask - 1;
+	}
+	return;
+}
+
+// Sets the low bit of each four that has any bit set
+uint64_t nonzero_nibbles (uint64_t word)
+{
+	return (word | word >> 1 | word >> 2 | word >> 3) & nibble_low;
+}
+
+}
+
+CellSet wrong_cells (const PackedGrid& entries, const PackedGrid& solution)
+{
+	CellSet wrong = {0, 0};
+
+	int i;
+	for (i=0; i<6; i++) {
+		uint64_t differ = nonzero_nibbles(entries.words[i] ^ solution.words[i]);
+		add_cells(wrong, i, differ & nonzero_nibbles(entries.words[i]));
+	}
+	return wrong;
+}
+
+CellSet empty_cells (const PackedGrid& packed)
+{
+	CellSet empty = {0, 0};
+
+	int i;
+	for (i=0; i<6; i++) {
+		uint64_t zero = ~nonzero_nibbles(packed.words[i]) & nibble_low;
+		if (i == 5) zero &= 0xf;  // Only cell 80, the rest is padding
+		add_cells(empty, i, zero);
+	}
+	return empty;
+}
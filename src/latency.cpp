@@ -0,0 +1,108 @@
+/* Last Modified: 10/19/26
+ * Author: Alex Eastman
+ * Contact: alexeast@buffalo.edu
+ * Summary: Definitions for function prototypes found in latency.h . See
+ *          latency.h for explanation of functions
+ */
+
+
+#include "latency.h"
+#include <algorithm>
+#include <stdio.h>
+#include <vector>
+
+namespace {
+
+/* Upper bound of each bucket in microseconds. The 16ms and 33ms bounds are
+ * one and two frames at 60Hz. The last bucket takes everything slower.
+ */
+const long latency_bucket_limits[LATENCY_BUCKETS] = {
+	1000, 2000, 4000, 8000, 16700, 33300, 50000, 100000, 250000, -1
+};
+
+std::string milliseconds (long micros)
+{
+	char text[32];
+	snprintf(text, sizeof(text), "%.1fms", micros / 1000.0);
+	return text;
+}
+
+}
+
+LatencyHistogram::LatencyHistogram (void)
+{
+	next = 0;
+	filled = 0;
+	total = 0;
+}
+
+void LatencyHistogram::record (long micros)
+{
+	samples[next] = micros;
+	next = (next + 1) % LATENCY_WINDOW;
+	if (filled < LATENCY_WINDOW) filled++;
+	total++;
+	return;
+}
+
+int LatencyHistogram::size (void)
+{
+	return filled;
+}
+
+long LatencyHistogram::percentile (double fraction)
+{
+	if (filled == 0) return 0;
+
+	std::vector<long> sorted(samples, samples + filled);
+	int index = std::min(filled - 1, (int) (fraction * filled));
+	std::nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+	return sorted[index];
+}
+
+void LatencyHistogram::buckets (int* counts)
+{
+	int i, j;
+	for (j=0; j<LATENCY_BUCKETS; j++) counts[j] = 0;
+
+	for (i=0; i<filled; i++) {
+		for (j=0; j<LATENCY_BUCKETS - 1; j++) {
+			if (samples[i] <= latency_bucket_limits[j]) break;
+		}
+		counts[j]++;
+	}
+
+	return;
+}
+
+std::string LatencyHistogram::summary (void)
+{
+	if (filled == 0) return "No keypresses yet";
+
+	return std::to_string(filled) + " keys  p50 " + milliseconds(percentile(0.5)) +
+	  "  p95 " + milliseconds(percentile(0.95)) + "  p99 " + milliseconds(percentile(0.99));
+}
+
+std::string LatencyHistogram::report (void)
+{
+	std::string text = "Keypress to paint latency, last " + std::to_string(filled) + " of " +
+	  std::to_string(total) + " keys\n" + summary() + "\n";
+	if (filled == 0) return text;
+
+	int counts[LATENCY_BUCKETS];
+	buckets(counts);
+
+	int j;
+	for (j=0; j<LATENCY_BUCKETS; j++) {
+		char line[64];
+		if (j < LATENCY_BUCKETS - 1) {
+			snprintf(line, sizeof(line), "  <= %7.1fms %5d ", latency_bucket_limits[j] / 1000.0, counts[j]);
+		} else {
+			snprintf(line, sizeof(line), "   > %7.1fms %5d ", latency_bucket_limits[j - 1] / 1000.0,
+			  counts[j]);
+		}
+		text += line + std::string(counts[j] * 40 / filled, '#') + "\n";
+	}
+
+	return text;
+}
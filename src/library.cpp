@@ -0,0 +1,269 @@
+/* Last Modified: 10/19/26
+ * Author: Alex Eastman
+ * Contact: alexeast@buffalo.edu
+ * Summary: Definitions for function prototypes found in library.h . See
+ *          library.h for explanation of functions
+ */
+
+
+#include "library.h"
+#include "rater.h"
+#include "trace.h"
+#include <algorithm>
+#include <fstream>
+#include <numeric>
+#include <vector>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/* The index file starts with this header, followed by one LibraryEntry per
+ * puzzle, the puzzle numbers grouped by difficulty, and the puzzle numbers
+ * sorted by hash. The source fields tell when the collection has changed.
+ */
+struct LibraryHeader {
+	char magic[8];
+	uint64_t source_size;
+	int64_t source_time;
+	uint32_t count;
+	uint32_t bucket_start[LIBRARY_BUCKETS + 1];  // Into by_difficulty
+};
+
+struct LibraryEntry {
+	uint64_t offset;
+	PuzzleHash hash;
+	int32_t difficulty;
+	int32_t score;
+};
+
+namespace {
+
+const char library_magic[8] = {'S', 'U', 'D', 'O', 'K', 'U', 'X', '1'};
+
+// Entries follow the header, so it has to keep them aligned
+static_assert(sizeof(LibraryHeader) % alignof(LibraryEntry) == 0, "misaligned library entries");
+
+// Puzzles rated at a time while building, so a huge collection is never all in memory
+const int library_chunk = 65536;
+
+int bucket_of (int difficulty)
+{
+	if (difficulty < UNRATED || difficulty >= LIBRARY_BUCKETS - 1) return 0;
+	return difficulty + 1;
+}
+
+}
+
+Library::Library (void)
+{
+	index = nullptr;
+	index_length = 0;
+	header = nullptr;
+	entries = nullptr;
+	by_difficulty = nullptr;
+	by_hash = nullptr;
+}
+
+Library::~Library (void)
+{
+	close();
+}
+
+bool Library::open (const std::string& path, bool build)
+{
+	TRACE_SCOPE("Library::open");
+
+	close();
+
+	if (!map_index(path)) {
+		if (!build || !build_library_index(path, 0, nullptr, nullptr) || !map_index(path)) return false;
+	}
+
+	if (!collection.map(path)) {
+		close();
+		return false;
+	}
+
+	return true;
+}
+
+bool Library::map_index (const std::string& path)
+{
+	struct stat source;
+	if (stat(path.c_str(), &source) != 0) return false;
+
+	int fd = ::open((path + LIBRARY_EXTENSION).c_str(), O_RDONLY);
+	if (fd < 0) return false;
+
+	struct stat info;
+	if (fstat(fd, &info) != 0 || (size_t) info.st_size < sizeof(LibraryHeader)) {
+		::close(fd);
+		return false;
+	}
+
+	void* mapped = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);
+	if (mapped == MAP_FAILED) return false;
+
+	index = (const char*) mapped;
+	index_length = info.st_size;
+	header = (const LibraryHeader*) index;
+
+	// Made from this version of the collection, and as long as it says it is
+	size_t count = header -> count;
+	size_t expected = sizeof(LibraryHeader) + count * (sizeof(LibraryEntry) + 2 * sizeof(uint32_t));
+	if (memcmp(header -> magic, library_magic, sizeof(library_magic)) != 0 ||
+	  header -> source_size != (uint64_t) source.st_size || header -> source_time != source.st_mtime ||
+	  index_length != expected) {
+		close();
+		return false;
+	}
+
+	entries = (const LibraryEntry*) (index + sizeof(LibraryHeader));
+	by_difficulty = (const uint32_t*) (entries + count);
+	by_hash = by_difficulty + count;
+	return true;
+}
+
+void Library::close (void)
+{
+	if (index) munmap((void*) index, index_length);
+	index = nullptr;
+	index_length = 0;
+	header = nullptr;
+	entries = nullptr;
+	by_difficulty = nullptr;
+	by_hash = nullptr;
+	collection.close();
+	return;
+}
+
+int Library::size (void)
+{
+	return header ? header -> count : 0;
+}
+
+bool Library::puzzle (int number, Grid& grid)
+{
+	if (number < 0 || number >= size()) return false;
+	return collection.puzzle_at(entries[number].offset, grid);
+}
+
+int Library::difficulty (int number)
+{
+	if (number < 0 || number >= size()) return UNRATED;
+	return entries[number].difficulty;
+}
+
+int Library::score (int number)
+{
+	if (number < 0 || number >= size()) return 0;
+	return entries[number].score;
+}
+
+int Library::count_with (int difficulty)
+{
+	if (!header) return 0;
+
+	int bucket = bucket_of(difficulty);
+	return header -> bucket_start[bucket + 1] - header -> bucket_start[bucket];
+}
+
+int Library::nth_with (int difficulty, int n)
+{
+	if (n < 0 || n >= count_with(difficulty)) return -1;
+	return by_difficulty[header -> bucket_start[bucket_of(difficulty)] + n];
+}
+
+int Library::find (const PuzzleHash& hash)
+{
+	// Binary search for the first puzzle number whose hash is not less
+	const uint32_t* found = std::lower_bound(by_hash, by_hash + size(), hash,
+	  [this](uint32_t number, const PuzzleHash& wanted) { return entries[number].hash < wanted; });
+
+	if (found == by_hash + size() || entries[*found].hash != hash) return -1;
+	return *found;
+}
+
+bool build_library_index (const std::string& path, int threads, AnalysisCache* cache,
+  const std::atomic<bool>* cancel)
+{
+	TRACE_SCOPE("build_library_index");
+
+	struct stat source;
+	Collection collection;
+	if (stat(path.c_str(), &source) != 0 || !collection.open(path)) return false;
+
+	int count = collection.size();
+	std::vector<LibraryEntry> entries(count);
+
+	int start, i;
+	for (start=0; start<count; start+=library_chunk) {
+		int end = std::min(count, start + library_chunk);
+
+		std::vector<Grid> puzzles(end - start);
+		for (i=start; i<end; i++) collection.puzzle(i, puzzles[i - start]);
+
+		std::vector<Rating> ratings = rate_batch(puzzles, threads, cache, cancel);
+		for (i=start; i<end; i++) {
+			// Hashing a chunk takes long too, so this is checked for each puzzle
+			if (cancel != nullptr && cancel -> load()) return false;
+
+			LibraryEntry& entry = entries[i];
+			entry.offset = collection.offset(i);
+			entry.hash = canonical_hash(puzzles[i - start]);
+			entry.difficulty = ratings[i - start].difficulty;
+			entry.score = ratings[i - start].score;
+		}
+	}
+
+	LibraryHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, library_magic, sizeof(library_magic));
+	header.source_size = source.st_size;
+	header.source_time = source.st_mtime;
+	header.count = count;
+
+	// Counting sort, so each difficulty keeps file order
+	std::vector<uint32_t> by_difficulty(count);
+	for (i=0; i<count; i++) header.bucket_start[bucket_of(entries[i].difficulty) + 1]++;
+	for (i=0; i<LIBRARY_BUCKETS; i++) header.bucket_start[i + 1] += header.bucket_start[i];
+
+	uint32_t next[LIBRARY_BUCKETS];
+	std::copy(header.bucket_start, header.bucket_start + LIBRARY_BUCKETS, next);
+	for (i=0; i<count; i++) by_difficulty[next[bucket_of(entries[i].difficulty)]++] = i;
+
+	std::vector<uint32_t> by_hash(count);
+	std::iota(by_hash.begin(), by_hash.end(), 0);
+	std::stable_sort(by_hash.begin(), by_hash.end(),
+	  [&entries](uint32_t a, uint32_t b) { return entries[a].hash < entries[b].hash; });
+
+	// Written beside the old index and swapped in, so a reader never sees half of one
+	std::string index_path = path + LIBRARY_EXTENSION;
+	std::string temporary = index_path + ".tmp";
+	{
+		std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+		if (!file) return false;
+
+		file.write((const char*) &header, sizeof(header));
+		file.write((const char*) entries.data(), entries.size() * sizeof(LibraryEntry));
+		file.write((const char*) by_difficulty.data(), by_difficulty.size() * sizeof(uint32_t));
+		file.write((const char*) by_hash.data(), by_hash.size() * sizeof(uint32_t));
+		file.close();
+
+		// No half written index is left behind
+		if (!file.good() || (cancel != nullptr && cancel -> load())) {
+			unlink(temporary.c_str());
+			return false;
+		}
+	}
+
+	if (rename(temporary.c_str(), index_path.c_str()) != 0) {
+		unlink(temporary.c_str());
+		return false;
+	}
+	return true;
+}
@@ -1,5 +1,5 @@
 /*
-* Last Modified: 01/30/21
+* Last Modified: 10/19/26
 * Author: Alex Eastman
 * Contact: alexeast@buffalo.edu
 * Summary: Main program file for Sudoku
@@ -9,13 +9,25 @@
 
 #include <gtkmm.h>
 #include <iostream>
+#include <algorithm>
+#include <map>
+#include <thread>
 #include <time.h>
 #include <string.h>
+#include <stdlib.h>
 
 /*
 *  User-defined headers
 */
 #include "board.h"
+#include "board_view.h"
+#include "session.h"
+#include "trace.h"
+#include "latency.h"
+#include "paths.h"
+#include "library.h"
+#include "saver.h"
+#include "race.h"
 
 
 // Function prototypes
@@ -30,26 +42,56 @@ void quit_wrapper (Gtk::Window*);
 void open_instructions ();
 void close_instructions ();
 
+void open_collection (const std::string&);
+void on_library_indexed ();
+void open_library ();
+void on_library_filter_changed ();
+void show_library_puzzle ();
+void random_library_puzzle ();
+void play_library_puzzle ();
+
 void initialize_board ();
 void populate_board ();
 
 void reset_all ();
 void reset_board ();
-void reset_reserved ();
 
 void set_pointer (Glib::ustring);
 void restore_pointer (Glib::ustring);
 
-bool check_if_number (char, Glib::RefPtr< Gtk::EntryBuffer >);
-void insert_to_board (char, int, int);
-
-void on_inserted (guint, const char*, guint, Glib::RefPtr< Gtk::EntryBuffer >, int, int);
-void on_removed (guint, guint, int, int);
+void set_cell (int, int, int);
+void on_cell_changed (int, int, int);
+void on_mark_toggled (int, int, int);
+void on_board_pasted (const Grid&);
+Action cell_state (int, int);
+void restore_state (const Action&);
+
+void branch_board ();
+void keep_branch ();
+void discard_branch ();
+void update_branch_buttons ();
+void check_progress ();
+void reveal_cell ();
+
+void join_race (const Glib::ustring&);
+bool on_race_input (Glib::IOCondition);
+void prepare_race ();
+void on_race_prepared ();
+void start_race ();
+void report_race_progress ();
+void update_race_label ();
+
+bool on_key_pressed (GdkEventKey*);
+void on_after_paint (GdkFrameClock*, gpointer);
+void watch_frames (Gtk::Window*);
+void on_first_paint (GdkFrameClock*, gpointer);
+void time_startup (Gtk::Window*);
 
 void check_win ();
 
 void open_sorry ();
 void close_sorry ();
+void give_hint ();
 
 void open_congratulations ();
 void close_congratulations ();
@@ -57,6 +99,7 @@ void close_congratulations ();
 bool timeout_handler ();
 
 void handle_user ();
+Game* open_session ();
 
 void update_main_menu ();
 void switch_stack_page (Glib::ustring);
@@ -64,56 +107,411 @@ void hide_dialog (Glib::ustring);
 
 void undo ();
 void redo ();
-gboolean grab_old (GdkEventButton*, std::string);
+
+void schedule_autosave ();
+bool autosave_game ();
+void flush_autosave ();
 
 void build_toolbar ();
 
+void startup_phase (const char*, long);
+bool build_once (const char*, Glib::ustring);
+Gtk::Grid* game_board_page ();
+Gtk::Dialog* get_dialog (Glib::ustring);
+
 // Global references
 Glib::RefPtr<Gtk::Builder> builder;
-Board board;
+BoardView* board_view = nullptr;  // Created with the game board page
+
+// Every player's game stays open while others play, each with its own board,
+// clock and undo history. game is the one being shown.
+SessionManager sessions;
+Game* game = nullptr;
+
+// Moves are autosaved once typing pauses for autosave_delay milliseconds, or
+// autosave_max_wait after the first unsaved move if it never does. See
+// Board::autosave.
+const int autosave_delay = 1000;
+const int autosave_max_wait = 5000;
+sigc::connection autosave_timer;
+gint64 first_unsaved_move = 0;  // Monotonic time, while the timer is running
+
+// Puzzles new games are taken from, if SUDOKU_COLLECTION is set. In order,
+// unless one is picked in the library dialog.
+Library library;
+int next_puzzle = 0;
+int shown_puzzle = -1;   // Puzzle shown in the library dialog
+int chosen_puzzle = -1;  // Puzzle the next new game uses
+
+// Builds a missing library index on its own thread, so the window doesn't
+// wait for every puzzle to be rated. ready is emitted on the GTK thread once
+// the worker is done, and cancel stops it when the app quits.
+struct indexing {
+
+	std::string path;
+	std::thread worker;
+	Glib::Dispatcher* ready = nullptr;
+	std::atomic<bool> cancel{false};
+	bool built = false;  // Set by the worker before it emits ready
+
+} library_index;
+
+// Keypress to paint latency. Measured only if SUDOKU_LATENCY is set
+struct latency {
+
+	LatencyHistogram histogram;
+
+	// Monotonic time of the last digit keypress not yet inserted, and of the
+	// last inserted one still waiting for a frame to be painted. 0 for none.
+	gint64 key_time = 0;
+	gint64 paint_pending = 0;
 
-struct actions {
+	// Shows the histogram summary live if SUDOKU_LATENCY=overlay
+	bool overlay = false;
 
-	// Stores user actions. Inner vector is [widgetName, value]
-	std::stack< std::vector< std::string>> user_stack;
+} keypress_latency;
 
-	// Stores actions that were undone so they can be redone
-	std::stack< std::vector< std::string>> undone_stack;
+// Time from the start of main to the first frame, reported if SUDOKU_STARTUP is set
+struct startup {
 
-} user_actions;
+	long started = 0;  // trace_now() at the start of main
+	gulong paint_handler = 0;
+
+} startup_timing;
+
+// Head to head race, if SUDOKU_RACE=host or host:port is set. The first user
+// to enter a name joins it, and their game switches to the race puzzle when
+// the host starts the race. See race.h.
+struct racing {
+
+	RaceClient* client = nullptr;
+	Game* game = nullptr;           // The game racing
+	bool started = false;
+
+	// The race puzzle, made on maker as soon as the host names it so that
+	// starting only has to show it. made is emitted on the GTK thread once
+	// maker is done, and prepared is set there if it worked. A start that
+	// comes first waits in start_pending.
+	Grid puzzle;
+	Grid solution;
+	std::thread maker;
+	Glib::Dispatcher* made = nullptr;
+	bool made_puzzle = false;  // Set by maker before it emits made
+	bool prepared = false;
+	bool start_pending = false;
+
+	// What the label shows for each player, by name
+	std::map<std::string, std::string> standings;
+	std::string status;
+
+} race;
 
 
 /************************
 *  User-defined functions
 ************************/
 
+// Reports how long a part of startup took, if SUDOKU_STARTUP is set, and
+// traces it as a span
+void
+startup_phase (const char* phase, long started)
+{
+	if (trace_enabled()) trace_span(phase, started);
+	if (getenv("SUDOKU_STARTUP")) {
+		fprintf(stderr, "Startup: %s %.1fms\n", phase, (trace_now() - started) / 1000.0);
+	}
+
+	return;
+}
+
+// Builds object id from the UI file resource in res/ unless it was built
+// already. Returns true if it was built by this call
+bool
+build_once (const char* resource, Glib::ustring id)
+{
+	if (builder -> get_object(id)) return false;
+
+	long started = trace_now();
+	builder -> add_from_resource(std::string(RESOURCE_PREFIX) + resource, id);
+	startup_phase(resource, started);
+
+	return true;
+}
+
+// Builds the game board page the first time it is needed, so starting the app
+// only pays for the player info page and main menu
+Gtk::Grid*
+game_board_page (void)
+{
+	Gtk::Grid* board_container_grid;
+	if ( !build_once("board.glade", "board_container_grid")) {
+		builder -> get_widget ("board_container_grid", board_container_grid);
+		return board_container_grid;
+	}
+
+	Gtk::Stack* application_stack;
+	Gtk::Button* done_button;
+	Gtk::Button* reset_button;
+	Gtk::Button* finish_later_button;
+	Gtk::Button* branch_button;
+	Gtk::Button* keep_branch_button;
+	Gtk::Button* discard_branch_button;
+	Gtk::Button* check_button;
+	Gtk::Button* reveal_button;
+
+	builder -> get_widget ("board_container_grid", board_container_grid);
+	builder -> get_widget ("application_stack", application_stack);
+	builder -> get_widget ("done_button", done_button);
+	builder -> get_widget ("reset_button", reset_button);
+	builder -> get_widget ("finish_later_button", finish_later_button);
+	builder -> get_widget ("branch_button", branch_button);
+	builder -> get_widget ("keep_branch_button", keep_branch_button);
+	builder -> get_widget ("discard_branch_button", discard_branch_button);
+	builder -> get_widget ("check_button", check_button);
+	builder -> get_widget ("reveal_button", reveal_button);
+
+	application_stack -> add(*board_container_grid, "Game Board", "page0");
+	initialize_board();
+
+	// Must pause time while checking game. Dialog to resume?
+	done_button  -> signal_clicked().connect(   // Check if win on done
+	  sigc::ptr_fun(&check_win)
+	);
+	done_button  -> signal_enter().connect(  // Cursor pointer
+	  sigc::bind<Glib::ustring>( sigc::ptr_fun(&set_pointer), "done_button")
+	);
+	done_button  -> signal_leave().connect(  // Cursor normal
+	  sigc::bind<Glib::ustring>( sigc::ptr_fun(&restore_pointer), "done_button")
+	);
+
+	// Decision: Reset time or not?
+	reset_button  -> signal_clicked().connect(  // Clear all entries on reset
+	  sigc::ptr_fun(&reset_board)
+	);
+	reset_button  -> signal_leave().connect(  // Cursor normal
+	  sigc::bind<Glib::ustring>( sigc::ptr_fun(&restore_pointer), "reset_button")
+	);
+	reset_button  -> signal_enter().connect(  // Cursor clickable
+	  sigc::bind<Glib::ustring>( sigc::ptr_fun(&set_pointer), "reset_button")
+	);
+
+	finish_later_button  -> signal_leave().connect(  // Cursor normal
+	  sigc::bind<Glib::ustring>( sigc::ptr_fun(&restore_pointer), "finish_later_button")
+	);
+	finish_later_button  -> signal_enter().connect(  // Cursor clickable
+	  sigc::bind<Glib::ustring>( sigc::ptr_fun(&set_pointer), "finish_later_button")
+	);
+	finish_later_button -> signal_clicked().connect(  // Save time and return to menu
+		sigc::bind<bool>( sigc::ptr_fun(&close_game), true)
+	);
+
+	// What-if guesses, see Board::branch
+	branch_button -> signal_clicked().connect( sigc::ptr_fun(&branch_board));
+	keep_branch_button -> signal_clicked().connect( sigc::ptr_fun(&keep_branch));
+	discard_branch_button -> signal_clicked().connect( sigc::ptr_fun(&discard_branch));
+
+	// Compared with the solution stored with the puzzle, see Board::check_progress
+	check_button -> signal_clicked().connect( sigc::ptr_fun(&check_progress));
+	reveal_button -> signal_clicked().connect( sigc::ptr_fun(&reveal_cell));
+
+	if (keypress_latency.overlay) {
+		Gtk::Label* latency_label;
+		builder -> get_widget ("latency_label", latency_label);
+		latency_label -> show();
+	}
+
+	if (race.client) update_race_label();
+
+	return board_container_grid;
+}
+
+// Builds the dialog with the given name the first time it is needed and
+// connects its buttons
+Gtk::Dialog*
+get_dialog (Glib::ustring name)
+{
+	Gtk::Dialog* dialog;
+	bool built = build_once("dialogs.glade", name);
+	builder -> get_widget (name, dialog);
+	if (!built) return dialog;
+
+	if (name == "how_to_play_dialog") {
+		Gtk::Button* got_it_button;
+		builder -> get_widget ("got_it_button", got_it_button);
+
+		got_it_button  -> signal_clicked().connect(  // Close instructions
+		  sigc::ptr_fun(&close_instructions)
+		);
+		got_it_button  -> signal_enter().connect(  // Cursor pointer
+		  sigc::bind<Glib::ustring>( sigc::ptr_fun(&set_pointer), "got_it_button")
+		);
+		got_it_button  -> signal_leave().connect(  // Cursor normal
+		  sigc::bind<Glib::ustring>( sigc::ptr_fun(&restore_pointer), "got_it_button")
+		);
+
+	} else if (name == "sorry_dialog") {
+		Gtk::Button* continue_button;
+		Gtk::Button* hint_button;
+		builder -> get_widget ("continue_button", continue_button);
+		builder -> get_widget ("hint_button", hint_button);
+
+		continue_button  -> signal_leave().connect(  // Cursor normal
+		  sigc::bind<Glib::ustring>( sigc::ptr_fun(&restore_pointer), "continue_button")
+		);
+		continue_button  -> signal_enter().connect(  // Cursor clickable
+		  sigc::bind<Glib::ustring>( sigc::ptr_fun(&set_pointer), "continue_button")
+		);
+		continue_button -> signal_clicked().connect(  // Close 'almost there' dialog
+		  sigc::ptr_fun(&close_sorry)
+		);
+		continue_button -> signal_clicked().connect(  // Start time of the game shown
+		  [] () { game -> board.start(); }
+		);
+
+		hint_button  -> signal_leave().connect(  // Cursor normal
+		  sigc::bind<Glib::ustring>( sigc::ptr_fun(&restore_pointer), "hint_button")
+		);
+		hint_button  -> signal_enter().connect(  // Cursor clickable
+		  sigc::bind<Glib::ustring>( sigc::ptr_fun(&set_pointer), "hint_button")
+		);
+		hint_button -> signal_clicked().connect(  // Fill in one cell and resume
+		  sigc::ptr_fun(&give_hint)
+		);
+
+	} else if (name == "library_dialog") {
+		Gtk::ComboBoxText* difficulty_combo;
+		Gtk::SpinButton* number_spin;
+		Gtk::Button* library_random_button;
+		Gtk::Button* library_play_button;
+		Gtk::Button* library_close_button;
+		builder -> get_widget ("library_difficulty_combo", difficulty_combo);
+		builder -> get_widget ("library_number_spin", number_spin);
+		builder -> get_widget ("library_random_button", library_random_button);
+		builder -> get_widget ("library_play_button", library_play_button);
+		builder -> get_widget ("library_close_button", library_close_button);
+
+		difficulty_combo -> signal_changed().connect(  // Page through one difficulty
+		  sigc::ptr_fun(&on_library_filter_changed)
+		);
+		number_spin -> signal_value_changed().connect(  // Show the puzzle at the number
+		  sigc::ptr_fun(&show_library_puzzle)
+		);
+		library_random_button -> signal_clicked().connect(
+		  sigc::ptr_fun(&random_library_puzzle)
+		);
+		library_play_button -> signal_clicked().connect(
+		  sigc::ptr_fun(&play_library_puzzle)
+		);
+		library_close_button -> signal_clicked().connect(
+		  sigc::bind<Glib::ustring>( sigc::ptr_fun(&hide_dialog), "library_dialog")
+		);
+
+	} else if (name == "congratulations_dialog") {
+		Gtk::Window* window;
+		Gtk::Button* exit_button;
+		Gtk::Button* main_menu_button;
+		Gtk::Button* winning_new_game_button;
+		builder -> get_widget ("application_window", window);
+		builder -> get_widget ("exit_button", exit_button);
+		builder -> get_widget ("main_menu_button", main_menu_button);
+		builder -> get_widget ("winning_new_game_button", winning_new_game_button);
+
+		exit_button -> signal_enter().connect(  // Cursor clickable
+			sigc::bind<Glib::ustring>( sigc::ptr_fun(&set_pointer), "exit_button")
+		);
+		exit_button -> signal_leave().connect(  // Cursor normal
+			sigc::bind<Glib::ustring>( sigc::ptr_fun(&restore_pointer), "exit_button")
+		);
+		exit_button -> signal_clicked().connect(  // Exit button quits game
+			sigc::bind<Gtk::Window*>( sigc::ptr_fun(&quit_wrapper), window)
+		);
+
+		main_menu_button -> signal_enter().connect(  // Cursor clickable
+			sigc::bind<Glib::ustring>( sigc::ptr_fun(&set_pointer), "main_menu_button")
+		);
+		main_menu_button -> signal_leave().connect(  // Cursor normal
+			sigc::bind<Glib::ustring>( sigc::ptr_fun(&restore_pointer), "main_menu_button")
+		);
+		main_menu_button -> signal_clicked().connect(  // Go to main menu
+			sigc::bind<bool>( sigc::ptr_fun(&close_game), false)
+		);
+
+		winning_new_game_button -> signal_enter().connect(  // Cursor clickable
+			sigc::bind<Glib::ustring>( sigc::ptr_fun(&set_pointer), "winning_new_game_button")
+		);
+		winning_new_game_button -> signal_leave().connect(  // Cursor normal
+			sigc::bind<Glib::ustring>( sigc::ptr_fun(&restore_pointer), "winning_new_game_button")
+		);
+		winning_new_game_button -> signal_clicked().connect(
+			sigc::ptr_fun(&new_game)
+		);
+	}
+
+	return dialog;
+}
+
+
 // Opens the game window for single-board games. Gets users name
 void
 open_game (void)
 {
-	Gtk::Grid* board_container_grid;
+	Gtk::Grid* board_container_grid = game_board_page();
 	Gtk::Label* current_time_time_label;
+	Gtk::Label* fastest_time_time_label;
+	Gtk::Label* puzzle_id_label;
 
-	builder -> get_widget ("board_container_grid", board_container_grid);
 	builder -> get_widget ("current_time_time_label", current_time_time_label);
+	builder -> get_widget ("fastest_time_time_label", fastest_time_time_label);
+	builder -> get_widget ("puzzle_id_label", puzzle_id_label);
+
+	fastest_time_time_label -> set_text( game -> board.get_fastest_time());
 
 	// Show game board
 	board_container_grid -> show();
 	switch_stack_page("Game Board");
 
 	// Set correct time
-	Glib::ustring game_time = board.formatted_time( board.get_total_time());
+	Glib::ustring game_time = game -> board.formatted_time( game -> board.get_total_time());
 	current_time_time_label -> set_text( game_time);
 
-	board.generate_reserved(); // Generate reserved if not already set
+	// A new game takes the puzzle chosen in the library, or else the next
+	// one, if a library was opened
+	bool new_puzzle = game -> board.get_reserved().empty();
+	bool imported = false;
+	Grid puzzle;
+	if (new_puzzle && chosen_puzzle >= 0) {
+		imported = library.puzzle(chosen_puzzle, puzzle) && game -> board.import_puzzle(puzzle);
+	}
+	chosen_puzzle = -1;
+	while (new_puzzle && !imported && next_puzzle < library.size()) {
+		imported = library.puzzle(next_puzzle++, puzzle) && game -> board.import_puzzle(puzzle);
+	}
+
+	game -> board.generate_reserved(); // Generate reserved if not already set
+	if (new_puzzle && getenv("SUDOKU_EXPORT")) game -> board.export_puzzle( getenv("SUDOKU_EXPORT"));
+	puzzle_id_label -> set_text( game -> board.get_puzzle_id());
+
+	// Says so when the variant asked for could not be made this time
+	Gtk::Label* variant_notice_label;
+	builder -> get_widget ("variant_notice_label", variant_notice_label);
+	int failed_variant = game -> board.get_failed_variant();
+	if (failed_variant >= 0) {
+		variant_notice_label -> set_text("No " + variant_name(failed_variant) +
+		  " puzzle could be made, so this one is classic");
+		variant_notice_label -> show();
+	} else {
+		variant_notice_label -> hide();
+	}
+
 	populate_board();		   // Update GUI to match internal board state
+	update_branch_buttons();
 
 	// Update game time every second
     Glib::signal_timeout().connect_seconds(  // Updates counter in game screen
       sigc::ptr_fun(&timeout_handler), 1
     );
 
-	board.start(); // Start internal clock
+	game -> board.start(); // Start internal clock
 	return;
 }
 
@@ -122,8 +520,8 @@ void
 close_game (bool game_in_progress)
 {
 	if (game_in_progress) {
-		board.set_total_time();
-		board.save_data();  // Save in case switching user
+		game -> board.set_total_time();
+		game -> board.save_data();  // Save in case switching user
 	} else hide_dialog("congratulations_dialog");
 
 	Gtk::Grid* board_container_grid;
@@ -143,7 +541,7 @@ void
 new_from_main_menu (void)
 {
 	reset_all();
-	board.save_data();
+	game -> board.save_data();
 	update_main_menu();
 }
 
@@ -177,7 +575,7 @@ update_main_menu (void)
 
 	// Change begin to resume, and add new game button, if there is a game in
 	// progress
-	if ( board.get_total_time() != 0) {
+	if ( game -> board.get_total_time() != 0) {
 		begin_button -> set_label("Resume Game");
 		button_box_box -> reorder_child(*how_to_play_button_box, 2);
 		button_box_box -> reorder_child(*new_game_button_box, 1);
@@ -204,8 +602,7 @@ quit (GdkEventAny* event, Glib::RefPtr<Gtk::Application> app)
 void
 open_instructions (void)
 {
-    Gtk::Dialog* instructions_dialog;
-    builder -> get_widget ("how_to_play_dialog", instructions_dialog);
+    Gtk::Dialog* instructions_dialog = get_dialog("how_to_play_dialog");
     if (instructions_dialog) {
 		instructions_dialog -> show();
 	}
@@ -217,8 +614,7 @@ open_instructions (void)
 void
 close_instructions (void)
 {
-    Gtk::Dialog* instructions_dialog;
-    builder -> get_widget ("how_to_play_dialog", instructions_dialog);
+    Gtk::Dialog* instructions_dialog = get_dialog("how_to_play_dialog");
     if (instructions_dialog) {
 		instructions_dialog -> hide();
 	}
@@ -226,151 +622,204 @@ close_instructions (void)
 	return;
 }
 
-// Customize TextView for each cell on the board
+// Opens the collection at path as the library, building its index in the
+// background first if it has none
 void
-initialize_board (void)
+open_collection (const std::string& path)
 {
-    // Create CssProvider
-    auto css_provider = Gtk::CssProvider::create();
-    css_provider -> load_from_path ("res/styles.css");
-
-	int i, j;
-    for (i=0; i<9; i++) {
-
-        for (j=0; j<9; j++) {
-
-            // ID of Gtk::Entry based on position in matrix
-            gchar* cell_name = (gchar *) g_malloc(31);
-            g_snprintf(cell_name, 31,"row_%d_%d", i, j);
-
-            // Get current Gtk::Entry from the builder. Get the TextBuffer from the widget
-            Gtk::Entry*  cell;
-            Glib::RefPtr< Gtk::EntryBuffer > buffer;
-            builder -> get_widget (cell_name, cell);
-            buffer = cell -> get_buffer();
-
-            // Center characters. Add CSS. Assign signal handler to only allow digits
-            cell -> set_alignment (0.5);
-            cell -> get_style_context() ->
-                add_provider(css_provider, GTK_STYLE_PROVIDER_PRIORITY_USER);
-
-            cell -> get_buffer() -> signal_inserted_text().connect(
-              sigc::bind<Glib::RefPtr <Gtk::EntryBuffer> >(
-                	sigc::ptr_fun(&on_inserted), buffer, i, j
-				)
-			);
-
-			cell -> get_buffer() -> signal_deleted_text().connect(
-				sigc::bind(
-					sigc::ptr_fun(&on_removed), i, j
-				)
-			);
-
-			// Connect mouse-click to grab_old handler for undo functionality
-			cell -> signal_button_press_event().connect(
-				sigc::bind(
-					sigc::ptr_fun(&grab_old), std::string(cell_name)
-				),
-				false  // Causes handling to be passed to default handler after this callback
-			);
-
-			free(cell_name);
-        }
-    }
+	if (library.open(path, false)) return;
+
+	library_index.path = path;
+	library_index.ready = new Glib::Dispatcher();
+	library_index.ready -> connect( sigc::ptr_fun(&on_library_indexed));
+
+	library_index.worker = std::thread( [] () {
+		library_index.built = build_library_index(library_index.path, 0, nullptr, &library_index.cancel);
+		library_index.ready -> emit();
+	});
 
 	return;
 }
 
-// Update GUI to match internal board state
+// Opens the library once its index is built, and shows the button for it
 void
-populate_board (void)
+on_library_indexed (void)
 {
-	Gtk::Entry* cell;
+	library_index.worker.join();
+	delete library_index.ready;
+	library_index.ready = nullptr;
 
-	int i, j;
-	for (i=0; i<9; i++) {
-		std::string iStr = std::to_string(i);
+	if ( !library_index.built || !library.open(library_index.path, false)) {
+		std::cerr << "Could not open " << library_index.path << std::endl;
+		return;
+	}
+
+	Gtk::Button* library_button;
+	builder -> get_widget ("library_button", library_button);
+	if (library.size() > 0) library_button -> show();
+
+	return;
+}
 
-		for (j=0; j<9; j++) {
-			std::string jStr = std::to_string(j);
+// Open the library dialog, showing the first puzzle the first time
+void
+open_library (void)
+{
+	Gtk::Dialog* library_dialog = get_dialog("library_dialog");
+	if (shown_puzzle < 0) on_library_filter_changed();
+	library_dialog -> show();
 
-			// Used to ensure the GUI matches the internal state
-			std::string cell_value = std::to_string( board.get_number(i, j));
-			std::string cell_name = "row_" + iStr + "_" + jStr;
-			bool reserved_cell = board.check_reserved(i, j);
+	return;
+}
 
-			builder -> get_widget(cell_name, cell);
+// Pages through the puzzles of the difficulty picked in the library dialog
+void
+on_library_filter_changed (void)
+{
+	Gtk::ComboBoxText* difficulty_combo;
+	Gtk::SpinButton* number_spin;
+	builder -> get_widget ("library_difficulty_combo", difficulty_combo);
+	builder -> get_widget ("library_number_spin", number_spin);
 
-			if ( cell_value.compare("0") != 0) cell -> set_text(cell_value);
+	Glib::ustring filter = difficulty_combo -> get_active_id();
+	int count = filter == "all" ? library.size() : library.count_with( atoi(filter.c_str()));
 
-			if (reserved_cell) {
-				cell -> set_editable(false);
-				cell -> set_sensitive(false);
-				cell -> get_style_context() -> add_class("reserved");
+	number_spin -> set_range(1, std::max(1, count));
+	number_spin -> set_increments(1, 100);
+	number_spin -> set_value(1);
+	show_library_puzzle();
 
-			} else {
-				cell -> set_editable(true);
-				cell -> set_sensitive(true);
-				cell -> get_style_context() -> remove_class("reserved");
-			}
+	return;
+}
 
-		}
+// Shows the puzzle at the number in the library dialog. Only that puzzle is
+// read, so paging is just as fast in a library of millions.
+void
+show_library_puzzle (void)
+{
+	Gtk::ComboBoxText* difficulty_combo;
+	Gtk::SpinButton* number_spin;
+	Gtk::Label* library_info_label;
+	Gtk::Label* library_puzzle_label;
+	builder -> get_widget ("library_difficulty_combo", difficulty_combo);
+	builder -> get_widget ("library_number_spin", number_spin);
+	builder -> get_widget ("library_info_label", library_info_label);
+	builder -> get_widget ("library_puzzle_label", library_puzzle_label);
+
+	Glib::ustring filter = difficulty_combo -> get_active_id();
+	int n = number_spin -> get_value_as_int() - 1;
+	int number = filter == "all" ? n : library.nth_with( atoi(filter.c_str()), n);
+
+	Grid puzzle;
+	if ( !library.puzzle(number, puzzle)) {
+		shown_puzzle = -1;
+		library_info_label -> set_text("No puzzles");
+		library_puzzle_label -> set_text("");
+		return;
 	}
+	shown_puzzle = number;
+
+	std::string info = "Puzzle " + std::to_string(number + 1) + " of " +
+	  std::to_string( library.size()) + "\n" + difficulty_name( library.difficulty(number));
+	int first = library.find( canonical_hash(puzzle));
+	if (first != number) info += ", same as puzzle " + std::to_string(first + 1);
+	library_info_label -> set_text(info);
+
+	// Nine rows, with a gap between blocks
+	std::string grid;
+	int i;
+	for (i=0; i<81; i++) {
+		grid.push_back(puzzle.cells[i] ? puzzle.cells[i] + '0' : '.');
+		if (i % 27 == 26 && i < 80) grid += "\n\n";
+		else if (i % 9 == 8 && i < 80) grid += "\n";
+		else if (i % 3 == 2 && i % 9 != 8) grid += " ";
+	}
+	library_puzzle_label -> set_text(grid);
+
+	return;
 }
 
-// Set every entry back to blank when reset button is hit. Excludes buttons set by the game.
+// Jumps to a random puzzle of the difficulty picked in the library dialog
 void
-reset_board (void)
+random_library_puzzle (void)
 {
-    int i, j;
-    for (i=0; i<9; i++) {
-        for (j=0; j<9; j++) {
-			if ( !board.check_reserved(i, j) ) {
-				// ID of Gtk::Entry based on position in matrix
-	            gchar* cell_name = (gchar *) g_malloc(31);
-	            g_snprintf(cell_name, 31, "row_%d_%d", i, j);
+	Gtk::SpinButton* number_spin;
+	builder -> get_widget ("library_number_spin", number_spin);
 
-	            // Get current Gtk::Entry from the builder
-	            Gtk::Entry*  cell;
-	            builder -> get_widget (cell_name, cell);
+	double lowest, highest;
+	number_spin -> get_range(lowest, highest);
+	static Random random(fresh_seed());
+	number_spin -> set_value(1 + random.below((int) highest));
 
-	            // Clear this Gtk::Entry's text
-	            cell -> set_text("");
+	return;
+}
 
-				board.set_number(0, i, j);
-			}
-        }
-   }
+// Starts a new game with the puzzle shown in the library dialog
+void
+play_library_puzzle (void)
+{
+	if (shown_puzzle < 0) return;
+
+	hide_dialog("library_dialog");
+	reset_all();  // Same as New Game, so a paused game is dropped
+	chosen_puzzle = shown_puzzle;
+	open_game();
 
-   return;
+	return;
 }
 
-// Erases the reserved cells in the gui only
+// Puts the board view where the board goes on the game board page
 void
-reset_reserved (void)
+initialize_board (void)
 {
-	std::vector< std::vector< int>> reserved = board.get_reserved();
-	for (auto i : reserved) {
-		gchar* cell_name = (gchar *) g_malloc(31);
-		g_snprintf(cell_name, 31, "row_%d_%d", i[0], i[1]);
+	Gtk::Grid* board_container_grid;
+	builder -> get_widget ("board_container_grid", board_container_grid);
 
-		Gtk::Entry* cell;
-		builder -> get_widget (cell_name, cell);
+	board_view = Gtk::manage(new BoardView(game -> board));
+	board_container_grid -> attach(*board_view, 0, 0, 3, 3);
+	board_view -> show();
 
-		cell -> set_editable(true);
-		cell -> set_text("");
+	board_view -> signal_cell_changed().connect( sigc::ptr_fun(&on_cell_changed));
+	board_view -> signal_mark_toggled().connect( sigc::ptr_fun(&on_mark_toggled));
+	board_view -> signal_board_pasted().connect( sigc::ptr_fun(&on_board_pasted));
 
-		board.set_number(0, i[0], i[1]);
-	}
+	return;
+}
+
+// Update GUI to match internal board state
+void
+populate_board (void)
+{
+	TRACE_SCOPE("populate_board");
+
+	// Numbers, reserved cells and variant regions are all read from the board.
+	// Wrong cells from the last game are forgotten.
+	board_view -> flag_cells(CellSet{0, 0});
+	board_view -> grab_focus();
+	return;
+}
+
+// Set every cell back to blank when reset button is hit. Excludes cells set by the game.
+void
+reset_board (void)
+{
+	if (board_view == nullptr) return;  // Nothing shown yet
+
+	game -> board.clear_entries();
+	board_view -> refresh();
+	report_race_progress();
+	return;
 }
 
 // Resets the gui and internal board state
 void
 reset_all (void)
 {
-	reset_board();     // Resets external playing board
-	reset_reserved();  // Clears reserved cells from GUI
-	board.reset();
+	game -> board.reset();  // Reserved cells too
+	if (board_view) board_view -> refresh();
+
+	// Moves from the last game can't be undone into the next one
+	game -> clear_history();
 }
 
 // Set cursor to pointer when over button
@@ -397,44 +846,108 @@ restore_pointer (Glib::ustring widget)
 	return;
 }
 
-// Only allow numbers 1-9 to be entered on sudoku
+// Puts number in a cell of the board and repaints just that cell
+void
+set_cell (int row, int col, int number)
+{
+	game -> board.set_number(number, row, col);
+
+	board_view -> begin_batch();
+	board_view -> refresh_cell(row, col);
+	if (number != 0) board_view -> refresh_peers(row, col);  // Their marks may have changed
+	board_view -> end_batch();
+	report_race_progress();
+	return;
+}
+
+// Called every time the user types or clears a cell in the board view
+void
+on_cell_changed (int row, int col, int number)
+{
+	TRACE_SCOPE("on_cell_changed");
+
+	// Remember the old state for undo. A new change can't be redone past.
+	game -> user_stack.push( cell_state(row, col));
+	game -> undone_stack = ActionStack();
+
+	set_cell(row, col, number);
+	schedule_autosave();
+
+	// The digit is on the board. Its latency ends when the next frame is painted
+	if (number != 0 && keypress_latency.key_time != 0) {
+		keypress_latency.paint_pending = keypress_latency.key_time;
+	}
+	keypress_latency.key_time = 0;
+
+	return;
+}
+
+// Notes the time a digit key goes down. Returns false so the board view still gets it
 bool
-check_if_number (char inserted, Glib::RefPtr< Gtk::EntryBuffer > buffer)
+on_key_pressed (GdkEventKey* event)
 {
-  if (inserted > '9' || inserted < '1') {
-    buffer -> delete_text(0, 1);
+	guint key = event -> keyval;
+	if ((key >= GDK_KEY_1 && key <= GDK_KEY_9) || (key >= GDK_KEY_KP_1 && key <= GDK_KEY_KP_9)) {
+		keypress_latency.key_time = g_get_monotonic_time();
+	}
+
 	return false;
-  }
-	return true;
 }
 
-// When text is entered, must store in internal board
+// Called by the frame clock after each frame is painted
 void
-insert_to_board (char inserted, int outer, int inner)
+on_after_paint (GdkFrameClock* clock, gpointer data)
 {
-	board.set_number(inserted - '0', outer, inner);
+	if (keypress_latency.paint_pending == 0) return;
+
+	long latency = g_get_monotonic_time() - keypress_latency.paint_pending;
+	keypress_latency.histogram.record(latency);
+	keypress_latency.paint_pending = 0;
+
+	TRACE_COUNTER("keypress_latency_us", latency);
 	return;
 }
 
-// Call this every time a number is inserted on the board
+// Starts measuring keypress to paint latency in window
 void
-on_inserted (guint position, const gchar* chars, guint n_chars,
-  Glib::RefPtr< Gtk::EntryBuffer > buffer, int outer, int inner)
+watch_frames (Gtk::Window* window)
 {
-	char inserted = *chars;
-	if ( check_if_number(inserted, buffer)) {
-		insert_to_board (inserted, outer, inner);
+	window -> signal_key_press_event().connect(
+		sigc::ptr_fun(&on_key_pressed),
+		false  // Runs before the entry handles the key
+	);
 
-	}
+	// The frame clock only exists once the window is realized
+	window -> signal_realize().connect( [window]() {
+		GdkFrameClock* clock = gtk_widget_get_frame_clock(GTK_WIDGET(window -> gobj()));
+		g_signal_connect(clock, "after-paint", G_CALLBACK(on_after_paint), NULL);
+	});
 
 	return;
 }
 
-// Call this every time a number is erased from the board
+// Reports the startup time once the first frame is on screen
 void
-on_removed (guint position, guint n_chars, int outer, int inner)
+on_first_paint (GdkFrameClock* clock, gpointer data)
 {
-	insert_to_board('0', outer, inner);
+	g_signal_handler_disconnect(clock, startup_timing.paint_handler);
+
+	startup_phase("first frame", startup_timing.started);
+
+	return;
+}
+
+// Starts timing how long window takes to show its first frame
+void
+time_startup (Gtk::Window* window)
+{
+	window -> signal_realize().connect( [window]() {
+		GdkFrameClock* clock = gtk_widget_get_frame_clock(GTK_WIDGET(window -> gobj()));
+		startup_timing.paint_handler =
+		  g_signal_connect(clock, "after-paint", G_CALLBACK(on_first_paint), NULL);
+	});
+
+	return;
 }
 
 // Check if a board is a win. If it is, check if this is the fastest score and
@@ -443,24 +956,34 @@ on_removed (guint position, guint n_chars, int outer, int inner)
 void
 check_win (void)
 {
-	board.set_checking_win(true);  // Stop time while performing checks
+	TRACE_SCOPE("check_win");
 
-	bool winner = board.is_win();
+	game -> board.set_checking_win(true);  // Stop time while performing checks
+
+	bool winner = game -> board.is_win();
 
 	if (winner) {
-		bool new_record = board.new_record();  // Check to see if new record
-		board.reset_time();  // Reset time since not in a paused game
+		bool new_record = game -> board.new_record();  // Check to see if new record
+		game -> board.reset_time();  // Reset time since not in a paused game
+
+		// A won game is not resumed
+		autosave_timer.disconnect();
+		game -> board.discard_autosave();
+
+		// The host checks the board too, and times it
+		if (race.client && race.started && game == race.game) race.client -> send_done( game -> board.get_grid());
 
 		if (new_record) {
 			Gtk::Label *fastest_time_time_label;
 			builder -> get_widget ("fastest_time_time_label", fastest_time_time_label);
-			fastest_time_time_label -> set_text( board.get_fastest_time());
+			fastest_time_time_label -> set_text( game -> board.get_fastest_time());
 
 		}
 
 		open_congratulations();
 
 	} else {
+		board_view -> flag_cells( game -> board.check_progress());  // Shows what is wrong
 		open_sorry ();  // Show dialog saying it was not a win
 	}
 
@@ -470,8 +993,7 @@ check_win (void)
 void
 open_sorry (void)
 {
-	Gtk::Dialog* sorry_dialog;
-	builder -> get_widget ("sorry_dialog", sorry_dialog);
+	Gtk::Dialog* sorry_dialog = get_dialog("sorry_dialog");
 	if (sorry_dialog) {
 		sorry_dialog -> show();
 	}
@@ -482,8 +1004,7 @@ open_sorry (void)
 void
 close_sorry (void)
 {
-	Gtk::Dialog* sorry_dialog;
-	builder -> get_widget ("sorry_dialog", sorry_dialog);
+	Gtk::Dialog* sorry_dialog = get_dialog("sorry_dialog");
 	if (sorry_dialog) {
 		sorry_dialog -> hide();
 	}
@@ -491,32 +1012,401 @@ close_sorry (void)
 	return;
 }
 
+// Called when the user adds or removes a pencil mark in the board view
+void
+on_mark_toggled (int row, int col, int number)
+{
+	game -> user_stack.push( cell_state(row, col));
+	game -> undone_stack = ActionStack();
+
+	game -> board.toggle_mark(number, row, col);
+	board_view -> refresh_cell(row, col);
+	schedule_autosave();
+	return;
+}
+
+// Called when the user pastes a grid into the board view. The whole paste is
+// one move, undone in one go.
+void
+on_board_pasted (const Grid& numbers)
+{
+	TRACE_SCOPE("on_board_pasted");
+
+	Action before = cell_state(-1, -1);
+	if (game -> board.fill_entries(numbers) == 0) return;
+
+	game -> user_stack.push(before);
+	game -> undone_stack = ActionStack();
+
+	board_view -> refresh();
+	report_race_progress();
+	schedule_autosave();
+	return;
+}
+
+// What undo needs to put a cell back: a snapshot of the whole board, since
+// placing a number clears it from the marks of the cell's peers
+Action
+cell_state (int row, int col)
+{
+	return {row, col, game -> board.get_state()};
+}
+
+// Puts back a state from cell_state
+void
+restore_state (const Action& action)
+{
+	game -> board.set_state(action.before);
+
+	if (action.row < 0) {  // A paste, any cell may have changed
+		board_view -> refresh();
+		report_race_progress();
+		return;
+	}
+
+	// Only the cell and its peers can have changed
+	board_view -> begin_batch();
+	board_view -> refresh_cell(action.row, action.col);
+	board_view -> refresh_peers(action.row, action.col);
+	board_view -> end_batch();
+	report_race_progress();
+	return;
+}
+
+// Called from the guess button. Moves from here on can be dropped together.
+void
+branch_board (void)
+{
+	game -> branch();
+	update_branch_buttons();
+	return;
+}
+
+// Called from the keep guess button
+void
+keep_branch (void)
+{
+	game -> keep_branch();
+	update_branch_buttons();
+	schedule_autosave();  // The guess counts now
+	return;
+}
+
+// Called from the drop guess button. Any cell may go back, so all are redrawn.
+void
+discard_branch (void)
+{
+	game -> discard_branch();
+	board_view -> refresh();
+	update_branch_buttons();
+	report_race_progress();
+	return;
+}
+
+// Keep and drop only work inside a guess. The guess button shows how deep
+// the guesses are nested.
+void
+update_branch_buttons (void)
+{
+	Gtk::Button* branch_button;
+	Gtk::Button* keep_branch_button;
+	Gtk::Button* discard_branch_button;
+
+	builder -> get_widget ("branch_button", branch_button);
+	builder -> get_widget ("keep_branch_button", keep_branch_button);
+	builder -> get_widget ("discard_branch_button", discard_branch_button);
+
+	int depth = game -> board.branch_depth();
+	branch_button -> set_label(depth == 0 ? "Guess" : "Guess (" + std::to_string(depth) + " deep)");
+	keep_branch_button -> set_sensitive(depth > 0);
+	discard_branch_button -> set_sensitive(depth > 0);
+
+	return;
+}
+
+// Called from the check button. Shows which numbers don't match the solution
+void
+check_progress (void)
+{
+	board_view -> flag_cells( game -> board.check_progress());
+	board_view -> grab_focus();
+	return;
+}
+
+// Called from the reveal button. Fills in the selected cell from the solution
+// as a move that can be undone.
+void
+reveal_cell (void)
+{
+	int row, col, number;
+	board_view -> get_selection(row, col);
+	board_view -> grab_focus();
+
+	if ( !game -> board.reveal_cell(row, col, number)) return;
+	if (game -> board.get_number(row, col) == number) return;
+
+	game -> user_stack.push( cell_state(row, col));
+	game -> undone_stack = ActionStack();
+
+	set_cell(row, col, number);
+	schedule_autosave();
+	return;
+}
+
+// Called from the hint button in the 'almost there' dialog. Fills in the first
+// empty or wrong cell from the solution and goes back to the game
+void
+give_hint (void)
+{
+	close_sorry();
+
+	int row, col, number;
+	if ( game -> board.get_hint(row, col, number)) {
+		// A hint is a move like any other, so it can be undone
+		game -> user_stack.push( cell_state(row, col));
+		game -> undone_stack = ActionStack();
+
+		set_cell(row, col, number);
+		board_view -> select(row, col);
+		schedule_autosave();
+	}
+
+	game -> board.start();  // Start time when back to game
+	return;
+}
+
 void
 open_congratulations (void)
 {
-	Gtk::Dialog* congratulations_dialog;
-	builder -> get_widget ("congratulations_dialog", congratulations_dialog);
+	Gtk::Dialog* congratulations_dialog = get_dialog("congratulations_dialog");
 	congratulations_dialog -> show();
 }
 
 void
 close_congratulations (void)
 {
-	Gtk::Dialog* congratulations_dialog;
-	builder -> get_widget ("congratulations_dialog", congratulations_dialog);
+	Gtk::Dialog* congratulations_dialog = get_dialog("congratulations_dialog");
 	congratulations_dialog -> hide();
 }
 
+// Joins the race in SUDOKU_RACE as username. Its messages are read as they
+// arrive by on_race_input.
+void
+join_race (const Glib::ustring& username)
+{
+	std::string address = getenv("SUDOKU_RACE");
+	int port = RACE_PORT;
+	size_t colon = address.rfind(':');
+	if (colon != std::string::npos) {
+		port = atoi(address.c_str() + colon + 1);
+		address = address.substr(0, colon);
+	}
+
+	RaceClient* client = new RaceClient();
+	if ( !client -> join(address, port, username)) {
+		std::cerr << "Could not join the race at " << getenv("SUDOKU_RACE") << std::endl;
+		delete client;
+		return;
+	}
+
+	race.client = client;
+	race.game = game;
+	race.status = "Waiting for the race to start";
+
+	Glib::signal_io().connect( sigc::ptr_fun(&on_race_input), client -> get_fd(),
+	  Glib::IO_IN | Glib::IO_HUP | Glib::IO_ERR);
+	update_race_label();
+	return;
+}
+
+// Called when the race host sends something. Returns false to stop watching
+// once the host has gone.
+bool
+on_race_input (Glib::IOCondition condition)
+{
+	(void) condition;
+
+	std::vector<RaceEvent> events;
+	bool connected = race.client -> receive(events);
+
+	for (const RaceEvent& event : events) {
+		switch (event.type) {
+			case RACE_WELCOME:
+				prepare_race();
+				break;
+
+			case RACE_PLAYER:
+				race.standings[event.name] = "ready";
+				break;
+
+			case RACE_START: {
+				// Everyone's clock is turned to the host's, so all boards show
+				// at once
+				long wait = (event.value - race_clock()) / 1000;
+				Glib::signal_timeout().connect_once( sigc::ptr_fun(&start_race), std::max(0L, wait));
+				race.status = "Get ready...";
+				break;
+			}
+
+			case RACE_PROGRESS:
+				if (race.standings[event.name].compare(0, 1, "#") != 0) {
+					race.standings[event.name] = std::to_string(event.value) + "/81";
+				}
+				break;
+
+			case RACE_FINISHED: {
+				gchar finished[40];
+				g_snprintf(finished, 40, "#%d in %.1fs", event.place, event.value / 1000.0);
+				race.standings[event.name] = finished;
+				break;
+			}
+
+			case RACE_WRONG:
+				race.status = "The host did not accept the board";
+				break;
+
+			case RACE_ERROR:
+				race.status = "The race host said: " + event.name;
+				break;
+		}
+	}
+
+	if ( !connected) {
+		race.status = race.started ? "Race over" : "The race host went away";
+		race.started = false;
+	}
+
+	update_race_label();
+	return connected;
+}
+
+// Makes the race puzzle on its own thread while waiting for the start, and
+// rates it so the cache has it. The game being played is left alone until
+// the start.
+void
+prepare_race (void)
+{
+	if (race.made != nullptr) return;  // Already being made
+
+	race.made = new Glib::Dispatcher();
+	race.made -> connect( sigc::ptr_fun(&on_race_prepared));
+
+	std::string id = race.client -> get_puzzle_id();
+	race.maker = std::thread( [id] () {
+		TRACE_SCOPE("prepare_race");
+
+		race.made_puzzle = race_puzzle(id, race.puzzle, race.solution);
+		if (race.made_puzzle) {
+			analyze_solved_puzzle(race.puzzle, race.solution, shared_cache());
+			rate_puzzle(race.puzzle, &shared_cache());
+		}
+		race.made -> emit();
+	});
+
+	return;
+}
+
+// Called once the race puzzle is made. Starts the race if the start came
+// while it was being made.
+void
+on_race_prepared (void)
+{
+	race.maker.join();
+	delete race.made;
+	race.made = nullptr;
+
+	if ( !race.made_puzzle) {
+		race.status = "Not a race puzzle: " + race.client -> get_puzzle_id();
+		update_race_label();
+		return;
+	}
+
+	race.prepared = true;
+	if (race.start_pending) start_race();
+	return;
+}
+
+// Called when the race starts. The racing player's game switches to the race
+// puzzle made by prepare_race and its clock starts from now.
+void
+start_race (void)
+{
+	if (race.client == nullptr) return;
+	if ( !race.prepared) {
+		race.start_pending = true;
+		return;
+	}
+	race.start_pending = false;
+
+	if (game != race.game) {
+		flush_autosave();  // Moves of the game being left
+		game = race.game;
+		if (board_view) board_view -> show_board(game -> board);
+	}
+
+	// Placed before open_game, so it doesn't take a puzzle from the library
+	reset_all();
+	game -> board.import_generated(race.puzzle, race.solution, race.client -> get_puzzle_id());
+	game -> board.generate_reserved();
+
+	race.started = true;
+	race.status = "Go!";
+	open_game();
+	report_race_progress();
+	update_race_label();
+	return;
+}
+
+// Tells the race host how many cells the racing player has filled, if they
+// are racing
+void
+report_race_progress (void)
+{
+	if (race.client == nullptr || !race.started || game != race.game) return;
+
+	race.client -> send_progress( count_givens( game -> board.get_grid()));
+	return;
+}
+
+// Shows how every player in the race is doing beside the board, once the
+// board is built
+void
+update_race_label (void)
+{
+	if ( !builder -> get_object("race_label")) return;
+
+	Gtk::Label* race_label;
+	builder -> get_widget ("race_label", race_label);
+
+	Glib::ustring text = race.status;
+	for (const auto& standing : race.standings) {
+		text += "\n" + standing.first + ": " + standing.second;
+	}
+
+	race_label -> set_text(text);
+	race_label -> show();
+	return;
+}
+
 // Wrapper for boards timeout handler to match handler for Glib::signal_timeout
 bool
 timeout_handler (void)
 {
-	if ( board.get_checking_win()) return true;
+	TRACE_SCOPE("timeout_handler");
+
+	if ( game -> board.get_checking_win()) return true;
 
 	Gtk::Label* current_time_time_label;
 	builder -> get_widget ("current_time_time_label", current_time_time_label);
 
-	current_time_time_label -> set_text( board.timeout_handler_helper());
+	current_time_time_label -> set_text( game -> board.timeout_handler_helper());
+
+	if (keypress_latency.overlay) {
+		Gtk::Label* latency_label;
+		builder -> get_widget ("latency_label", latency_label);
+		latency_label -> set_text( keypress_latency.histogram.summary());
+	}
+
 	return true;
 }
 
@@ -526,23 +1416,34 @@ handle_user (void)
 {
 	Gtk::Entry* username_entry;
 	Gtk::Label* welcome_label;
-	Gtk::Label* fastest_time_time_label;
 
 	builder -> get_widget ("username_entry", username_entry);
 	builder -> get_widget ("welcome_label", welcome_label);
-	builder -> get_widget ("fastest_time_time_label", fastest_time_time_label);
 
 	// User must enter a name to continue
 	if ( !username_entry -> get_text_length()) {
 		return;
 	}
 
-	// Set username in board. Set fastest time
+	// Switch to the user's game if they already have one open, otherwise
+	// give them their own. The first user takes the game opened at startup.
+	// The fastest time is shown when the game opens.
 	Glib::ustring username = username_entry -> get_text();
-	board.set_username(username);
-
-	Glib::ustring user_fastest = board.get_fastest_time();
-	fastest_time_time_label -> set_text(user_fastest);
+	flush_autosave();  // Moves of the game being left
+	Game* previous = game;
+	game = sessions.find(username);
+	if (game == nullptr && previous -> board.get_username() == "") game = previous;
+	if (game == nullptr) game = open_session();
+	if (game -> board.get_username() != username) game -> board.set_username(username);
+
+	if (getenv("SUDOKU_RACE") && race.client == nullptr) join_race(username);
+
+	// Whoever left without a game in progress has nothing to come back to,
+	// unless they are waiting for a race
+	if (previous != game && previous != race.game && previous -> board.get_total_time() == 0) {
+		sessions.close(previous);
+	}
+	if (board_view) board_view -> show_board(game -> board);
 
 	// Set welcome message on main menu
 	gchar* welcome_message = (gchar *) g_malloc(120);
@@ -555,6 +1456,18 @@ handle_user (void)
 	return;
 }
 
+// Opens a game with the rules new games use, for a user to take
+Game*
+open_session (void)
+{
+	Game* opened = sessions.open();
+
+	// Rules for new games, eg. SUDOKU_VARIANT=killer. Classic if unset.
+	if (getenv("SUDOKU_VARIANT")) opened -> board.set_variant( variant_from_name( getenv("SUDOKU_VARIANT")));
+
+	return opened;
+}
+
 // Called to switch the stack page
 void
 switch_stack_page (Glib::ustring page)
@@ -577,8 +1490,7 @@ quit_wrapper (Gtk::Window* window)
 void
 hide_dialog (Glib::ustring dialog)
 {
-	Gtk::Dialog* hide;
-	builder -> get_widget (dialog, hide);
+	Gtk::Dialog* hide = get_dialog(dialog);
 	hide -> hide();
 	return;
 }
@@ -586,19 +1498,15 @@ hide_dialog (Glib::ustring dialog)
 void
 undo (void)
 {
-	if (user_actions.user_stack.empty()) return;
-
-	std::vector< std::string> action = user_actions.user_stack.top();
-	user_actions.user_stack.pop();
+	if (game -> user_stack.empty()) return;
 
-	std::string widgetName = action[0];
-	std::string restoreValue = action[1];
+	Action action = game -> user_stack.top();
+	game -> user_stack.pop();
 
-	Gtk::Entry* cell;
-	builder -> get_widget(widgetName, cell);
-	cell -> set_text(restoreValue);
-
-	user_actions.undone_stack.push(action);
+	// Keep the state being replaced so redo can put it back
+	game -> undone_stack.push( cell_state(action.row, action.col));
+	restore_state(action);
+	schedule_autosave();
 
 	return;
 }
@@ -606,35 +1514,53 @@ undo (void)
 void
 redo (void)
 {
-	if (user_actions.undone_stack.empty()) return;
+	if (game -> undone_stack.empty()) return;
 
-	std::vector< std::string> action = user_actions.undone_stack.top();
-	user_actions.undone_stack.pop();
+	Action action = game -> undone_stack.top();
+	game -> undone_stack.pop();
 
-	std::string widgetName = action[0];
-	std::string restoreValue = action[1];
+	game -> user_stack.push( cell_state(action.row, action.col));
+	restore_state(action);
+	schedule_autosave();
 
-	Gtk::Entry* cell;
-	builder -> get_widget(widgetName, cell);
-	cell -> set_text(restoreValue);
+	return;
+}
 
-	user_actions.user_stack.push(action);
+// Called after every move. Restarts the autosave timer, unless moves have
+// kept it waiting for autosave_max_wait already
+void
+schedule_autosave (void)
+{
+	gint64 now = g_get_monotonic_time();
+
+	if (!autosave_timer.connected()) first_unsaved_move = now;
+	else if (now - first_unsaved_move >= autosave_max_wait * (gint64) 1000) return;
+	else autosave_timer.disconnect();
 
+	autosave_timer = Glib::signal_timeout().connect(
+	  sigc::ptr_fun(&autosave_game), autosave_delay
+	);
 	return;
 }
 
-// Grabs the old value in the entry before the user changes for undo functionality
-gboolean
-grab_old (GdkEventButton* event, std::string name)
+// Writes the moves made since the last autosave. Returns false so the timer
+// runs once.
+bool
+autosave_game (void)
 {
-	Gtk::Entry* cell;
-	builder -> get_widget(name, cell);
-	std::string restoreValue = cell -> get_text();
+	game -> board.autosave();
+	return false;
+}
 
-	std::vector< std::string> action = {name, restoreValue};
-	user_actions.user_stack.push(action);
+// Autosaves now if moves are waiting for the timer
+void
+flush_autosave (void)
+{
+	if (!autosave_timer.connected()) return;
 
-	return false;
+	autosave_timer.disconnect();
+	game -> board.autosave();
+	return;
 }
 
 // Build the toolbar, create the action group, assign actions
@@ -653,9 +1579,31 @@ build_toolbar (void)
 int
 main(int argc, char **argv)
 {
+	startup_timing.started = trace_now();
+
     // Required. Initialize gtkmm, check command line arguments, initialize variables
     auto app = Gtk::Application::create (argc, argv, "alexeast.sudoku");
 
+	game = open_session();
+
+	// Replay a puzzle by the ID shown beside the board, eg.
+	// SUDOKU_PUZZLE_ID=CR-0F3K9QW2ZB1X4 . Sets the variant too. Only the
+	// first game started uses it.
+	if (getenv("SUDOKU_PUZZLE_ID") && !game -> board.set_puzzle_id( getenv("SUDOKU_PUZZLE_ID"))) {
+		std::cerr << "Not a puzzle ID: " << getenv("SUDOKU_PUZZLE_ID") << std::endl;
+	}
+
+	// Play the puzzles of a collection instead of generated ones, eg.
+	// SUDOKU_COLLECTION=top1465.txt . Its index is built the first time, which
+	// rates every puzzle, so that happens in the background and the library
+	// button shows once it is done. Until then games are generated.
+	// SUDOKU_EXPORT=played.sdm keeps a copy of every puzzle started.
+	if (getenv("SUDOKU_COLLECTION")) {
+		long opened = trace_now();
+		open_collection( getenv("SUDOKU_COLLECTION"));
+		startup_phase("library", opened);
+	}
+
     /* Pointers for widgets to be loaded from builder
      *
      */
@@ -665,127 +1613,44 @@ main(int argc, char **argv)
 
     // Button pointers
     Gtk::Button* begin_button;
-    Gtk::Button* done_button;
     Gtk::Button* how_to_play_button;
-    Gtk::Button* got_it_button;
-    Gtk::Button* reset_button;
-    Gtk::Button* finish_later_button;
-    Gtk::Button* hint_button;
-    Gtk::Button* continue_button;
 	Gtk::Button* lets_go_button;
 	Gtk::Button* new_game_button;
 	Gtk::Button* switch_user_button;
-	Gtk::Button* exit_button;
-	Gtk::Button* main_menu_button;
-	Gtk::Button* winning_new_game_button;
-
-    // Grid pointers
-    Gtk::Grid* board_container_grid;
-	Gtk::Grid* player_info_grid;
-	Gtk::Grid* menu_grid;
+	Gtk::Button* library_button;
 
 	// Entry pointers
 	Gtk::Entry* username_entry;
 
-	// Box pointers
-	Gtk::Box* menu_screen_box;
-	Gtk::Box* username_entry_box;
-	Gtk::Box* button_box_box;
-
-	// Stack pointers
-	Gtk::Stack* application_stack;
-
-	// Label pointers
-	Gtk::Label* welcome_label;
-	Gtk::Label* game_title_label;
-	Gtk::Label* source_code_label;
-	Gtk::Label* username_label;
-	Gtk::Label* player_info_title_label;
-	Gtk::Label* current_time_header_label;
-	Gtk::Label* current_time_time_label;
-	Gtk::Label* fastest_time_header_label;
-	Gtk::Label* fastest_time_time_label;
-	Gtk::Label* note_label;
-	Gtk::Label* you_won_label;
-	Gtk::Label* you_won_info_label;
-	Gtk::Label* almost_there_label;
-	Gtk::Label* almost_there_info_label;
-	Gtk::Label* instructions_label;
-
-	// Dialog pointers
-	Gtk::Dialog* sorry_dialog;
-	Gtk::Dialog* congratulations_dialog;
-	Gtk::Dialog* how_to_play_dialog;
-
 
 
     /* Create builder from Glade file. Load necessary widgets.
      *
      */
 
-    // Window widgets
-    builder  = Gtk::Builder::create_from_file ("res/GUI.glade");
+    // Window widgets. The game board and dialogs are built on first use
+    long started = trace_now();
+    builder  = Gtk::Builder::create_from_resource (RESOURCE_PREFIX "GUI.glade");
+    startup_phase("GUI.glade", started);
     builder -> get_widget ("application_window", window);
 
     // Button widgets
     builder -> get_widget ("begin_button", begin_button);
-    builder -> get_widget ("done_button", done_button);
     builder -> get_widget ("how_to_play_button", how_to_play_button);
-    builder -> get_widget ("got_it_button", got_it_button);
-    builder -> get_widget ("reset_button", reset_button);
-    builder -> get_widget ("finish_later_button", finish_later_button);
-    builder -> get_widget ("hint_button", hint_button);
-    builder -> get_widget ("continue_button", continue_button);
 	builder -> get_widget ("lets_go_button", lets_go_button);
 	builder -> get_widget ("new_game_button", new_game_button);
 	builder -> get_widget ("switch_user_button", switch_user_button);
-	builder -> get_widget ("exit_button", exit_button);
-	builder -> get_widget ("main_menu_button", main_menu_button);
-	builder -> get_widget ("winning_new_game_button", winning_new_game_button);
-
-    // Grid widgets
-    builder -> get_widget ("board_container_grid", board_container_grid);
-	builder -> get_widget ("player_info_grid", player_info_grid);
-	builder -> get_widget ("menu_grid", menu_grid);
+	builder -> get_widget ("library_button", library_button);
 
 	// Entry widgets
 	builder -> get_widget ("username_entry", username_entry);
 
-	// Box widgets
-	builder -> get_widget("menu_screen_box", menu_screen_box);
-	builder -> get_widget("username_entry_box", username_entry_box);
-	builder -> get_widget("button_box_box", button_box_box);
-
-	// Stack widgets
-	builder -> get_widget("application_stack", application_stack);
-
-	// Label widgets
-	builder -> get_widget("welcome_label", welcome_label);
-	builder -> get_widget("game_title_label", game_title_label);
-	builder -> get_widget("source_code_label", source_code_label);
-	builder -> get_widget("username_label", username_label);
-	builder -> get_widget("player_info_title_label", player_info_title_label);
-	builder -> get_widget("current_time_header_label", current_time_header_label);
-	builder -> get_widget("current_time_time_label", current_time_time_label);
-	builder -> get_widget("fastest_time_header_label", fastest_time_header_label);
-	builder -> get_widget("fastest_time_time_label", fastest_time_time_label);
-	builder -> get_widget("note_label", note_label);
-	builder -> get_widget("you_won_label", you_won_label);
-	builder -> get_widget("you_won_info_label", you_won_info_label);
-	builder -> get_widget("almost_there_label", almost_there_label);
-	builder -> get_widget("almost_there_info_label", almost_there_info_label);
-	builder -> get_widget("instructions_label", instructions_label);
-
-	// Dialog widgets
-	builder -> get_widget("sorry_dialog", sorry_dialog);
-	builder -> get_widget("how_to_play_dialog", how_to_play_dialog);
-	builder -> get_widget("congratulations_dialog", congratulations_dialog);
-
 
 
     /* Connect signals. sigc::ptr_fun() creates a slot/function object/functor.
      * Helps with compatibility
      */
+    started = trace_now();
 
 	// Window signals
 	// Callback to ensure that user data is saved and application is properly
@@ -816,68 +1681,6 @@ main(int argc, char **argv)
       sigc::bind<Glib::ustring>( sigc::ptr_fun(&restore_pointer), "how_to_play_button")
     );
 
-    // Must pause time while checking game. Dialog to resume?
-    done_button  -> signal_clicked().connect(   // Check if win on done
-      sigc::ptr_fun(&check_win)
-    );
-    done_button  -> signal_enter().connect(  // Cursor pointer
-      sigc::bind<Glib::ustring>( sigc::ptr_fun(&set_pointer), "done_button")
-    );
-    done_button  -> signal_leave().connect(  // Cursor normal
-      sigc::bind<Glib::ustring>( sigc::ptr_fun(&restore_pointer), "done_button")
-    );
-
-    got_it_button  -> signal_clicked().connect(  // Close instructions
-      sigc::ptr_fun(&close_instructions)
-    );
-    got_it_button  -> signal_enter().connect(  // Cursor pointer
-      sigc::bind<Glib::ustring>( sigc::ptr_fun(&set_pointer), "got_it_button")
-    );
-    got_it_button  -> signal_leave().connect(  // Cursor normal
-      sigc::bind<Glib::ustring>( sigc::ptr_fun(&restore_pointer), "got_it_button")
-    );
-
-    // Decision: Reset time or not?
-    reset_button  -> signal_clicked().connect(  // Clear all entries on reset
-      sigc::ptr_fun(&reset_board)
-    );
-    reset_button  -> signal_leave().connect(  // Cursor normal
-      sigc::bind<Glib::ustring>( sigc::ptr_fun(&restore_pointer), "reset_button")
-    );
-    reset_button  -> signal_enter().connect(  // Cursor clickable
-      sigc::bind<Glib::ustring>( sigc::ptr_fun(&set_pointer), "reset_button")
-    );
-
-    finish_later_button  -> signal_leave().connect(  // Cursor normal
-      sigc::bind<Glib::ustring>( sigc::ptr_fun(&restore_pointer), "finish_later_button")
-    );
-    finish_later_button  -> signal_enter().connect(  // Cursor clickable
-      sigc::bind<Glib::ustring>( sigc::ptr_fun(&set_pointer), "finish_later_button")
-    );
-	finish_later_button -> signal_clicked().connect(  // Save time and return to menu
-		sigc::bind<bool>( sigc::ptr_fun(&close_game), true)
-	);
-
-	continue_button  -> signal_leave().connect(  // Cursor normal
-      sigc::bind<Glib::ustring>( sigc::ptr_fun(&restore_pointer), "continue_button")
-    );
-    continue_button  -> signal_enter().connect(  // Cursor clickable
-      sigc::bind<Glib::ustring>( sigc::ptr_fun(&set_pointer), "continue_button")
-    );
-    continue_button -> signal_clicked().connect(  // Close 'almost there' dialog
-      sigc::ptr_fun(&close_sorry)
-    );
-    continue_button -> signal_clicked().connect(  // Start time when back to game
-      sigc::mem_fun(board, &Board::start)
-    );
-
-	hint_button  -> signal_leave().connect(  // Cursor normal
-      sigc::bind<Glib::ustring>( sigc::ptr_fun(&restore_pointer), "hint_button")
-    );
-    hint_button  -> signal_enter().connect(  // Cursor clickable
-      sigc::bind<Glib::ustring>( sigc::ptr_fun(&set_pointer), "hint_button")
-    );
-
 	lets_go_button -> signal_clicked().connect(  // After username, main menu
 		sigc::ptr_fun(&handle_user)
 	);
@@ -907,39 +1710,17 @@ main(int argc, char **argv)
 	switch_user_button -> signal_clicked().connect(  // Switch to player info page
 		sigc::bind<Glib::ustring>( sigc::ptr_fun(&switch_stack_page), "Player Info")
 	);
-	switch_user_button -> signal_clicked().connect(  // Reset board state & GUI
-		sigc::ptr_fun(&reset_all)
-	);
-
-	exit_button -> signal_enter().connect(  // Cursor clickable
-		sigc::bind<Glib::ustring>( sigc::ptr_fun(&set_pointer), "exit_button")
-	);
-	exit_button -> signal_leave().connect(  // Cursor normal
-		sigc::bind<Glib::ustring>( sigc::ptr_fun(&restore_pointer), "exit_button")
-	);
-	exit_button -> signal_clicked().connect(  // Exit button quits game
-		sigc::bind<Gtk::Window*>( sigc::ptr_fun(&quit_wrapper), window)
-	);
-
-	main_menu_button -> signal_enter().connect(  // Cursor clickable
-		sigc::bind<Glib::ustring>( sigc::ptr_fun(&set_pointer), "main_menu_button")
-	);
-	main_menu_button -> signal_leave().connect(  // Cursor normal
-		sigc::bind<Glib::ustring>( sigc::ptr_fun(&restore_pointer), "main_menu_button")
-	);
-	main_menu_button -> signal_clicked().connect(  // Go to main menu
-		sigc::bind<bool>( sigc::ptr_fun(&close_game), false)
-	);
 
-	winning_new_game_button -> signal_enter().connect(  // Cursor clickable
-		sigc::bind<Glib::ustring>( sigc::ptr_fun(&set_pointer), "winning_new_game_button")
+	library_button -> signal_enter().connect(  // Cursor clickable
+		sigc::bind<Glib::ustring>( sigc::ptr_fun(&set_pointer), "library_button")
 	);
-	winning_new_game_button -> signal_leave().connect(  // Cursor normal
-		sigc::bind<Glib::ustring>( sigc::ptr_fun(&restore_pointer), "winning_new_game_button")
+	library_button -> signal_leave().connect(  // Cursor normal
+		sigc::bind<Glib::ustring>( sigc::ptr_fun(&restore_pointer), "library_button")
 	);
-	winning_new_game_button -> signal_clicked().connect(
-		sigc::ptr_fun(&new_game)
+	library_button -> signal_clicked().connect(  // Browse the library
+		sigc::ptr_fun(&open_library)
 	);
+	if (library.size() > 0) library_button -> show();
 
 	// Entry signals
 	username_entry -> signal_activate().connect(
@@ -947,120 +1728,66 @@ main(int argc, char **argv)
 		sigc::ptr_fun(&handle_user)
 	);
 
-    /* CSS for styling
-     *
-     */
+    startup_phase("signals", started);
 
-    // Css provider from CSS file in res directory
+    /* CSS for styling. One provider for the whole screen, from the styles
+     * compiled into the executable
+     */
+    started = trace_now();
     auto css_provider = Gtk::CssProvider::create();
-    css_provider -> load_from_path("res/styles.css");
-
-    // Add stylesheet to buttons
-    begin_button -> get_style_context() ->
-        add_provider(css_provider, GTK_STYLE_PROVIDER_PRIORITY_USER);
-    how_to_play_button -> get_style_context() ->
-        add_provider(css_provider, GTK_STYLE_PROVIDER_PRIORITY_USER);
-    done_button -> get_style_context() ->
-        add_provider(css_provider, GTK_STYLE_PROVIDER_PRIORITY_USER);
-    finish_later_button -> get_style_context() ->
-        add_provider(css_provider, GTK_STYLE_PROVIDER_PRIORITY_USER);
-    reset_button -> get_style_context() ->
-        add_provider(css_provider, GTK_STYLE_PROVIDER_PRIORITY_USER);
-	lets_go_button -> get_style_context() ->
-		add_provider(css_provider, GTK_STYLE_PROVIDER_PRIORITY_USER);
-	new_game_button -> get_style_context() ->
-		add_provider(css_provider, GTK_STYLE_PROVIDER_PRIORITY_USER);
-	switch_user_button -> get_style_context() ->
-		add_provider(css_provider, GTK_STYLE_PROVIDER_PRIORITY_USER);
-	exit_button -> get_style_context() ->
-		add_provider(css_provider, GTK_STYLE_PROVIDER_PRIORITY_USER);
-	main_menu_button -> get_style_context() ->
-		add_provider(css_provider, GTK_STYLE_PROVIDER_PRIORITY_USER);
-	winning_new_game_button -> get_style_context() ->
-		add_provider(css_provider, GTK_STYLE_PROVIDER_PRIORITY_USER);
-	got_it_button -> get_style_context() ->
-		add_provider(css_provider, GTK_STYLE_PROVIDER_PRIORITY_USER);
-	hint_button -> get_style_context() ->
-		add_provider(css_provider, GTK_STYLE_PROVIDER_PRIORITY_USER);
-	continue_button -> get_style_context() ->
-		add_provider(css_provider, GTK_STYLE_PROVIDER_PRIORITY_USER);
-
-    // Add stylesheet to windows
-    window -> get_style_context() ->
-        add_provider(css_provider, GTK_STYLE_PROVIDER_PRIORITY_USER);
-
-    // Add stylesheet to grids
-    board_container_grid -> get_style_context() ->
-        add_provider(css_provider, GTK_STYLE_PROVIDER_PRIORITY_USER);
-	player_info_grid -> get_style_context() ->
-        add_provider(css_provider, GTK_STYLE_PROVIDER_PRIORITY_USER);
-	menu_grid -> get_style_context() ->
-        add_provider(css_provider, GTK_STYLE_PROVIDER_PRIORITY_USER);
-
-	// Add stylesheet to boxes
-	menu_screen_box -> get_style_context() ->
-        add_provider(css_provider, GTK_STYLE_PROVIDER_PRIORITY_USER);
-	username_entry_box -> get_style_context() ->
-        add_provider(css_provider, GTK_STYLE_PROVIDER_PRIORITY_USER);
-	button_box_box -> get_style_context() ->
-        add_provider(css_provider, GTK_STYLE_PROVIDER_PRIORITY_USER);
-
-	// Add stylesheet to stacks
-	application_stack -> get_style_context() ->
-        add_provider(css_provider, GTK_STYLE_PROVIDER_PRIORITY_USER);
-
-	// Add stylesheet to labels
-	welcome_label -> get_style_context() ->
-        add_provider(css_provider, GTK_STYLE_PROVIDER_PRIORITY_USER);
-	game_title_label -> get_style_context() ->
-        add_provider(css_provider, GTK_STYLE_PROVIDER_PRIORITY_USER);
-	source_code_label -> get_style_context() ->
-        add_provider(css_provider, GTK_STYLE_PROVIDER_PRIORITY_USER);
-	username_label -> get_style_context() ->
-        add_provider(css_provider, GTK_STYLE_PROVIDER_PRIORITY_USER);
-	player_info_title_label -> get_style_context() ->
-        add_provider(css_provider, GTK_STYLE_PROVIDER_PRIORITY_USER);
-	current_time_header_label -> get_style_context() ->
-        add_provider(css_provider, GTK_STYLE_PROVIDER_PRIORITY_USER);
-	current_time_time_label -> get_style_context() ->
-        add_provider(css_provider, GTK_STYLE_PROVIDER_PRIORITY_USER);
-	fastest_time_header_label -> get_style_context() ->
-        add_provider(css_provider, GTK_STYLE_PROVIDER_PRIORITY_USER);
-	fastest_time_time_label -> get_style_context() ->
-        add_provider(css_provider, GTK_STYLE_PROVIDER_PRIORITY_USER);
-	note_label -> get_style_context() ->
-        add_provider(css_provider, GTK_STYLE_PROVIDER_PRIORITY_USER);
-	you_won_label -> get_style_context() ->
-		add_provider(css_provider, GTK_STYLE_PROVIDER_PRIORITY_USER);
-	you_won_info_label -> get_style_context() ->
-		add_provider(css_provider, GTK_STYLE_PROVIDER_PRIORITY_USER);
-	almost_there_label -> get_style_context() ->
-		add_provider(css_provider, GTK_STYLE_PROVIDER_PRIORITY_USER);
-	almost_there_info_label -> get_style_context() ->
-		add_provider(css_provider, GTK_STYLE_PROVIDER_PRIORITY_USER);
-	instructions_label -> get_style_context() ->
-		add_provider(css_provider, GTK_STYLE_PROVIDER_PRIORITY_USER);
-
-	// Add stylesheet to dialogs
-	sorry_dialog -> get_style_context() ->
-	   add_provider(css_provider, GTK_STYLE_PROVIDER_PRIORITY_USER);
-	congratulations_dialog -> get_style_context() ->
-         add_provider(css_provider, GTK_STYLE_PROVIDER_PRIORITY_USER);
-	how_to_play_dialog -> get_style_context() ->
-        add_provider(css_provider, GTK_STYLE_PROVIDER_PRIORITY_USER);
-
+    css_provider -> load_from_resource(RESOURCE_PREFIX "styles.css");
+    Gtk::StyleContext::add_provider_for_screen(Gdk::Screen::get_default(), css_provider,
+      GTK_STYLE_PROVIDER_PRIORITY_USER);
+    startup_phase("styles.css", started);
 
 	gtk_widget_set_events(GTK_WIDGET(window->gobj()), GDK_BUTTON_PRESS_MASK);
 
-    /* Initial setup
-     *
-     */
-	 initialize_board();
+	if (getenv("SUDOKU_STARTUP") || trace_enabled()) time_startup(window);
+
+	// Keypress to paint latency, reported on exit and shown live for "overlay"
+	if (getenv("SUDOKU_LATENCY")) {
+		watch_frames(window);
+
+		// The label is shown once the game board is built
+		if (strcmp(getenv("SUDOKU_LATENCY"), "overlay") == 0) keypress_latency.overlay = true;
+	}
 
     if (window) {
 		app -> run(*window);
 	}
 
+	// A race puzzle still being made is not worth cancelling
+	if (race.maker.joinable()) {
+		race.maker.join();
+		delete race.made;
+	}
+
+	// An index still being built is given up on, and built again next time
+	if (library_index.worker.joinable()) {
+		library_index.cancel = true;
+		library_index.worker.join();
+		delete library_index.ready;
+	}
+
+	// Saves still waiting to be merged are written before exiting
+	flush_autosave();
+	shared_saver().flush();
+	if (getenv("SUDOKU_SAVE_STATS")) printf("%s", shared_saver().report().c_str());
+
+	trace_flush();  // Writes the SUDOKU_TRACE file, if any
+
+	if (getenv("SUDOKU_LATENCY")) {
+		fprintf(stderr, "%s", keypress_latency.histogram.report().c_str());
+	}
+
+	// Report how well the analysis cache did this session
+	if (getenv("SUDOKU_CACHE_STATS")) {
+		CacheStats stats = shared_cache().get_stats();
+		printf("Analysis cache: %ld memory hits, %ld disk hits, %ld misses, %ld evictions (%.0f%% hit rate)\n",
+			stats.memory_hits, stats.disk_hits, stats.misses, stats.evictions,
+			shared_cache().hit_rate() * 100);
+	}
+
     delete window;
 
     return 0;
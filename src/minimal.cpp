@@ -0,0 +1,393 @@
+/* Last Modified: 10/19/26
+ * Author: Alex Eastman
+ * Contact: alexeast@buffalo.edu
+ * Summary: Definitions for function prototypes found in minimal.h . See
+ *          minimal.h for explanation of functions
+ */
+
+
+#include "minimal.h"
+#include "solver.h"
+#include "generator.h"
+#include "saver.h"
+#include "trace.h"
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <stdlib.h>
+
+namespace {
+
+// Searches cut into tasks this many clues deep. Fixed rather than scaled to
+// the threads, so that a checkpoint means the same tasks on any machine.
+const int task_depth = 4;
+
+bool intersects (const CellSet& a, const CellSet& b)
+{
+	return ((a.low & b.low) | (a.high & b.high)) != 0;
+}
+
+bool contains (const CellSet& outer, const CellSet& inner)
+{
+	return (inner.low & ~outer.low) == 0 && (inner.high & ~outer.high) == 0;
+}
+
+CellSet with_cell (CellSet set, int cell)
+{
+	if (cell < 64) set.low |= (uint64_t) 1 << cell;
+	else set.high |= (uint64_t) 1 << (cell - 64);
+	return set;
+}
+
+CellSet minus (const CellSet& a, const CellSet& b)
+{
+	return CellSet{a.low & ~b.low, a.high & ~b.high};
+}
+
+int set_size (const CellSet& set)
+{
+	return __builtin_popcountll(set.low) + __builtin_popcountll(set.high);
+}
+
+// Smallest first, then by cells so the order is always the same
+bool smaller (const CellSet& a, const CellSet& b)
+{
+	int size_a = set_size(a), size_b = set_size(b);
+	if (size_a != size_b) return size_a < size_b;
+	if (a.low != b.low) return a.low < b.low;
+	return a.high < b.high;
+}
+
+// The cells where two grids differ
+CellSet difference (const Grid& a, const Grid& b)
+{
+	CellSet set = {0, 0};
+	int i;
+	for (i=0; i<81; i++) {
+		if (a.cells[i] != b.cells[i]) set = with_cell(set, i);
+	}
+	return set;
+}
+
+Grid puzzle_of (const Grid& solution, const CellSet& clues)
+{
+	Grid puzzle = empty_grid();
+	int i;
+	for (i=0; i<81; i++) {
+		if (in_cell_set(clues, i)) puzzle.cells[i] = solution.cells[i];
+	}
+	return puzzle;
+}
+
+// A node of the search: the clues chosen, the cells that may no longer be
+// chosen, and how many clues there are
+struct Node {
+	CellSet chosen;
+	CellSet dead;
+	int count;
+};
+
+/* A depth first search for sets of clues that hit every unavoidable set.
+ * Each thread has its own, since it adds the sets it learns to its list.
+ */
+struct HittingSearch {
+	const Grid& solution;
+	int clues;
+	std::vector<CellSet> sets;
+
+	// Where to put puzzles found. When split is set, nodes split_at deep are
+	// added to it instead of being searched.
+	std::vector<Grid>* found;
+	std::vector<Node>* split;
+	int split_at;
+
+	void search (const CellSet& chosen, CellSet dead, int count)
+	{
+		if (count > clues) return;  // Only a base can have too many
+		if (split && count == split_at) {
+			split->push_back(Node{chosen, dead, count});
+			return;
+		}
+
+		// Finds the unhit set with the fewest cells left to choose. Unhit sets
+		// with no cells in common each need a clue of their own, which bounds
+		// how many more clues are needed from below.
+		CellSet best = {0, 0};
+		int best_size = 82;
+		CellSet used = {0, 0};
+		int disjoint = 0;
+
+		for (const CellSet& set : sets) {
+			if (intersects(set, chosen)) continue;
+
+			CellSet open = minus(set, dead);
+			int size = set_size(open);
+			if (size == 0) return;  // Can't be hit any more
+
+			if (size < best_size) {
+				best = open;
+				best_size = size;
+			}
+			if (!intersects(open, used)) {
+				used.low |= open.low;
+				used.high |= open.high;
+				if (++disjoint > clues - count) return;
+			}
+		}
+
+		// Every known set is hit, which is needed but not enough
+		if (best_size > 81) {
+			if (split) {
+				split->push_back(Node{chosen, dead, count});
+				return;
+			}
+
+			Grid puzzle = puzzle_of(solution, chosen);
+			std::vector<Grid> solutions;
+			list_solutions(puzzle, 2, solutions);
+			if (solutions.size() == 1) {
+				// Clues are chosen to hit sets, not to be needed, so one of
+				// them may not be. Any superset is unique too, and so not
+				// minimal, so the search can stop here either way.
+				if (is_minimal(puzzle, 1)) found->push_back(puzzle);
+				return;
+			}
+
+			// The cells where the other solution differs are a set no clue
+			// hits yet, so the next clue must be one of them. Only small ones
+			// are kept for later, since every node looks at every set kept.
+			const Grid& other = grid_equal(solutions[0], solution) ? solutions[1] : solutions[0];
+			CellSet learned = difference(solution, other);
+			if (set_size(learned) <= MAX_UNAVOIDABLE_SIZE) {
+				sets.insert(std::upper_bound(sets.begin(), sets.end(), learned, smaller), learned);
+				TRACE_COUNTER("minimal_sets_learned", 1);
+			}
+
+			if (count == clues) return;
+			best = minus(learned, dead);
+		}
+
+		int cell;
+		for (cell=0; cell<81; cell++) {
+			if (!in_cell_set(best, cell)) continue;
+			search(with_cell(chosen, cell), dead, count + 1);
+			dead = with_cell(dead, cell);
+		}
+		return;
+	}
+};
+
+}
+
+std::vector<CellSet> find_unavoidable_sets (const Grid& solution)
+{
+	TRACE_SCOPE("find_unavoidable_sets");
+
+	std::vector<CellSet> found;
+	std::vector<Grid> solutions;
+
+	// Each group of 2 to 4 digits, as a mask of the digits
+	int digits;
+	for (digits=0; digits<(1 << 9); digits++) {
+		int size = __builtin_popcount(digits);
+		if (size < 2 || size > 4) continue;
+
+		Grid puzzle = solution;
+		int i;
+		for (i=0; i<81; i++) {
+			if (digits & (1 << (solution.cells[i] - 1))) puzzle.cells[i] = 0;
+		}
+
+		solutions.clear();
+		list_solutions(puzzle, UNAVOIDABLE_SOLUTION_LIMIT, solutions);
+		for (const Grid& other : solutions) {
+			if (grid_equal(other, solution)) continue;
+			CellSet set = difference(solution, other);
+			if (set_size(set) <= MAX_UNAVOIDABLE_SIZE) found.push_back(set);
+		}
+	}
+
+	std::sort(found.begin(), found.end(), smaller);
+
+	// Smallest first, so a set is kept only if no kept set is inside it
+	std::vector<CellSet> sets;
+	for (const CellSet& set : found) {
+		bool superset = false;
+		for (const CellSet& kept : sets) {
+			if (contains(set, kept)) {
+				superset = true;
+				break;
+			}
+		}
+		if (!superset) sets.push_back(set);
+	}
+
+	return sets;
+}
+
+MinimalSearch::MinimalSearch (const Grid& solution, int clues, const std::string& checkpoint) :
+  MinimalSearch(solution, empty_grid(), clues, checkpoint)
+{
+}
+
+MinimalSearch::MinimalSearch (const Grid& solution, const Grid& base, int clues,
+  const std::string& checkpoint)
+{
+	this->solution = solution;
+	this->base = base;
+	this->clues = std::min(clues, MAX_SEARCH_CLUES);
+	this->checkpoint = checkpoint;
+	started = false;
+
+	sets = find_unavoidable_sets(solution);
+	make_tasks(task_depth);
+	finished.assign(tasks.size(), 0);
+}
+
+void MinimalSearch::make_tasks (int depth)
+{
+	CellSet given = {0, 0};
+	int i;
+	for (i=0; i<81; i++) {
+		if (base.cells[i] != 0) given = with_cell(given, i);
+	}
+	int count = set_size(given);
+
+	std::vector<Node> nodes;
+	HittingSearch splitter = {solution, clues, sets, nullptr, &nodes, count + depth};
+	splitter.search(given, CellSet{0, 0}, count);
+
+	tasks.clear();
+	for (const Node& node : nodes) tasks.push_back(Task{node.chosen, node.dead, node.count});
+	return;
+}
+
+std::string MinimalSearch::checkpoint_header (void)
+{
+	// The base is left out when there is none, as before it could be given
+	std::ostringstream header;
+	header << "minimal " << grid_to_string(solution);
+	if (count_givens(base) > 0) header << " " << grid_to_string(base);
+	header << " " << clues << " " << tasks.size() << "\n";
+	return header.str();
+}
+
+bool MinimalSearch::resume (void)
+{
+	if (checkpoint.empty()) return true;
+
+	std::ifstream file(checkpoint);
+	if (!file) return true;  // Nothing to resume
+
+	std::stringstream contents;
+	contents << file.rdbuf();
+	if (file.bad()) return false;
+	std::string text = contents.str();
+	if (text.empty()) return true;
+
+	std::string header = checkpoint_header();
+	if (text.compare(0, header.size(), header) != 0) return false;
+	started = true;
+
+	// Puzzles only count once the line for their task follows, so a record
+	// cut short by a crash is searched again
+	std::vector<Grid> pending;
+	size_t start = header.size();
+	size_t kept = start;
+	size_t end;
+	while ((end = text.find('\n', start)) != std::string::npos) {
+		std::string line = text.substr(start, end - start);
+		start = end + 1;
+
+		Grid puzzle;
+		if (line.compare(0, 2, "P ") == 0 && grid_from_string(line.substr(2), puzzle)) {
+			pending.push_back(puzzle);
+		} else if (line.compare(0, 2, "T ") == 0) {
+			int index = atoi(line.c_str() + 2);
+			if (index < 0 || index >= (int) tasks.size()) return false;
+			if (!finished[index]) resumed.insert(resumed.end(), pending.begin(), pending.end());
+			finished[index] = 1;
+			pending.clear();
+			kept = start;
+		} else {
+			return false;
+		}
+	}
+
+	// Drops the cut short record, so records added later start on a line of
+	// their own
+	if (kept < text.size() && !write_file_atomically(checkpoint, text.substr(0, kept))) return false;
+
+	return true;
+}
+
+bool MinimalSearch::run (int threads, const std::function<void(const Grid&)>& found,
+  const std::function<void(void)>& task_finished)
+{
+	TRACE_SCOPE("minimal_search");
+
+	for (const Grid& puzzle : resumed) found(puzzle);
+	resumed.clear();
+
+	bool written = true;
+	std::mutex lock;
+
+	if (!checkpoint.empty() && !started) {
+		if (!write_file_atomically(checkpoint, checkpoint_header())) return false;
+		started = true;
+	}
+
+	std::atomic<int> next(0);
+	auto worker = [&]() {
+		std::vector<Grid> puzzles;
+		HittingSearch search = {solution, clues, sets, &puzzles, nullptr, 0};
+
+		int i;
+		while ((i = next.fetch_add(1)) < (int) tasks.size()) {
+			if (finished[i]) continue;
+
+			puzzles.clear();
+			search.search(tasks[i].clues_set, tasks[i].dead, tasks[i].count);
+
+			std::lock_guard<std::mutex> guard(lock);
+			std::string record;
+			for (const Grid& puzzle : puzzles) {
+				found(puzzle);
+				record += "P " + grid_to_string(puzzle) + "\n";
+			}
+			record += "T " + std::to_string(i) + "\n";
+			if (!checkpoint.empty() && !append_to_file(checkpoint, record)) written = false;
+			finished[i] = 1;
+			if (task_finished) task_finished();
+		}
+	};
+
+	if (threads <= 0) threads = std::thread::hardware_concurrency();
+	if (threads <= 0) threads = 1;
+
+	std::vector<std::thread> workers;
+	int i;
+	for (i=1; i<std::min(threads, (int) tasks.size()); i++) workers.push_back(std::thread(worker));
+	worker();
+	for (auto& t : workers) t.join();
+
+	return written;
+}
+
+int MinimalSearch::task_count (void)
+{
+	return tasks.size();
+}
+
+int MinimalSearch::finished_count (void)
+{
+	return std::count(finished.begin(), finished.end(), 1);
+}
+
+int MinimalSearch::set_count (void)
+{
+	return sets.size();
+}
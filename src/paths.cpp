@@ -0,0 +1,49 @@
+/* Last Modified: 10/19/26
+ * Author: Alex Eastman
+ * Contact: alexeast@buffalo.edu
+ * Summary: Definitions for function prototypes found in paths.h . See paths.h
+ *          for explanation of functions
+ */
+
+
+#include "paths.h"
+#include <stdlib.h>
+#include <sys/stat.h>
+
+namespace {
+
+// Creates directory and any missing parents. Existing ones are left alone.
+void make_directories (const std::string& directory)
+{
+	size_t slash;
+	for (slash=directory.find('/', 1); slash!=std::string::npos; slash=directory.find('/', slash + 1)) {
+		mkdir(directory.substr(0, slash).c_str(), 0755);
+	}
+	mkdir(directory.c_str(), 0755);
+	return;
+}
+
+std::string find_data_directory (void)
+{
+	if (getenv("SUDOKU_DATA_DIR")) return getenv("SUDOKU_DATA_DIR");
+	if (getenv("XDG_DATA_HOME")) return std::string(getenv("XDG_DATA_HOME")) + "/sudoku";
+	if (getenv("HOME")) return std::string(getenv("HOME")) + "/.local/share/sudoku";
+	return "data";  // Nowhere better, so fall back on the working directory
+}
+
+}
+
+std::string data_directory (void)
+{
+	static const std::string directory = [] {
+		std::string found = find_data_directory();
+		make_directories(found);
+		return found;
+	}();
+	return directory;
+}
+
+std::string data_path (const std::string& name)
+{
+	return data_directory() + "/" + name;
+}
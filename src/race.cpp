@@ -0,0 +1,506 @@
+/* Last Modified: 10/19/26
+ * Author: Alex Eastman
+ * Contact: alexeast@buffalo.edu
+ * Summary: Definitions for function prototypes found in race.h . See
+ *          race.h for explanation of functions
+ */
+
+
+#include "race.h"
+#include "generator.h"
+#include "variants.h"
+#include "random.h"
+#include "trace.h"
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+namespace {
+
+// How long run waits on the sockets at a time, so it notices stop
+const int poll_interval = 100;
+
+std::vector<std::string> split_words (const std::string& line)
+{
+	std::vector<std::string> words;
+	std::istringstream in(line);
+	std::string word;
+	while (in >> word) words.push_back(word);
+	return words;
+}
+
+// Messages are short and each one matters as soon as it is sent
+void set_nodelay (int fd)
+{
+	int on = 1;
+	setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+	return;
+}
+
+// Sends as much of output as the socket takes. Returns false if the other
+// end has gone.
+bool flush_output (int fd, std::string& output)
+{
+	while (!output.empty()) {
+		ssize_t sent = send(fd, output.data(), output.size(), MSG_NOSIGNAL);
+		if (sent < 0) return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+		output.erase(0, sent);
+	}
+	return true;
+}
+
+// Reads what has arrived onto input and moves each whole line to lines.
+// Returns false if the other end has gone or sent too long a line.
+bool read_lines (int fd, std::string& input, std::vector<std::string>& lines)
+{
+	char buffer[4096];
+	bool open = true;
+	while (true) {
+		ssize_t got = recv(fd, buffer, sizeof(buffer), 0);
+		if (got > 0) {
+			input.append(buffer, got);
+			continue;
+		}
+		if (got == 0) open = false;
+		else if (errno == EINTR) continue;
+		else if (errno != EAGAIN && errno != EWOULDBLOCK) open = false;
+		break;
+	}
+
+	size_t end;
+	while ((end = input.find('\n')) != std::string::npos) {
+		std::string line = input.substr(0, end);
+		if (!line.empty() && line.back() == '\r') line.pop_back();
+		lines.push_back(line);
+		input.erase(0, end + 1);
+	}
+
+	return open && input.size() <= RACE_MAX_LINE;
+}
+
+}
+
+long race_clock (void)
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(
+	  std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+bool race_puzzle (const std::string& id, Grid& puzzle, Grid& solution)
+{
+	int variant, symmetry;
+	uint64_t seed;
+	if (!parse_puzzle_id(id, variant, symmetry, seed) || variant != VARIANT_CLASSIC) return false;
+
+	// Any number of threads makes the same puzzle from the same seed
+	Random random(seed);
+	puzzle = generate_puzzle(symmetry, 1, &solution, random);
+	return true;
+}
+
+RaceHost::RaceHost (const std::string& id) : stopping(false)
+{
+	Grid puzzle, full;
+	puzzle_id = id;
+	while (!race_puzzle(puzzle_id, puzzle, full)) {
+		puzzle_id = make_puzzle_id(VARIANT_CLASSIC, SYMMETRY_ROTATIONAL, fresh_seed());
+	}
+
+	solution = pack_grid(full);
+	listener = -1;
+	start_time = 0;
+}
+
+RaceHost::~RaceHost (void)
+{
+	for (Player& player : players) ::close(player.fd);
+	if (listener >= 0) ::close(listener);
+}
+
+bool RaceHost::listen (int port, bool lan)
+{
+	int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (fd < 0) return false;
+
+	int on = 1;
+	setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+	sockaddr_in address;
+	memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_port = htons(port);
+	address.sin_addr.s_addr = htonl(lan ? INADDR_ANY : INADDR_LOOPBACK);
+
+	if (bind(fd, (sockaddr*) &address, sizeof(address)) != 0 || ::listen(fd, SOMAXCONN) != 0) {
+		::close(fd);
+		return false;
+	}
+
+	if (listener >= 0) ::close(listener);
+	listener = fd;
+	return true;
+}
+
+int RaceHost::get_port (void)
+{
+	sockaddr_in address;
+	socklen_t length = sizeof(address);
+	if (listener < 0 || getsockname(listener, (sockaddr*) &address, &length) != 0) return 0;
+	return ntohs(address.sin_port);
+}
+
+std::string RaceHost::get_puzzle_id (void)
+{
+	return puzzle_id;
+}
+
+std::vector<RaceResult> RaceHost::get_results (void)
+{
+	return results;
+}
+
+void RaceHost::stop (void)
+{
+	stopping = true;
+	return;
+}
+
+int RaceHost::joined_count (void)
+{
+	int count = 0;
+	for (const Player& player : players) {
+		if (!player.name.empty() && !player.closed) count++;
+	}
+	return count;
+}
+
+int RaceHost::synced_count (void)
+{
+	int count = 0;
+	for (const Player& player : players) {
+		if (!player.name.empty() && !player.closed && player.syncs >= RACE_SYNC_ROUNDS) count++;
+	}
+	return count;
+}
+
+bool RaceHost::run (int count, int countdown)
+{
+	TRACE_SCOPE("RaceHost::run");
+
+	std::vector<pollfd> fds;
+	while (!stopping) {
+		// Everyone still measuring their clock would turn START into their
+		// own clock with a worse offset
+		int joined = joined_count();
+		if (start_time == 0 && joined >= count && synced_count() == joined) {
+			start_time = race_clock() + countdown * 1000L;
+			broadcast("START " + std::to_string(start_time));
+		}
+
+		// Over once nobody is left racing
+		if (start_time != 0) {
+			bool racing = false;
+			for (const Player& player : players) {
+				if (!player.name.empty() && !player.closed && !player.finished) racing = true;
+			}
+			if (!racing) break;
+		}
+
+		fds.clear();
+		fds.push_back({listener, POLLIN, 0});
+		for (const Player& player : players) {
+			fds.push_back({player.fd, (short) (POLLIN | (player.output.empty() ? 0 : POLLOUT)), 0});
+		}
+
+		if (poll(fds.data(), fds.size(), poll_interval) < 0 && errno != EINTR) break;
+
+		// Players first, since accepting adds to the list
+		int i;
+		for (i=1; i<(int) fds.size(); i++) {
+			Player& player = players[i - 1];
+			if (fds[i].revents & (POLLIN | POLLHUP | POLLERR)) read_player(player);
+			if (!player.closed && (fds[i].revents & POLLOUT) && !flush_output(player.fd, player.output)) {
+				player.closed = true;
+			}
+		}
+
+		for (i=(int) players.size() - 1; i>=0; i--) {
+			if (!players[i].closed) continue;
+			::close(players[i].fd);
+			players.erase(players.begin() + i);
+		}
+
+		if (fds[0].revents & POLLIN) accept_players();
+	}
+
+	for (Player& player : players) ::close(player.fd);
+	players.clear();
+	::close(listener);
+	listener = -1;
+
+	return start_time != 0;
+}
+
+void RaceHost::accept_players (void)
+{
+	while (true) {
+		int fd = accept4(listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+		if (fd < 0) return;
+
+		set_nodelay(fd);
+		players.push_back(Player{fd, "", "", "", 0, false, false});
+	}
+}
+
+void RaceHost::read_player (Player& player)
+{
+	std::vector<std::string> lines;
+	if (!read_lines(player.fd, player.input, lines)) player.closed = true;
+
+	for (const std::string& line : lines) {
+		if (player.closed) break;
+		handle(player, line);
+	}
+	return;
+}
+
+void RaceHost::send_line (Player& player, const std::string& line)
+{
+	if (player.closed) return;
+
+	player.output += line + "\n";
+	if (!flush_output(player.fd, player.output)) player.closed = true;
+	return;
+}
+
+void RaceHost::broadcast (const std::string& line)
+{
+	for (Player& player : players) {
+		if (!player.name.empty()) send_line(player, line);
+	}
+	return;
+}
+
+void RaceHost::handle (Player& player, const std::string& line)
+{
+	std::vector<std::string> words = split_words(line);
+	if (words.empty()) return;
+
+	std::string command = words[0];
+	for (char& c : command) c = toupper(c);
+
+	if (command == "SYNC" && words.size() == 2) {
+		send_line(player, "SYNC " + words[1] + " " + std::to_string(race_clock()));
+		player.syncs++;
+
+	} else if (command == "JOIN" && words.size() == 2) {
+		if (!player.name.empty()) return send_line(player, "ERR already joined");
+		if (start_time != 0) return send_line(player, "ERR the race has started");
+		for (const Player& other : players) {
+			if (other.name == words[1]) return send_line(player, "ERR name taken");
+		}
+
+		// The newcomer hears who is already in, then everyone hears of them
+		send_line(player, "WELCOME " + puzzle_id);
+		for (const Player& other : players) {
+			if (!other.name.empty()) send_line(player, "PLAYER " + other.name);
+		}
+		player.name = words[1];
+		broadcast("PLAYER " + player.name);
+
+	} else if (player.name.empty()) {
+		send_line(player, "ERR join first");
+
+	} else if (command == "PROGRESS" && words.size() == 2) {
+		int filled = std::max(0, std::min(81, atoi(words[1].c_str())));
+		broadcast("PROGRESS " + player.name + " " + std::to_string(filled));
+
+	} else if (command == "DONE" && words.size() == 2) {
+		if (start_time == 0 || race_clock() < start_time) return send_line(player, "ERR the race has not started");
+		if (player.finished) return send_line(player, "ERR already finished");
+
+		Grid board;
+		if (!grid_from_string(words[1], board)) return send_line(player, "ERR not a grid");
+
+		PackedGrid entries = pack_grid(board);
+		CellSet wrong = wrong_cells(entries, solution);
+		CellSet empty = empty_cells(entries);
+		if ((wrong.low | wrong.high | empty.low | empty.high) != 0) return send_line(player, "WRONG");
+
+		player.finished = true;
+		RaceResult result = {player.name, (race_clock() - start_time) / 1000, (int) results.size() + 1};
+		results.push_back(result);
+		broadcast("FINISHED " + result.name + " " + std::to_string(result.milliseconds) + " " +
+		  std::to_string(result.place));
+
+	} else {
+		send_line(player, "ERR unknown message");
+	}
+
+	return;
+}
+
+RaceClient::RaceClient (void)
+{
+	fd = -1;
+	offset = 0;
+	best_round_trip = -1;
+	syncs_left = 0;
+	sent_filled = -1;
+}
+
+RaceClient::~RaceClient (void)
+{
+	if (fd >= 0) ::close(fd);
+}
+
+bool RaceClient::join (const std::string& host, int port, const std::string& name)
+{
+	addrinfo hints;
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+
+	addrinfo* found;
+	if (getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &found) != 0) return false;
+
+	addrinfo* address;
+	for (address=found; address!=nullptr; address=address->ai_next) {
+		fd = socket(address->ai_family, address->ai_socktype | SOCK_CLOEXEC, address->ai_protocol);
+		if (fd < 0) continue;
+		if (connect(fd, address->ai_addr, address->ai_addrlen) == 0) break;
+		::close(fd);
+		fd = -1;
+	}
+	freeaddrinfo(found);
+	if (fd < 0) return false;
+
+	// Connected, so nothing needs to wait from here on
+	set_nodelay(fd);
+	fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+	send_line("JOIN " + name);
+	syncs_left = RACE_SYNC_ROUNDS - 1;
+	send_line("SYNC " + std::to_string(race_clock()));
+	return fd >= 0;
+}
+
+int RaceClient::get_fd (void)
+{
+	return fd;
+}
+
+std::string RaceClient::get_puzzle_id (void)
+{
+	return puzzle_id;
+}
+
+void RaceClient::send_line (const std::string& line)
+{
+	if (fd < 0) return;
+
+	output += line + "\n";
+	if (!flush_output(fd, output)) {
+		::close(fd);
+		fd = -1;
+	}
+	return;
+}
+
+void RaceClient::send_progress (int filled)
+{
+	if (filled == sent_filled) return;
+
+	sent_filled = filled;
+	send_line("PROGRESS " + std::to_string(filled));
+	return;
+}
+
+void RaceClient::send_done (const Grid& board)
+{
+	send_line("DONE " + grid_to_string(board));
+	return;
+}
+
+bool RaceClient::receive (std::vector<RaceEvent>& events)
+{
+	if (fd < 0) return false;
+
+	bool open = flush_output(fd, output);
+
+	std::vector<std::string> lines;
+	if (!read_lines(fd, input, lines)) open = false;
+	for (const std::string& line : lines) handle(line, events);
+
+	if (!open) {
+		::close(fd);
+		fd = -1;
+	}
+	return open;
+}
+
+bool RaceClient::wait (std::vector<RaceEvent>& events, int timeout)
+{
+	if (fd < 0) return false;
+
+	pollfd waiting = {fd, (short) (POLLIN | (output.empty() ? 0 : POLLOUT)), 0};
+	poll(&waiting, 1, timeout);
+	return receive(events);
+}
+
+void RaceClient::handle (const std::string& line, std::vector<RaceEvent>& events)
+{
+	std::vector<std::string> words = split_words(line);
+	if (words.empty()) return;
+
+	const std::string& command = words[0];
+	if (command == "SYNC" && words.size() == 3) {
+		// The host read its clock about halfway through the round trip
+		long sent = atol(words[1].c_str());
+		long round_trip = race_clock() - sent;
+		if (best_round_trip < 0 || round_trip < best_round_trip) {
+			best_round_trip = round_trip;
+			offset = atol(words[2].c_str()) - (sent + round_trip / 2);
+		}
+		if (syncs_left > 0) {
+			syncs_left--;
+			send_line("SYNC " + std::to_string(race_clock()));
+		}
+
+	} else if (command == "WELCOME" && words.size() == 2) {
+		puzzle_id = words[1];
+		events.push_back({RACE_WELCOME, puzzle_id, 0, 0});
+
+	} else if (command == "PLAYER" && words.size() == 2) {
+		events.push_back({RACE_PLAYER, words[1], 0, 0});
+
+	} else if (command == "START" && words.size() == 2) {
+		events.push_back({RACE_START, "", atol(words[1].c_str()) - offset, 0});
+
+	} else if (command == "PROGRESS" && words.size() == 3) {
+		events.push_back({RACE_PROGRESS, words[1], atol(words[2].c_str()), 0});
+
+	} else if (command == "FINISHED" && words.size() == 4) {
+		events.push_back({RACE_FINISHED, words[1], atol(words[2].c_str()), atoi(words[3].c_str())});
+
+	} else if (command == "WRONG") {
+		events.push_back({RACE_WRONG, "", 0, 0});
+
+	} else if (command == "ERR") {
+		events.push_back({RACE_ERROR, line.size() > 4 ? line.substr(4) : "", 0, 0});
+	}
+
+	return;
+}
@@ -0,0 +1,145 @@
+/* Last Modified: 10/19/26
+ * Author: Alex Eastman
+ * Contact: alexeast@buffalo.edu
+ * Summary: Definitions for function prototypes found in random.h . See
+ *          random.h for explanation of functions
+ */
+
+
+#include "random.h"
+#include <chrono>
+#include <random>
+#include <ctype.h>
+
+namespace {
+
+const char id_digits[] = "0123456789ABCDEFGHJKMNPQRSTVWXYZ";
+
+inline uint64_t rotate_left (uint64_t x, int k)
+{
+	return (x << k) | (x >> (64 - k));
+}
+
+// Spreads one 64 bit seed over the state, as the xoshiro authors recommend
+uint64_t splitmix64 (uint64_t& x)
+{
+	uint64_t z = (x += 0x9e3779b97f4a7c15ULL);
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+	return z ^ (z >> 31);
+}
+
+}
+
+Random::Random (uint64_t seed)
+{
+	int i;
+	for (i=0; i<4; i++) state[i] = splitmix64(seed);
+}
+
+uint64_t Random::next (void)
+{
+	uint64_t result = rotate_left(state[1] * 5, 7) * 9;
+	uint64_t t = state[1] << 17;
+
+	state[2] ^= state[0];
+	state[3] ^= state[1];
+	state[1] ^= state[2];
+	state[0] ^= state[3];
+	state[2] ^= t;
+	state[3] = rotate_left(state[3], 45);
+
+	return result;
+}
+
+int Random::below (int bound)
+{
+	// Lemire's method: scale 32 random bits up to bound, and throw away the
+	// few results that would make low numbers more likely
+	uint32_t range = bound;
+	uint64_t product = (next() >> 32) * range;
+	uint32_t low = (uint32_t) product;
+
+	if (low < range) {
+		uint32_t threshold = -range % range;
+		while (low < threshold) {
+			product = (next() >> 32) * range;
+			low = (uint32_t) product;
+		}
+	}
+
+	return product >> 32;
+}
+
+void Random::jump (void)
+{
+	static const uint64_t polynomial[4] = {
+		0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL, 0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL
+	};
+
+	uint64_t jumped[4] = {0, 0, 0, 0};
+
+	int i, bit;
+	for (i=0; i<4; i++) {
+		for (bit=0; bit<64; bit++) {
+			if (polynomial[i] & (1ULL << bit)) {
+				jumped[0] ^= state[0];
+				jumped[1] ^= state[1];
+				jumped[2] ^= state[2];
+				jumped[3] ^= state[3];
+			}
+			next();
+		}
+	}
+
+	for (i=0; i<4; i++) state[i] = jumped[i];
+	return;
+}
+
+uint64_t fresh_seed (void)
+{
+	std::random_device device;
+	uint64_t seed = ((uint64_t) device() << 32) | device();
+
+	// Some systems have no entropy source and repeat, so mix in the clock
+	uint64_t now = std::chrono::high_resolution_clock::now().time_since_epoch().count();
+	return seed ^ splitmix64(now);
+}
+
+std::string seed_to_id (uint64_t seed)
+{
+	std::string id(SEED_ID_LENGTH, '0');
+
+	int i;
+	for (i=SEED_ID_LENGTH - 1; i>=0; i--) {
+		id[i] = id_digits[seed & 31];
+		seed >>= 5;
+	}
+
+	return id;
+}
+
+bool seed_from_id (const std::string& id, uint64_t& seed)
+{
+	if (id.size() != SEED_ID_LENGTH) return false;
+
+	uint64_t value = 0;
+	int i;
+	for (i=0; i<SEED_ID_LENGTH; i++) {
+		char c = toupper(id[i]);
+		if (c == 'O') c = '0';
+		if (c == 'I' || c == 'L') c = '1';
+
+		int digit = 0;
+		while (id_digits[digit] != '\0' && id_digits[digit] != c) digit++;
+		if (id_digits[digit] == '\0') return false;
+
+		// The other 12 digits hold 60 bits, leaving 4 for the first
+		if (i == 0 && digit > 15) return false;
+
+		value = (value << 5) | digit;
+	}
+
+	seed = value;
+	return true;
+}
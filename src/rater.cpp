@@ -0,0 +1,512 @@
+/* Last Modified: 10/19/26
+ * Author: Alex Eastman
+ * Contact: alexeast@buffalo.edu
+ * Summary: Definitions for function prototypes found in rater.h . See rater.h
+ *          for explanation of functions
+ */
+
+
+#include "rater.h"
+#include "solver.h"
+#include "collection.h"
+#include <atomic>
+#include <fstream>
+#include <thread>
+
+namespace {
+
+/* How hard each technique is. The score of a puzzle is led by the weight of
+ * its hardest technique.
+ */
+const int weights[TECHNIQUE_COUNT] = {1, 2, 4, 6, 7, 8, 9, 12, 15, 30};
+
+const int difficulty_of[TECHNIQUE_COUNT] = {
+	EASY, EASY, MEDIUM, HARD, HARD, HARD, HARD, EXPERT, EXPERT, DIABOLICAL
+};
+
+/* The board as a person solving it sees it: placed digits and pencil marks.
+ * masks has one bit per candidate, bit 0 for 1, and is 0 for placed cells.
+ */
+struct Candidates {
+	unsigned char cells[81];
+	unsigned short masks[81];
+	int empty;
+};
+
+void place (Candidates& state, int cell, int digit)
+{
+	const UnitTables& tables = unit_tables();
+	unsigned short bit = 1 << (digit - 1);
+
+	state.cells[cell] = digit;
+	state.masks[cell] = 0;
+	state.empty--;
+
+	int i;
+	for (i=0; i<20; i++) {
+		state.masks[tables.peers[cell][i]] &= ~bit;
+	}
+
+	return;
+}
+
+// Removes bits from the candidates of cell. Returns true if any were there.
+bool eliminate (Candidates& state, int cell, unsigned short bits)
+{
+	if ((state.masks[cell] & bits) == 0) return false;
+	state.masks[cell] &= ~bits;
+	return true;
+}
+
+void load (const Grid& puzzle, Candidates& state)
+{
+	int i;
+	for (i=0; i<81; i++) {
+		state.cells[i] = 0;
+		state.masks[i] = 0x1ff;
+	}
+	state.empty = 81;
+
+	for (i=0; i<81; i++) {
+		if (puzzle.cells[i] != 0) place(state, i, puzzle.cells[i]);
+	}
+
+	return;
+}
+
+/* Steps index, a strictly increasing list of k numbers below n, to the next
+ * combination. Returns false after the last one.
+ */
+bool next_combination (int* index, int k, int n)
+{
+	int i = k - 1;
+	while (i >= 0 && index[i] == n - k + i) i--;
+	if (i < 0) return false;
+
+	index[i]++;
+	int j;
+	for (j=i+1; j<k; j++) index[j] = index[j-1] + 1;
+	return true;
+}
+
+// Bitmask of the positions in unit where digit is still a candidate
+unsigned short positions_of (const Candidates& state, int unit, unsigned short bit)
+{
+	const UnitTables& tables = unit_tables();
+	unsigned short positions = 0;
+
+	int i;
+	for (i=0; i<9; i++) {
+		if (state.masks[tables.units[unit][i]] & bit) positions |= 1 << i;
+	}
+
+	return positions;
+}
+
+bool naked_single (Candidates& state)
+{
+	int i;
+	for (i=0; i<81; i++) {
+		if (state.cells[i] == 0 && __builtin_popcount(state.masks[i]) == 1) {
+			place(state, i, __builtin_ctz(state.masks[i]) + 1);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool hidden_single (Candidates& state)
+{
+	const UnitTables& tables = unit_tables();
+
+	int unit, digit;
+	for (unit=0; unit<27; unit++) {
+		for (digit=1; digit<=9; digit++) {
+			unsigned short positions = positions_of(state, unit, 1 << (digit - 1));
+			if (__builtin_popcount(positions) == 1) {
+				place(state, tables.units[unit][__builtin_ctz(positions)], digit);
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+/* Pointing: a digit confined to one line inside a block is removed from the
+ * rest of the line. Claiming: a digit confined to one block inside a line is
+ * removed from the rest of the block.
+ */
+bool locked_candidates (Candidates& state)
+{
+	const UnitTables& tables = unit_tables();
+
+	int unit, digit, i, line;
+	for (unit=0; unit<27; unit++) {
+		for (digit=1; digit<=9; digit++) {
+			unsigned short bit = 1 << (digit - 1);
+			unsigned short positions = positions_of(state, unit, bit);
+			if (__builtin_popcount(positions) < 2) continue;
+
+			// Each other kind of unit the candidates could all share
+			for (line=0; line<3; line++) {
+				int shared = -1;
+				for (i=0; i<9; i++) {
+					if (!(positions & (1 << i))) continue;
+					int other = tables.units_of[tables.units[unit][i]][line];
+					if (shared == -1) shared = other;
+					else if (shared != other) shared = -2;
+				}
+				if (shared < 0 || shared == unit) continue;
+
+				bool changed = false;
+				for (i=0; i<9; i++) {
+					int cell = tables.units[shared][i];
+					if (tables.units_of[cell][unit / 9] == unit) continue;
+					changed |= eliminate(state, cell, bit);
+				}
+				if (changed) return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+/* k cells in a unit whose candidates together are only k digits. Those
+ * digits are removed from the rest of the unit.
+ */
+bool naked_subset (Candidates& state, int k)
+{
+	const UnitTables& tables = unit_tables();
+
+	int unit, i;
+	for (unit=0; unit<27; unit++) {
+		int open[9];
+		int n = 0;
+		for (i=0; i<9; i++) {
+			int cell = tables.units[unit][i];
+			int count = __builtin_popcount(state.masks[cell]);
+			if (count >= 2 && count <= k) open[n++] = cell;
+		}
+		if (n < k) continue;
+
+		int index[3] = {0, 1, 2};
+		do {
+			unsigned short digits = 0;
+			for (i=0; i<k; i++) digits |= state.masks[open[index[i]]];
+			if (__builtin_popcount(digits) != k) continue;
+
+			bool changed = false;
+			for (i=0; i<9; i++) {
+				int cell = tables.units[unit][i];
+				bool in_subset = false;
+				int j;
+				for (j=0; j<k; j++) in_subset |= open[index[j]] == cell;
+				if (!in_subset) changed |= eliminate(state, cell, digits);
+			}
+			if (changed) return true;
+		} while (next_combination(index, k, n));
+	}
+
+	return false;
+}
+
+/* k digits in a unit that fit in only k cells. Every other digit is removed
+ * from those cells.
+ */
+bool hidden_subset (Candidates& state, int k)
+{
+	const UnitTables& tables = unit_tables();
+
+	int unit, i;
+	for (unit=0; unit<27; unit++) {
+		int open[9];
+		unsigned short positions[9];
+		int n = 0;
+		int digit;
+		for (digit=1; digit<=9; digit++) {
+			unsigned short where = positions_of(state, unit, 1 << (digit - 1));
+			int count = __builtin_popcount(where);
+			if (count >= 2 && count <= k) {
+				open[n] = digit;
+				positions[n] = where;
+				n++;
+			}
+		}
+		if (n < k) continue;
+
+		int index[3] = {0, 1, 2};
+		do {
+			unsigned short cells = 0;
+			unsigned short digits = 0;
+			for (i=0; i<k; i++) {
+				cells |= positions[index[i]];
+				digits |= 1 << (open[index[i]] - 1);
+			}
+			if (__builtin_popcount(cells) != k) continue;
+
+			bool changed = false;
+			for (i=0; i<9; i++) {
+				if (cells & (1 << i)) {
+					changed |= eliminate(state, tables.units[unit][i], ~digits & 0x1ff);
+				}
+			}
+			if (changed) return true;
+		} while (next_combination(index, k, n));
+	}
+
+	return false;
+}
+
+/* X-Wing (k = 2) and Swordfish (k = 3). If a digit fits in k rows only
+ * within the same k columns, it is removed from the rest of those columns.
+ * The same holds with rows and columns swapped.
+ */
+bool fish (Candidates& state, int k)
+{
+	const UnitTables& tables = unit_tables();
+
+	int digit, base, i, j;
+	for (digit=1; digit<=9; digit++) {
+		unsigned short bit = 1 << (digit - 1);
+
+		// base 0 uses rows as the base lines, base 1 uses columns
+		for (base=0; base<2; base++) {
+			int lines[9];
+			unsigned short positions[9];
+			int n = 0;
+			for (i=0; i<9; i++) {
+				unsigned short where = positions_of(state, base*9 + i, bit);
+				int count = __builtin_popcount(where);
+				if (count >= 2 && count <= k) {
+					lines[n] = i;
+					positions[n] = where;
+					n++;
+				}
+			}
+			if (n < k) continue;
+
+			int index[3] = {0, 1, 2};
+			do {
+				unsigned short covers = 0;
+				unsigned short chosen = 0;
+				for (i=0; i<k; i++) {
+					covers |= positions[index[i]];
+					chosen |= 1 << lines[index[i]];
+				}
+				if (__builtin_popcount(covers) != k) continue;
+
+				// Cover lines run the other way. Position j in a cover line
+				// is base line j.
+				bool changed = false;
+				int cover;
+				for (cover=0; cover<9; cover++) {
+					if (!(covers & (1 << cover))) continue;
+					int unit = (1 - base)*9 + cover;
+					for (j=0; j<9; j++) {
+						if (!(chosen & (1 << j))) {
+							changed |= eliminate(state, tables.units[unit][j], bit);
+						}
+					}
+				}
+				if (changed) return true;
+			} while (next_combination(index, k, n));
+		}
+	}
+
+	return false;
+}
+
+/* Applies the easiest technique that makes progress. Returns the technique
+ * used, or -1 if none did.
+ */
+int apply_easiest (Candidates& state)
+{
+	if (naked_single(state)) return NAKED_SINGLE;
+	if (hidden_single(state)) return HIDDEN_SINGLE;
+	if (locked_candidates(state)) return LOCKED_CANDIDATES;
+	if (naked_subset(state, 2)) return NAKED_PAIR;
+	if (hidden_subset(state, 2)) return HIDDEN_PAIR;
+	if (naked_subset(state, 3)) return NAKED_TRIPLE;
+	if (hidden_subset(state, 3)) return HIDDEN_TRIPLE;
+	if (fish(state, 2)) return X_WING;
+	if (fish(state, 3)) return SWORDFISH;
+	return -1;
+}
+
+/* Rates a puzzle already known to have the given unique solution. When the
+ * techniques run out, the open cell with the fewest candidates is filled from
+ * the solution and counted as a guess.
+ */
+Rating rate_solved (const Grid& puzzle, const Grid& solution)
+{
+	Candidates state;
+	load(puzzle, state);
+
+	Rating rating;
+	rating.hardest = NAKED_SINGLE;
+	rating.steps = 0;
+
+	while (state.empty > 0) {
+		int technique = apply_easiest(state);
+
+		if (technique == -1) {
+			int guess = -1;
+			int fewest = 10;
+			int i;
+			for (i=0; i<81; i++) {
+				int count = __builtin_popcount(state.masks[i]);
+				if (state.cells[i] == 0 && count < fewest) {
+					guess = i;
+					fewest = count;
+				}
+			}
+			place(state, guess, solution.cells[guess]);
+			technique = GUESS;
+		}
+
+		if (technique > rating.hardest) rating.hardest = technique;
+		rating.steps++;
+	}
+
+	rating.score = weights[rating.hardest] * 100 + rating.steps;
+	rating.difficulty = difficulty_of[rating.hardest];
+	return rating;
+}
+
+Rating unrated (void)
+{
+	Rating rating = {-1, 0, -1, UNRATED};
+	return rating;
+}
+
+}
+
+Rating rate (const Grid& puzzle)
+{
+	Grid solution;
+	if (count_solutions(puzzle, 2, &solution) != 1) return unrated();
+	return rate_solved(puzzle, solution);
+}
+
+Rating rate_puzzle (const Grid& puzzle, AnalysisCache* cache)
+{
+	if (cache == nullptr) return rate(puzzle);
+
+	CanonicalForm form = canonicalize(puzzle);
+
+	Analysis analysis;
+	if (cache -> lookup(form.hash, analysis)) {
+		if (analysis.rated) {
+			Rating rating;
+			rating.hardest = analysis.hardest;
+			rating.steps = analysis.steps;
+			rating.difficulty = analysis.difficulty;
+			rating.score = analysis.hardest < 0 ? -1 : weights[analysis.hardest] * 100 + analysis.steps;
+			return rating;
+		}
+	} else {
+		analysis.hash = form.hash;
+		analysis.solution = empty_grid();
+		analysis.solutions = count_solutions(form.grid, 2, &analysis.solution);
+	}
+
+	// Rate the canonical grid so every copy of the puzzle gets the same steps
+	Rating rating = analysis.solutions == 1 ?
+		rate_solved(form.grid, analysis.solution) : unrated();
+
+	analysis.rated = true;
+	analysis.difficulty = rating.difficulty;
+	analysis.hardest = rating.hardest;
+	analysis.steps = rating.steps;
+	cache -> store(analysis);
+
+	return rating;
+}
+
+std::vector<Rating> rate_batch (const std::vector<Grid>& puzzles, int threads, AnalysisCache* cache)
+{
+	return rate_batch(puzzles, threads, cache, nullptr);
+}
+
+std::vector<Rating> rate_batch (const std::vector<Grid>& puzzles, int threads, AnalysisCache* cache,
+  const std::atomic<bool>* cancel)
+{
+	std::vector<Rating> ratings(puzzles.size());
+
+	if (threads <= 0) threads = std::thread::hardware_concurrency();
+	if (threads <= 0) threads = 1;
+
+	// Workers take small chunks so a few slow puzzles don't hold up one thread
+	const size_t chunk = 64;
+	std::atomic<size_t> next(0);
+
+	auto worker = [&]() {
+		while (cancel == nullptr || !cancel -> load()) {
+			size_t first = next.fetch_add(chunk);
+			if (first >= puzzles.size()) break;
+
+			size_t last = std::min(first + chunk, puzzles.size());
+			size_t i;
+			for (i=first; i<last; i++) {
+				ratings[i] = rate_puzzle(puzzles[i], cache);
+			}
+		}
+	};
+
+	std::vector<std::thread> workers;
+	int i;
+	for (i=1; i<threads; i++) workers.push_back(std::thread(worker));
+	worker();  // This thread does its share too
+	for (auto& t : workers) t.join();
+
+	return ratings;
+}
+
+bool rate_files (const std::vector<std::string>& paths, int threads, AnalysisCache* cache,
+  std::ostream& out)
+{
+	std::vector<Grid> puzzles;
+	bool all_read = read_puzzles(paths, puzzles);
+
+	std::vector<Rating> ratings = rate_batch(puzzles, threads, cache);
+
+	size_t i;
+	for (i=0; i<puzzles.size(); i++) {
+		out << grid_to_string(puzzles[i]) << " " << ratings[i].score << " "
+			<< difficulty_name(ratings[i].difficulty) << "\n";
+	}
+
+	return all_read;
+}
+
+std::string difficulty_name (int difficulty)
+{
+	switch (difficulty) {
+		case EASY: return "Easy";
+		case MEDIUM: return "Medium";
+		case HARD: return "Hard";
+		case EXPERT: return "Expert";
+		case DIABOLICAL: return "Diabolical";
+		default: return "Unrated";
+	}
+}
+
+std::string technique_name (int technique)
+{
+	switch (technique) {
+		case NAKED_SINGLE: return "Naked Single";
+		case HIDDEN_SINGLE: return "Hidden Single";
+		case LOCKED_CANDIDATES: return "Locked Candidates";
+		case NAKED_PAIR: return "Naked Pair";
+		case HIDDEN_PAIR: return "Hidden Pair";
+		case NAKED_TRIPLE: return "Naked Triple";
+		case HIDDEN_TRIPLE: return "Hidden Triple";
+		case X_WING: return "X-Wing";
+		case SWORDFISH: return "Swordfish";
+		case GUESS: return "Guess";
+		default: return "None";
+	}
+}
@@ -0,0 +1,250 @@
+/* Last Modified: 10/19/26
+ * Author: Alex Eastman
+ * Contact: alexeast@buffalo.edu
+ * Summary: Definitions for function prototypes found in saver.h . See
+ *          saver.h for explanation of functions
+ */
+
+
+#include "saver.h"
+#include "trace.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <vector>
+#include <iostream>
+#include <stdio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+BackgroundSaver::BackgroundSaver (void)
+{
+	next_sequence = 0;
+	writing = false;
+	flushing = 0;
+	stopping = false;
+	stats = {0, 0, 0};
+	writer = std::thread(&BackgroundSaver::run, this);
+}
+
+BackgroundSaver::~BackgroundSaver (void)
+{
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		stopping = true;
+	}
+	pending_changed.notify_all();
+	writer.join();
+}
+
+void BackgroundSaver::save (const std::string& path, const std::string& contents)
+{
+	save_after(path, contents, "");
+	return;
+}
+
+void BackgroundSaver::save_after (const std::string& path, const std::string& contents,
+  const std::string& after)
+{
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		pending[path] = {contents, true, next_sequence++, after};
+		stats.requests++;
+
+		// Files waiting on this one move behind it again
+		for (auto& file : pending) {
+			if (file.second.after == path) file.second.sequence = next_sequence++;
+		}
+	}
+	pending_changed.notify_all();
+	return;
+}
+
+void BackgroundSaver::append (const std::string& path, const std::string& text)
+{
+	{
+		std::lock_guard<std::mutex> guard(lock);
+
+		// Still goes after a whole file queued before it
+		auto found = pending.find(path);
+		if (found == pending.end()) pending[path] = {text, false, next_sequence++, ""};
+		else found -> second.contents += text;
+		stats.requests++;
+	}
+	pending_changed.notify_all();
+	return;
+}
+
+void BackgroundSaver::flush (void)
+{
+	TRACE_SCOPE("BackgroundSaver::flush");
+
+	std::unique_lock<std::mutex> guard(lock);
+	flushing++;
+	pending_changed.notify_all();
+	batch_written.wait(guard, [this] { return pending.empty() && !writing; });
+	flushing--;
+	return;
+}
+
+std::string BackgroundSaver::read (const std::string& path)
+{
+	TRACE_SCOPE("BackgroundSaver::read");
+
+	std::unique_lock<std::mutex> guard(lock);
+
+	// The file on disk changes under an append being written, so that one
+	// has to finish. Whole files are renamed into place, so they don't.
+	batch_written.wait(guard, [&] {
+		auto found = in_flight.find(path);
+		return found == in_flight.end() || found -> second.replace;
+	});
+
+	std::string contents;
+	auto writing_file = in_flight.find(path);
+	if (writing_file != in_flight.end()) {
+		contents = writing_file -> second.contents;
+	} else {
+		// Read under the lock, so the writer can't start on it meanwhile
+		std::ifstream file(path);
+		std::stringstream text;
+		text << file.rdbuf();
+		contents = text.str();
+	}
+
+	auto queued = pending.find(path);
+	if (queued != pending.end()) {
+		if (queued -> second.replace) contents = queued -> second.contents;
+		else contents += queued -> second.contents;
+	}
+
+	return contents;
+}
+
+void BackgroundSaver::run (void)
+{
+	std::unique_lock<std::mutex> guard(lock);
+	while (true) {
+		pending_changed.wait(guard, [this] { return stopping || !pending.empty(); });
+		if (pending.empty()) return;  // Stopping, and everything is written
+
+		// Give a burst of saves time to arrive so they are written once
+		if (!stopping && flushing == 0) {
+			pending_changed.wait_for(guard, std::chrono::milliseconds(SAVE_DELAY_MS),
+			  [this] { return stopping || flushing > 0; });
+		}
+
+		in_flight.swap(pending);
+		writing = true;
+
+		// Oldest first, so a file is never written before one it waits on
+		std::vector<std::pair<long, std::string>> order;
+		for (auto& file : in_flight) order.push_back({file.second.sequence, file.first});
+		std::sort(order.begin(), order.end());
+		guard.unlock();
+
+		// Only the writer changes in_flight, so it reads it without the lock
+		std::set<std::string> failed;
+		for (auto& next : order) {
+			TRACE_SCOPE("BackgroundSaver::write");
+
+			const std::string& path = next.second;
+			const PendingFile& file = in_flight.find(path) -> second;
+
+			auto started = std::chrono::steady_clock::now();
+			bool written = false;
+			if (file.after.empty() || failed.count(file.after) == 0) {
+				written = file.replace ? write_file_atomically(path, file.contents) :
+				  append_to_file(path, file.contents);
+			}
+			auto elapsed = std::chrono::steady_clock::now() - started;
+
+			if (!written) {
+				std::cerr << "Could not save " << path << std::endl;
+				failed.insert(path);
+			}
+
+			guard.lock();
+			stats.writes++;
+			if (!written) stats.failures++;
+			write_times.record(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+			in_flight.erase(path);
+			batch_written.notify_all();
+			guard.unlock();
+		}
+
+		guard.lock();
+		writing = false;
+		batch_written.notify_all();
+	}
+}
+
+SaveStats BackgroundSaver::get_stats (void)
+{
+	std::lock_guard<std::mutex> guard(lock);
+	return stats;
+}
+
+std::string BackgroundSaver::report (void)
+{
+	std::lock_guard<std::mutex> guard(lock);
+
+	char times[120];
+	snprintf(times, sizeof(times), "Write time: p50 %.1fms  p95 %.1fms  p99 %.1fms\n",
+	  write_times.percentile(0.50) / 1000.0, write_times.percentile(0.95) / 1000.0,
+	  write_times.percentile(0.99) / 1000.0);
+
+	return "Saves: " + std::to_string(stats.requests) + " requested, " + std::to_string(stats.writes) +
+	  " written, " + std::to_string(stats.failures) + " failed\n" + times;
+}
+
+bool write_file_atomically (const std::string& path, const std::string& contents)
+{
+	std::string temporary = path + ".tmp";
+	int fd = open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+	if (fd < 0) return false;
+
+	size_t written = 0;
+	while (written < contents.size()) {
+		ssize_t length = write(fd, contents.data() + written, contents.size() - written);
+		if (length < 0 && errno == EINTR) continue;
+		if (length <= 0) break;
+		written += length;
+	}
+
+	// Synced before the rename, so the new name never points at missing data
+	bool complete = written == contents.size() && fsync(fd) == 0;
+	complete = close(fd) == 0 && complete;
+
+	if (!complete || rename(temporary.c_str(), path.c_str()) != 0) {
+		unlink(temporary.c_str());
+		return false;
+	}
+	return true;
+}
+
+bool append_to_file (const std::string& path, const std::string& text)
+{
+	int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+	if (fd < 0) return false;
+
+	size_t written = 0;
+	while (written < text.size()) {
+		ssize_t length = write(fd, text.data() + written, text.size() - written);
+		if (length < 0 && errno == EINTR) continue;
+		if (length <= 0) break;
+		written += length;
+	}
+
+	bool complete = written == text.size() && fdatasync(fd) == 0;
+	return close(fd) == 0 && complete;
+}
+
+BackgroundSaver& shared_saver (void)
+{
+	static BackgroundSaver saver;
+	return saver;
+}
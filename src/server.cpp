@@ -0,0 +1,564 @@
+/* Last Modified: 10/19/26
+ * Author: Alex Eastman
+ * Contact: alexeast@buffalo.edu
+ * Summary: Definitions for function prototypes found in server.h . See
+ *          server.h for explanation of functions
+ */
+
+
+#include "server.h"
+#include "generator.h"
+#include "variants.h"
+#include "rater.h"
+#include "solver.h"
+#include "random.h"
+#include "paths.h"
+#include "trace.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+namespace {
+
+// epoll tokens. Clients use their connection id, which stays below both.
+const uint64_t wake_token = ~0ULL;
+const uint64_t listener_tag = 1ULL << 62;
+
+// Events handled per epoll_wait
+const int event_batch = 64;
+
+// Guards the results file, which every worker may append to
+std::mutex results_lock;
+
+// Wakes the loop. Only a write, so this is safe in a signal handler. It can
+// only fail if so many wakes are pending that the loop is sure to run.
+void wake (int fd)
+{
+	uint64_t one = 1;
+	ssize_t written = write(fd, &one, sizeof(one));
+	(void) written;
+	return;
+}
+
+std::string lowercase (std::string text)
+{
+	for (char& c : text) c = tolower(c);
+	return text;
+}
+
+std::vector<std::string> split_words (const std::string& line)
+{
+	std::vector<std::string> words;
+	std::istringstream in(line);
+	std::string word;
+	while (in >> word) words.push_back(word);
+	return words;
+}
+
+// The Difficulty named, UNRATED for "any", or -2 if it is not a difficulty
+int difficulty_from_name (const std::string& name)
+{
+	if (lowercase(name) == "any") return UNRATED;
+
+	int difficulty;
+	for (difficulty=EASY; difficulty<=DIABOLICAL; difficulty++) {
+		if (lowercase(difficulty_name(difficulty)) == lowercase(name)) return difficulty;
+	}
+	return -2;
+}
+
+// Exactly 81 cells, unlike grid_from_string which allows more after them
+bool read_grid (const std::string& text, Grid& grid)
+{
+	return text.size() == 81 && grid_from_string(text, grid);
+}
+
+// The only solution of puzzle, or false if it does not have exactly one
+bool unique_solution (const Grid& puzzle, AnalysisCache* cache, Grid& solution)
+{
+	if (cache) return analyze_puzzle(puzzle, *cache, solution).solutions == 1;
+	return count_solutions(puzzle, 2, &solution) == 1;
+}
+
+std::string new_puzzle (const std::vector<std::string>& words, AnalysisCache* cache)
+{
+	if (words.size() < 2 || words.size() > 3) return "ERR usage: NEW difficulty [id]";
+
+	int wanted = difficulty_from_name(words[1]);
+	if (wanted == -2) return "ERR unknown difficulty " + words[1];
+
+	int variant = VARIANT_CLASSIC;
+	int symmetry = SYMMETRY_ROTATIONAL;
+	uint64_t seed;
+	if (words.size() == 3) {
+		if (!parse_puzzle_id(words[2], variant, symmetry, seed)) return "ERR not a puzzle ID";
+		if (variant != VARIANT_CLASSIC) return "ERR only classic puzzles are served";
+	} else seed = fresh_seed();
+
+	// Each try continues the sequence of the last, so the same ID and
+	// difficulty always give the same puzzle. The reply has the ID of the
+	// seed that made it, which replays it in the game too.
+	int tries;
+	for (tries=0; tries<SERVER_MAX_TRIES; tries++) {
+		Random random(seed);
+		Grid puzzle = generate_puzzle(symmetry, 1, nullptr, random);
+		Rating rating = rate_puzzle(puzzle, cache);
+
+		if (wanted == UNRATED || rating.difficulty == wanted) {
+			return "OK " + make_puzzle_id(variant, symmetry, seed) + " " +
+			  lowercase(difficulty_name(rating.difficulty)) + " " + grid_to_string(puzzle);
+		}
+		seed = random.next();
+	}
+
+	return "ERR no " + lowercase(words[1]) + " puzzle found";
+}
+
+// Reads "puzzle board" and checks the board keeps every clue
+std::string read_game (const std::vector<std::string>& words, Grid& puzzle, Grid& board)
+{
+	if (words.size() != 3) return "ERR usage: " + words[0] + " puzzle board";
+	if (!read_grid(words[1], puzzle) || !read_grid(words[2], board)) return "ERR not a grid";
+
+	int i;
+	for (i=0; i<81; i++) {
+		if (puzzle.cells[i] != 0 && board.cells[i] != puzzle.cells[i]) return "ERR board changes a clue";
+	}
+	return "";
+}
+
+std::string check_board (const std::vector<std::string>& words, AnalysisCache* cache)
+{
+	Grid puzzle, board, solution;
+	std::string error = read_game(words, puzzle, board);
+	if (!error.empty()) return error;
+	if (!unique_solution(puzzle, cache, solution)) return "ERR puzzle does not have one solution";
+
+	int empty = 0;
+	int mistakes = 0;
+	int i;
+	for (i=0; i<81; i++) {
+		if (board.cells[i] == 0) empty++;
+		else if (board.cells[i] != solution.cells[i]) mistakes++;
+	}
+
+	if (mistakes > 0) return "OK mistakes " + std::to_string(mistakes);
+	if (empty > 0) return "OK incomplete " + std::to_string(empty);
+	return "OK solved 0";
+}
+
+std::string give_hint (const std::vector<std::string>& words, AnalysisCache* cache)
+{
+	Grid puzzle, board, solution;
+	std::string error = read_game(words, puzzle, board);
+	if (!error.empty()) return error;
+	if (!unique_solution(puzzle, cache, solution)) return "ERR puzzle does not have one solution";
+
+	// Same as the game: the first cell that is empty or wrong
+	int i;
+	for (i=0; i<81; i++) {
+		if (board.cells[i] != solution.cells[i]) {
+			return "OK " + std::to_string(i / 9) + " " + std::to_string(i % 9) + " " +
+			  std::to_string(solution.cells[i]);
+		}
+	}
+	return "OK none";
+}
+
+std::string save_result (const std::vector<std::string>& words)
+{
+	if (words.size() != 4) return "ERR usage: SAVE name id|puzzle seconds";
+
+	int variant, symmetry;
+	uint64_t seed;
+	Grid puzzle;
+	if (!parse_puzzle_id(words[2], variant, symmetry, seed) && !read_grid(words[2], puzzle)) {
+		return "ERR not a puzzle ID or grid";
+	}
+
+	char* end;
+	long seconds = strtol(words[3].c_str(), &end, 10);
+	if (*end != '\0' || seconds < 0) return "ERR not a number of seconds";
+
+	std::lock_guard<std::mutex> guard(results_lock);
+	std::ofstream results(data_path(SERVER_RESULTS_FILE), std::ios::app);
+	results << words[1] << " " << words[2] << " " << seconds << "\n";
+	if (!results.good()) return "ERR could not save";
+	return "OK";
+}
+
+}
+
+std::string handle_request (const std::string& request, AnalysisCache* cache)
+{
+	TRACE_SCOPE("handle_request");
+
+	std::vector<std::string> words = split_words(request);
+	if (words.empty()) return "ERR empty request";
+
+	std::string command = words[0];
+	for (char& c : command) c = toupper(c);
+
+	if (command == "PING") return "OK";
+	if (command == "NEW") return new_puzzle(words, cache);
+	if (command == "CHECK") return check_board(words, cache);
+	if (command == "HINT") return give_hint(words, cache);
+	if (command == "SAVE") return save_result(words);
+	return "ERR unknown request " + words[0];
+}
+
+PuzzleServer::PuzzleServer (AnalysisCache* shared)
+{
+	cache = shared;
+	next_connection = 0;
+	stopping = false;
+	socket_path = "";
+
+	epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+	wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+	epoll_event event;
+	event.events = EPOLLIN;
+	event.data.u64 = wake_token;
+	epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wake_fd, &event);
+}
+
+PuzzleServer::~PuzzleServer (void)
+{
+	stop();
+	for (std::thread& worker : workers) {
+		if (worker.joinable()) worker.join();
+	}
+
+	for (auto& entry : connections) ::close(entry.second.fd);
+	for (int listener : listeners) ::close(listener);
+	if (!socket_path.empty()) unlink(socket_path.c_str());
+
+	::close(wake_fd);
+	::close(epoll_fd);
+}
+
+bool PuzzleServer::add_listener (int fd)
+{
+	if (listen(fd, SOMAXCONN) != 0) {
+		::close(fd);
+		return false;
+	}
+
+	epoll_event event;
+	event.events = EPOLLIN;
+	event.data.u64 = listener_tag | fd;
+	if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) != 0) {
+		::close(fd);
+		return false;
+	}
+
+	listeners.push_back(fd);
+	return true;
+}
+
+bool PuzzleServer::listen_unix (const std::string& path)
+{
+	sockaddr_un address;
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	if (path.size() >= sizeof(address.sun_path)) return false;
+	strcpy(address.sun_path, path.c_str());
+
+	int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (fd < 0) return false;
+
+	// A socket left by a server that died can be replaced, one in use can't
+	if (bind(fd, (sockaddr*) &address, sizeof(address)) != 0) {
+		int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+		bool in_use = connect(probe, (sockaddr*) &address, sizeof(address)) == 0;
+		::close(probe);
+
+		if (in_use || errno != ECONNREFUSED || unlink(path.c_str()) != 0 ||
+		  bind(fd, (sockaddr*) &address, sizeof(address)) != 0) {
+			::close(fd);
+			return false;
+		}
+	}
+
+	if (!add_listener(fd)) {
+		unlink(path.c_str());
+		return false;
+	}
+	socket_path = path;
+	return true;
+}
+
+bool PuzzleServer::listen_tcp (int port)
+{
+	int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (fd < 0) return false;
+
+	int on = 1;
+	setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+	sockaddr_in address;
+	memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_port = htons(port);
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+	if (bind(fd, (sockaddr*) &address, sizeof(address)) != 0) {
+		::close(fd);
+		return false;
+	}
+
+	return add_listener(fd);
+}
+
+void PuzzleServer::run (int threads)
+{
+	if (threads <= 0) threads = std::max(1u, std::thread::hardware_concurrency());
+
+	int i;
+	for (i=0; i<threads; i++) workers.emplace_back(&PuzzleServer::work, this);
+
+	epoll_event events[event_batch];
+	while (!stopping) {
+		int count = epoll_wait(epoll_fd, events, event_batch, -1);
+		if (count < 0 && errno != EINTR) break;
+
+		for (i=0; i<count && !stopping; i++) {
+			uint64_t token = events[i].data.u64;
+
+			if (token == wake_token) {
+				uint64_t wakes;
+				while (read(wake_fd, &wakes, sizeof(wakes)) > 0);
+				collect_replies();
+			} else if (token & listener_tag) {
+				accept_clients(token & ~listener_tag);
+			} else {
+				// A client that hung up completely can't get its replies
+				if (events[i].events & EPOLLIN) read_client(token);
+				if (events[i].events & (EPOLLHUP | EPOLLERR)) close_client(token);
+				else if (events[i].events & EPOLLOUT) write_client(token);
+			}
+		}
+	}
+
+	// Wake every worker so it sees stopping
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		work_ready.notify_all();
+	}
+	for (std::thread& worker : workers) worker.join();
+	workers.clear();
+
+	return;
+}
+
+void PuzzleServer::stop (void)
+{
+	stopping = true;
+	wake(wake_fd);
+	return;
+}
+
+void PuzzleServer::accept_clients (int listener)
+{
+	while (true) {
+		int fd = accept4(listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+		if (fd < 0) return;  // None left, or out of descriptors until one closes
+
+		// Replies are small and a client waits for each one. Fails harmlessly
+		// on Unix sockets.
+		int on = 1;
+		setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+
+		long id = next_connection++;
+		epoll_event event;
+		event.events = EPOLLIN;
+		event.data.u64 = id;
+		if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) != 0) {
+			::close(fd);
+			continue;
+		}
+
+		Connection& client = connections[id];
+		client.fd = fd;
+		client.next_request = 0;
+		client.next_reply = 0;
+		client.closing = false;
+	}
+}
+
+void PuzzleServer::read_client (long id)
+{
+	auto found = connections.find(id);
+	if (found == connections.end()) return;
+	Connection& client = found -> second;
+
+	// Stops once the client has too much waiting. What it sent after stays
+	// in the socket until update_events starts reading again.
+	std::vector<Job> jobs;
+	char buffer[4096];
+	while (!backed_up(client)) {
+		ssize_t length = read(client.fd, buffer, sizeof(buffer));
+		if (length > 0) client.input.append(buffer, length);
+		else if (length == 0) {
+			client.closing = true;
+			break;
+		} else if (errno == EINTR) continue;
+		else if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+		else {
+			close_client(id);
+			return;
+		}
+
+		size_t start = 0;
+		size_t end;
+		while ((end = client.input.find('\n', start)) != std::string::npos) {
+			std::string line = client.input.substr(start, end - start);
+			if (!line.empty() && line.back() == '\r') line.pop_back();
+			start = end + 1;
+
+			if (!line.empty()) jobs.push_back({id, client.next_request++, line});
+		}
+		client.input.erase(0, start);
+
+		if (client.input.size() > SERVER_MAX_LINE) {
+			close_client(id);
+			return;
+		}
+	}
+
+	if (!jobs.empty()) {
+		std::lock_guard<std::mutex> guard(lock);
+		for (Job& job : jobs) requests.push_back(std::move(job));
+		work_ready.notify_all();
+	}
+
+	write_client(id);
+	return;
+}
+
+void PuzzleServer::write_client (long id)
+{
+	auto found = connections.find(id);
+	if (found == connections.end()) return;
+	Connection& client = found -> second;
+
+	size_t written = 0;
+	while (written < client.output.size()) {
+		ssize_t length = send(client.fd, client.output.data() + written, client.output.size() - written,
+		  MSG_NOSIGNAL);
+		if (length > 0) written += length;
+		else if (length < 0 && errno == EINTR) continue;
+		else if (length < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+		else {
+			close_client(id);
+			return;
+		}
+	}
+	client.output.erase(0, written);
+
+	if (client.closing && client.output.empty() && client.next_reply == client.next_request) {
+		close_client(id);
+		return;
+	}
+
+	update_events(id);
+	return;
+}
+
+bool PuzzleServer::backed_up (const Connection& client)
+{
+	return client.next_request - client.next_reply >= SERVER_MAX_PENDING ||
+	  client.output.size() >= SERVER_MAX_OUTPUT;
+}
+
+void PuzzleServer::update_events (long id)
+{
+	Connection& client = connections[id];
+
+	// A client that is done sending stays readable forever, so stop asking.
+	// One that is backed up is asked again once its replies drain.
+	epoll_event event;
+	event.events = (client.closing || backed_up(client) ? 0 : EPOLLIN) | (client.output.empty() ? 0 : EPOLLOUT);
+	event.data.u64 = id;
+	epoll_ctl(epoll_fd, EPOLL_CTL_MOD, client.fd, &event);
+	return;
+}
+
+void PuzzleServer::close_client (long id)
+{
+	auto found = connections.find(id);
+	if (found == connections.end()) return;
+
+	epoll_ctl(epoll_fd, EPOLL_CTL_DEL, found -> second.fd, nullptr);
+	::close(found -> second.fd);
+	connections.erase(found);
+	return;
+}
+
+void PuzzleServer::collect_replies (void)
+{
+	std::vector<Job> ready;
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		ready.swap(replies);
+	}
+
+	std::vector<long> touched;
+	for (Job& reply : ready) {
+		auto found = connections.find(reply.connection);
+		if (found == connections.end()) continue;  // Closed while it was worked on
+
+		Connection& client = found -> second;
+		client.finished[reply.number] = std::move(reply.text);
+
+		// Everything that is now next in line
+		while (!client.finished.empty() && client.finished.begin() -> first == client.next_reply) {
+			client.output += client.finished.begin() -> second;
+			client.output += '\n';
+			client.finished.erase(client.finished.begin());
+			client.next_reply++;
+		}
+		touched.push_back(reply.connection);
+	}
+
+	for (long id : touched) write_client(id);
+	return;
+}
+
+void PuzzleServer::work (void)
+{
+	while (true) {
+		Job job;
+		{
+			std::unique_lock<std::mutex> guard(lock);
+			work_ready.wait(guard, [this] { return stopping || !requests.empty(); });
+			if (stopping) return;
+
+			job = std::move(requests.front());
+			requests.pop_front();
+		}
+
+		job.text = handle_request(job.text, cache);
+
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			replies.push_back(std::move(job));
+		}
+
+		wake(wake_fd);
+	}
+}
@@ -0,0 +1,136 @@
+/* Last Modified: 10/19/26
+ * Author: Alex Eastman
+ * Contact: alexeast@buffalo.edu
+ * Summary: Definitions for function prototypes found in session.h . See
+ *          session.h for explanation of functions
+ */
+
+
+#include "session.h"
+#include "trace.h"
+#include <algorithm>
+#include <memory>
+
+Game::Game (Glib::KeyFile& user_data) : board(user_data)
+{
+}
+
+void Game::branch (void)
+{
+	board.branch();
+
+	// Moved, not copied, so each level of nesting costs the same
+	branch_stacks.emplace_back(std::move(user_stack), std::move(undone_stack));
+	user_stack = ActionStack();
+	undone_stack = ActionStack();
+	return;
+}
+
+bool Game::keep_branch (void)
+{
+	if (!board.keep_branch()) return false;
+
+	// The branch's moves go on top of the ones from before it
+	std::vector<Action> moves;
+	while (!user_stack.empty()) {
+		moves.push_back(user_stack.top());
+		user_stack.pop();
+	}
+	bool changed = !moves.empty();
+	user_stack = std::move(branch_stacks.back().first);
+	while (!moves.empty()) {
+		user_stack.push(moves.back());
+		moves.pop_back();
+	}
+
+	// What was undone in the branch can still be redone. What was undone
+	// before it only if the branch changed nothing.
+	if (!changed && undone_stack.empty()) {
+		undone_stack = std::move(branch_stacks.back().second);
+	}
+	branch_stacks.pop_back();
+	return true;
+}
+
+bool Game::discard_branch (void)
+{
+	if (!board.discard_branch()) return false;
+
+	user_stack = std::move(branch_stacks.back().first);
+	undone_stack = std::move(branch_stacks.back().second);
+	branch_stacks.pop_back();
+	return true;
+}
+
+void Game::clear_history (void)
+{
+	while (board.discard_branch()) continue;
+	user_stack = ActionStack();
+	undone_stack = ActionStack();
+	branch_stacks.clear();
+	return;
+}
+
+SessionManager::SessionManager (void)
+{
+	load_user_data(user_data);
+}
+
+SessionManager::~SessionManager (void)
+{
+	for (Game* game : games) game -> ~Game();
+
+	std::allocator<Game> allocator;
+	for (Game* block : blocks) allocator.deallocate(block, SESSION_BLOCK);
+}
+
+Game* SessionManager::open (void)
+{
+	TRACE_SCOPE("SessionManager::open");
+
+	if (free_slots.empty()) {
+		// Filled from the end so the first slot of the block is used first
+		Game* block = std::allocator<Game>().allocate(SESSION_BLOCK);
+		blocks.push_back(block);
+
+		int i;
+		for (i=SESSION_BLOCK - 1; i>=0; i--) free_slots.push_back(block + i);
+	}
+
+	Game* slot = free_slots.back();
+	free_slots.pop_back();
+
+	Game* game = new (slot) Game(user_data);
+	games.push_back(game);
+	return game;
+}
+
+void SessionManager::close (Game* game)
+{
+	auto found = std::find(games.begin(), games.end(), game);
+	if (found == games.end()) return;
+
+	games.erase(found);
+	game -> ~Game();
+	free_slots.push_back(game);
+	return;
+}
+
+Game* SessionManager::find (const Glib::ustring& username)
+{
+	for (Game* game : games) {
+		if (game -> board.get_username() == username) return game;
+	}
+	return nullptr;
+}
+
+int SessionManager::size (void)
+{
+	return games.size();
+}
+
+Game* SessionManager::get (int index)
+{
+	if (index < 0 || index >= (int) games.size()) return nullptr;
+	return games[index];
+}
@@ -0,0 +1,619 @@
+/* Last Modified: 10/19/26
+ * Author: Alex Eastman
+ * Contact: alexeast@buffalo.edu
+ * Summary: Definitions for function prototypes found in solver.h . See
+ *          solver.h for explanation of functions
+ */
+
+
+#include "solver.h"
+#include "trace.h"
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <thread>
+#include <algorithm>
+
+namespace {
+
+/* Digits used in each row, column and block of a grid with boxes of Order
+ * by Order cells, one bit per digit with bit 0 for 1. Filled in from the
+ * grid before searching.
+ */
+template <int Order>
+struct SearchState {
+	static const int size = Order * Order;  // Digits, and cells in a unit
+	static const int cell_count = size * size;
+
+	unsigned int rows[size];
+	unsigned int columns[size];
+	unsigned int blocks[size];
+	unsigned char cells[cell_count];
+};
+
+template <int Order>
+int block_of (int cell)
+{
+	const int size = Order * Order;
+	return (cell / (size * Order)) * Order + (cell % size) / Order;
+}
+
+// Places digit at cell. Returns false if it breaks the rules.
+template <int Order>
+bool place (SearchState<Order>& state, int cell, int digit)
+{
+	const int size = Order * Order;
+	unsigned int bit = 1u << (digit - 1);
+	int row = cell / size;
+	int column = cell % size;
+	int block = block_of<Order>(cell);
+
+	if ((state.rows[row] | state.columns[column] | state.blocks[block]) & bit) return false;
+
+	state.rows[row] |= bit;
+	state.columns[column] |= bit;
+	state.blocks[block] |= bit;
+	state.cells[cell] = digit;
+	return true;
+}
+
+template <int Order>
+void unplace (SearchState<Order>& state, int cell, int digit)
+{
+	const int size = Order * Order;
+	unsigned int bit = ~(1u << (digit - 1));
+	state.rows[cell / size] &= bit;
+	state.columns[cell % size] &= bit;
+	state.blocks[block_of<Order>(cell)] &= bit;
+	state.cells[cell] = 0;
+	return;
+}
+
+// Fills state from the cells of a grid. Returns false if the givens already
+// break the rules.
+template <int Order>
+bool load (const unsigned char* givens, SearchState<Order>& state)
+{
+	const int size = Order * Order;
+
+	int i;
+	for (i=0; i<size; i++) {
+		state.rows[i] = 0;
+		state.columns[i] = 0;
+		state.blocks[i] = 0;
+	}
+
+	for (i=0; i<size*size; i++) {
+		state.cells[i] = 0;
+		if (givens[i] > size) return false;
+		if (givens[i] != 0 && !place(state, i, givens[i])) return false;
+	}
+
+	return true;
+}
+
+/* Finds the empty cell with the fewest candidates and stores it in cell,
+ * with its candidates in mask. cell is -1 if the grid is full. Returns
+ * false at a dead end, a cell with no candidates.
+ *
+ * On grids larger than 9x9 this alone leaves the search tree far too big.
+ * There it also looks for a digit that fits only one cell of a unit, and
+ * gives up on units where some digit fits nowhere.
+ */
+template <int Order>
+bool choose_cell (const SearchState<Order>& state, int& cell, unsigned int& mask)
+{
+	const int size = Order * Order;
+	const unsigned int all = (1u << size) - 1;
+	int best_count = size + 1;
+	cell = -1;
+
+	// Candidates of every cell, for the unit checks. Empty for filled cells.
+	unsigned int candidates[Order > 3 ? size * size : 1];
+
+	int i, j;
+	for (i=0; i<size*size; i++) {
+		if (Order > 3) candidates[i] = 0;
+		if (state.cells[i] != 0) continue;
+
+		unsigned int used = state.rows[i / size] | state.columns[i % size] | state.blocks[block_of<Order>(i)];
+		unsigned int free = ~used & all;
+		int count = __builtin_popcount(free);
+
+		if (count == 0) return false;
+		if (Order > 3) candidates[i] = free;
+		if (count < best_count) {
+			cell = i;
+			best_count = count;
+			mask = free;
+			if (count == 1) return true;
+		}
+	}
+	if (Order <= 3 || cell == -1) return true;
+
+	// Units 0 to size - 1 are rows, then columns, then blocks
+	for (i=0; i<3*size; i++) {
+		int unit = i % size;
+		unsigned int placed = i < size ? state.rows[unit] : i < 2*size ? state.columns[unit] : state.blocks[unit];
+		unsigned int once = 0;
+		unsigned int twice = 0;
+		int members[size];
+
+		for (j=0; j<size; j++) {
+			if (i < size) members[j] = unit*size + j;
+			else if (i < 2*size) members[j] = j*size + unit;
+			else members[j] = ((unit / Order)*Order + j / Order)*size + (unit % Order)*Order + j % Order;
+
+			twice |= once & candidates[members[j]];
+			once |= candidates[members[j]];
+		}
+
+		if ((once | placed) != all) return false;
+
+		unsigned int single = once & ~twice;
+		if (single == 0) continue;
+
+		unsigned int bit = single & -single;
+		for (j=0; j<size; j++) {
+			if (candidates[members[j]] & bit) {
+				cell = members[j];
+				mask = bit;
+				return true;
+			}
+		}
+	}
+
+	return true;
+}
+
+/* Depth first search that always branches on the empty cell with the fewest
+ * candidates. Calls visit(cells, index) with each solution found and its
+ * index. Returns the number of solutions found so far.
+ */
+template <int Order, class Visit>
+int search (SearchState<Order>& state, int limit, int found, const Visit& visit,
+  const std::atomic<bool>* cancel)
+{
+	// Unwind straight away if another thread no longer needs the answer
+	if (cancel != nullptr && cancel -> load(std::memory_order_relaxed)) return limit;
+
+	int cell;
+	unsigned int mask;
+	if (!choose_cell(state, cell, mask)) return found;
+
+	// No empty cells left, so this is a solution
+	if (cell == -1) {
+		visit(state.cells, found);
+		return found + 1;
+	}
+
+	while (mask) {
+		int digit = __builtin_ctz(mask) + 1;
+		mask &= mask - 1;
+
+		place(state, cell, digit);
+		found = search(state, limit, found, visit, cancel);
+		unplace(state, cell, digit);
+
+		if (found >= limit) break;
+	}
+
+	return found;
+}
+
+/* Threads kept for parallel searches, so a search doesn't pay to start and
+ * join them. They sleep until a search hands them a part, and the pool only
+ * grows, to the most threads a search has asked for. One search runs on it at
+ * a time.
+ */
+class WorkerPool {
+
+  private:
+
+	std::vector<std::thread> threads;
+
+	// The part of the search being handed out, and the next and last part
+	const std::function<void(int)>* job;
+	int next_part;
+	int last_part;
+	int running;    // Parts handed out that have not returned
+	bool stopping;
+
+	/* Guards everything above. wake wakes the pool threads and done wakes
+	 * the search waiting for its parts.
+	 */
+	std::mutex lock;
+	std::condition_variable wake;
+	std::condition_variable done;
+
+	// Held for a whole search
+	std::mutex busy;
+
+	void serve (void)
+	{
+		std::unique_lock<std::mutex> guard(lock);
+		while (true) {
+			wake.wait(guard, [this] { return stopping || (job != nullptr && next_part <= last_part); });
+			if (stopping) return;
+
+			const std::function<void(int)>& part = *job;
+			int self = next_part++;
+			guard.unlock();
+
+			part(self);
+
+			guard.lock();
+			if (--running == 0) done.notify_all();
+		}
+	}
+
+  public:
+
+	WorkerPool (void) : job(nullptr), next_part(0), last_part(-1), running(0), stopping(false) {}
+
+	~WorkerPool (void)
+	{
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			stopping = true;
+		}
+		wake.notify_all();
+		for (auto& t : threads) t.join();
+	}
+
+	// Runs part(1) to part(helpers) on pool threads and part(0) on this one
+	void run (int helpers, const std::function<void(int)>& part)
+	{
+		std::lock_guard<std::mutex> one_search(busy);
+
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			while ((int) threads.size() < helpers) threads.push_back(std::thread(&WorkerPool::serve, this));
+			job = &part;
+			next_part = 1;
+			last_part = helpers;
+			running = helpers;
+		}
+		wake.notify_all();
+
+		part(0);
+
+		std::unique_lock<std::mutex> guard(lock);
+		done.wait(guard, [this] { return running == 0; });
+		job = nullptr;
+		return;
+	}
+};
+
+WorkerPool& worker_pool (void)
+{
+	static WorkerPool pool;
+	return pool;
+}
+
+/* Branching cells below which a thread hands branches to idle threads.
+ * Deeper subtrees are too small to be worth the copy.
+ */
+const int split_depth = 12;
+
+/* The same search split between threads. Each thread keeps a deque of
+ * subtrees. It works on the newest of its own and, once it has none, steals
+ * the oldest, and so largest, from another thread. While any thread is idle,
+ * the others give away every branch but one at nodes near the root instead
+ * of searching them. Idle threads sleep until a subtree is queued or the
+ * search ends.
+ */
+template <int Order>
+class ParallelSearch {
+
+  private:
+
+	// A subtree still to be searched
+	struct Task {
+		SearchState<Order> state;
+		int depth;
+	};
+
+	// One per thread, on its own cache line
+	struct alignas(64) Queue {
+		std::mutex lock;
+		std::deque<Task> tasks;
+		int found = 0;  // Solutions not yet added to found below
+	};
+
+	std::vector<std::unique_ptr<Queue>> queues;
+
+	int limit;
+	unsigned char* solution;
+	const std::atomic<bool>* cancel;
+
+	/* Solutions a thread counts before adding them to found. Counting
+	 * millions one at a time would have every thread fighting over found.
+	 */
+	int batch;
+
+	std::atomic<int> found;
+	std::atomic<bool> copied;     // Set by the thread that stores solution
+	std::atomic<bool> finished;   // Set once limit solutions are found
+	std::atomic<long> unfinished; // Tasks queued or being searched
+	std::atomic<int> idle;        // Threads with nothing to search
+
+	/* Wakes idle threads. Taken by whoever queues a task or ends the search
+	 * before notifying, so a thread can't miss it between checking and
+	 * going to sleep.
+	 */
+	std::mutex idle_lock;
+	std::condition_variable more_work;
+
+	bool stopped (void)
+	{
+		return finished.load(std::memory_order_relaxed) ||
+		  (cancel != nullptr && cancel -> load(std::memory_order_relaxed));
+	}
+
+	void add_found (Queue& queue)
+	{
+		int total = found.fetch_add(queue.found) + queue.found;
+		queue.found = 0;
+		if (total >= limit && !finished.exchange(true)) wake_all();
+		return;
+	}
+
+	void wake_all (void)
+	{
+		{
+			std::lock_guard<std::mutex> guard(idle_lock);
+		}
+		more_work.notify_all();
+		return;
+	}
+
+	void push (int self, const SearchState<Order>& state, int depth)
+	{
+		unfinished.fetch_add(1);
+		{
+			std::lock_guard<std::mutex> guard(queues[self] -> lock);
+			queues[self] -> tasks.push_back({state, depth});
+		}
+
+		if (idle.load() > 0) {
+			{
+				std::lock_guard<std::mutex> guard(idle_lock);
+			}
+			more_work.notify_one();
+		}
+		return;
+	}
+
+	bool has_task (void)
+	{
+		for (auto& queue : queues) {
+			std::lock_guard<std::mutex> guard(queue -> lock);
+			if (!queue -> tasks.empty()) return true;
+		}
+		return false;
+	}
+
+	// Takes the newest task of thread self, or the oldest of another
+	bool take (int self, Task& task)
+	{
+		int count = queues.size();
+
+		int i;
+		for (i=0; i<count; i++) {
+			Queue& queue = *queues[(self + i) % count];
+			std::lock_guard<std::mutex> guard(queue.lock);
+			if (queue.tasks.empty()) continue;
+
+			if (i == 0) {
+				task = queue.tasks.back();
+				queue.tasks.pop_back();
+			} else {
+				task = queue.tasks.front();
+				queue.tasks.pop_front();
+			}
+			return true;
+		}
+		return false;
+	}
+
+	void search (int self, SearchState<Order>& state, int depth)
+	{
+		if (stopped()) return;
+
+		int cell;
+		unsigned int mask;
+		if (!choose_cell(state, cell, mask)) return;
+
+		if (cell == -1) {
+			if (solution != nullptr && !copied.load(std::memory_order_relaxed) && !copied.exchange(true)) {
+				std::copy(state.cells, state.cells + SearchState<Order>::cell_count, solution);
+			}
+
+			Queue& queue = *queues[self];
+			if (++queue.found >= batch) add_found(queue);
+			return;
+		}
+
+		// Forced moves don't count towards the depth
+		if (__builtin_popcount(mask) > 1) depth++;
+
+		while (mask) {
+			int digit = __builtin_ctz(mask) + 1;
+			mask &= mask - 1;
+
+			if (mask != 0 && depth <= split_depth && idle.load(std::memory_order_relaxed) > 0) {
+				SearchState<Order> branch = state;
+				place(branch, cell, digit);
+				push(self, branch, depth);
+				continue;
+			}
+
+			place(state, cell, digit);
+			search(self, state, depth);
+			unplace(state, cell, digit);
+
+			if (stopped()) return;
+		}
+		return;
+	}
+
+	void work (int self)
+	{
+		Task task;
+		bool waiting = false;
+
+		while (true) {
+			if (take(self, task)) {
+				if (waiting) idle.fetch_sub(1);
+				waiting = false;
+
+				search(self, task.state, task.depth);
+				add_found(*queues[self]);
+				if (unfinished.fetch_sub(1) == 1) wake_all();
+			} else if (unfinished.load() == 0 || stopped()) {
+				break;
+			} else {
+				if (!waiting) idle.fetch_add(1);
+				waiting = true;
+
+				std::unique_lock<std::mutex> guard(idle_lock);
+				more_work.wait(guard, [this] { return unfinished.load() == 0 || stopped() || has_task(); });
+			}
+		}
+
+		if (waiting) idle.fetch_sub(1);
+
+		// A cancel from outside wakes nobody, so the first thread to see it does
+		if (stopped()) wake_all();
+		return;
+	}
+
+  public:
+
+	ParallelSearch (int threads, int solutions, unsigned char* first, const std::atomic<bool>* stop) :
+	  limit(solutions), solution(first), cancel(stop), found(0), copied(false), finished(false),
+	  unfinished(0), idle(0)
+	{
+		// Small limits, like the 2 of a uniqueness check, are checked at once
+		batch = limit < 4096 ? 1 : 256;
+
+		int i;
+		for (i=0; i<threads; i++) queues.emplace_back(new Queue());
+	}
+
+	// Returns the number of solutions found, between 0 and limit
+	int run (const SearchState<Order>& root)
+	{
+		push(0, root, 0);
+		worker_pool().run(queues.size() - 1, [this] (int self) { work(self); });
+
+		return std::min(found.load(), limit);
+	}
+};
+
+// Stores the first solution in solution, if it is not null
+template <int Order>
+struct KeepFirst {
+	unsigned char* solution;
+
+	void operator() (const unsigned char* cells, int index) const
+	{
+		if (index == 0 && solution != nullptr) {
+			std::copy(cells, cells + SearchState<Order>::cell_count, solution);
+		}
+	}
+};
+
+int thread_count (int threads)
+{
+	if (threads <= 0) threads = std::thread::hardware_concurrency();
+	if (threads <= 0) threads = 1;
+	return threads;
+}
+
+template <int Order>
+int count_cells (const unsigned char* givens, int limit, unsigned char* solution, int threads,
+  const std::atomic<bool>* cancel)
+{
+	// Large states go on the heap, a 25x25 one is most of a kilobyte
+	std::unique_ptr<SearchState<Order>> state(new SearchState<Order>());
+	if (!load(givens, *state)) return 0;
+
+	threads = thread_count(threads);
+	if (threads == 1) return search(*state, limit, 0, KeepFirst<Order>{solution}, cancel);
+
+	ParallelSearch<Order> parallel(threads, limit, solution, cancel);
+	return parallel.run(*state);
+}
+
+}
+
+int count_solutions (const Grid& puzzle, int limit, Grid* solution)
+{
+	return count_solutions(puzzle, limit, solution, nullptr);
+}
+
+int count_solutions (const Grid& puzzle, int limit, Grid* solution,
+  const std::atomic<bool>* cancel)
+{
+	SearchState<3> state;
+	if (!load(puzzle.cells, state)) return 0;
+	return search(state, limit, 0, KeepFirst<3>{solution ? solution -> cells : nullptr}, cancel);
+}
+
+int list_solutions (const Grid& puzzle, int limit, std::vector<Grid>& solutions)
+{
+	SearchState<3> state;
+	if (!load(puzzle.cells, state)) return 0;
+
+	auto keep = [&solutions](const unsigned char* cells, int index) {
+		Grid solution;
+		std::copy(cells, cells + 81, solution.cells);
+		solutions.push_back(solution);
+	};
+	return search(state, limit, 0, keep, nullptr);
+}
+
+int count_solutions_parallel (const Grid& puzzle, int limit, Grid* solution, int threads)
+{
+	TRACE_SCOPE("count_solutions_parallel");
+	return count_cells<3>(puzzle.cells, limit, solution ? solution -> cells : nullptr, threads, nullptr);
+}
+
+int count_large_solutions (const LargeGrid& puzzle, int limit, LargeGrid* solution, int threads)
+{
+	TRACE_SCOPE("count_large_solutions");
+
+	int size = puzzle.order * puzzle.order;
+	if (puzzle.order < MIN_ORDER || puzzle.order > MAX_ORDER || (int) puzzle.cells.size() != size * size) {
+		return 0;
+	}
+
+	unsigned char* cells = nullptr;
+	if (solution != nullptr) {
+		solution -> order = puzzle.order;
+		solution -> cells.assign(size * size, 0);
+		cells = solution -> cells.data();
+	}
+
+	switch (puzzle.order) {
+		case 2: return count_cells<2>(puzzle.cells.data(), limit, cells, threads, nullptr);
+		case 3: return count_cells<3>(puzzle.cells.data(), limit, cells, threads, nullptr);
+		case 4: return count_cells<4>(puzzle.cells.data(), limit, cells, threads, nullptr);
+		default: return count_cells<5>(puzzle.cells.data(), limit, cells, threads, nullptr);
+	}
+}
+
+bool has_unique_solution (const Grid& puzzle)
+{
+	return count_solutions(puzzle, 2, nullptr) == 1;
+}
+
+bool is_consistent (const Grid& grid)
+{
+	SearchState<3> state;
+	return load(grid.cells, state);
+}
@@ -0,0 +1,227 @@
+/*
+* Last Modified: 10/19/26
+* Author: Alex Eastman
+* Contact: alexeast@buffalo.edu
+* Summary: sudoku-load, a load test for sudoku-server. Usage:
+*
+*              sudoku-load [-s socket] [-p port] [-c connections]
+*                          [-n requests] [-r ping|new|check|hint|mix]
+*
+*          Opens connections clients at once (default 8), each on its own
+*          thread, and has each send requests requests (default 1000) one
+*          at a time, waiting for every reply. -r picks the request (default
+*          mix, which cycles through all four). check and hint use a puzzle
+*          fetched first, which is not counted. Prints requests per second
+*          and the latency percentiles.
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <thread>
+#include <algorithm>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+#include "server.h"
+#include "paths.h"
+
+namespace {
+
+// What one connection measured
+struct ClientResult {
+	std::vector<long> latencies;  // Microseconds, one per request
+	long errors = 0;
+	bool connected = false;
+};
+
+int connect_unix (const std::string& path)
+{
+	sockaddr_un address;
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	if (path.size() >= sizeof(address.sun_path)) return -1;
+	strcpy(address.sun_path, path.c_str());
+
+	int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (fd >= 0 && connect(fd, (sockaddr*) &address, sizeof(address)) != 0) {
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+int connect_tcp (int port)
+{
+	sockaddr_in address;
+	memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_port = htons(port);
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+	int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (fd >= 0 && connect(fd, (sockaddr*) &address, sizeof(address)) != 0) {
+		close(fd);
+		return -1;
+	}
+
+	int on = 1;
+	if (fd >= 0) setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+	return fd;
+}
+
+// Sends request and reads the reply line into reply. False if the
+// connection failed.
+bool exchange (int fd, const std::string& request, std::string& pending, std::string& reply)
+{
+	std::string line = request + "\n";
+	size_t sent = 0;
+	while (sent < line.size()) {
+		ssize_t length = send(fd, line.data() + sent, line.size() - sent, MSG_NOSIGNAL);
+		if (length < 0 && errno == EINTR) continue;
+		if (length <= 0) return false;
+		sent += length;
+	}
+
+	size_t end;
+	while ((end = pending.find('\n')) == std::string::npos) {
+		char buffer[4096];
+		ssize_t length = recv(fd, buffer, sizeof(buffer), 0);
+		if (length < 0 && errno == EINTR) continue;
+		if (length <= 0) return false;
+		pending.append(buffer, length);
+	}
+
+	reply = pending.substr(0, end);
+	pending.erase(0, end + 1);
+	return true;
+}
+
+void run_client (const std::string& path, int port, int requests, const std::string& kind,
+  ClientResult& result)
+{
+	int fd = port != 0 ? connect_tcp(port) : connect_unix(path);
+	if (fd < 0) return;
+	result.connected = true;
+
+	std::string pending, reply;
+
+	// A puzzle for check and hint, from the reply "OK id difficulty puzzle"
+	std::string puzzle(81, '0');
+	if (kind != "ping" && kind != "new") {
+		if (!exchange(fd, "NEW any", pending, reply) || reply.compare(0, 3, "OK ") != 0) {
+			close(fd);
+			result.connected = false;
+			return;
+		}
+		puzzle = reply.substr(reply.rfind(' ') + 1);
+	}
+
+	const char* mix[4] = {"ping", "new", "check", "hint"};
+
+	int i;
+	for (i=0; i<requests; i++) {
+		std::string request = kind == "mix" ? mix[i % 4] : kind;
+		if (request == "ping") request = "PING";
+		else if (request == "new") request = "NEW any";
+		else if (request == "check") request = "CHECK " + puzzle + " " + puzzle;
+		else request = "HINT " + puzzle + " " + puzzle;
+
+		auto started = std::chrono::steady_clock::now();
+		if (!exchange(fd, request, pending, reply)) {
+			result.errors += requests - i;
+			break;
+		}
+		auto elapsed = std::chrono::steady_clock::now() - started;
+
+		result.latencies.push_back(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+		if (reply.compare(0, 2, "OK") != 0) result.errors++;
+	}
+
+	close(fd);
+	return;
+}
+
+// Milliseconds below which fraction of the sorted latencies lie
+double percentile (const std::vector<long>& sorted, double fraction)
+{
+	if (sorted.empty()) return 0;
+	size_t index = std::min(sorted.size() - 1, (size_t) (fraction * sorted.size()));
+	return sorted[index] / 1000.0;
+}
+
+}
+
+int
+main (int argc, char **argv)
+{
+	std::string socket_path;
+	int port = 0;
+	int connections = 8;
+	int requests = 1000;
+	std::string kind = "mix";
+
+	int i;
+	for (i=1; i<argc; i++) {
+		std::string arg = argv[i];
+		if (arg == "-s" && i + 1 < argc) socket_path = argv[++i];
+		else if (arg == "-p" && i + 1 < argc) port = atoi(argv[++i]);
+		else if (arg == "-c" && i + 1 < argc) connections = atoi(argv[++i]);
+		else if (arg == "-n" && i + 1 < argc) requests = atoi(argv[++i]);
+		else if (arg == "-r" && i + 1 < argc) kind = argv[++i];
+		else {
+			std::cerr << "usage: sudoku-load [-s socket] [-p port] [-c connections] [-n requests] "
+			  "[-r ping|new|check|hint|mix]" << std::endl;
+			return 2;
+		}
+	}
+	if (kind != "ping" && kind != "new" && kind != "check" && kind != "hint" && kind != "mix") {
+		std::cerr << "Unknown request " << kind << std::endl;
+		return 2;
+	}
+	if (socket_path.empty()) socket_path = data_path(SERVER_SOCKET);
+
+	std::vector<ClientResult> results(connections);
+	std::vector<std::thread> clients;
+
+	auto started = std::chrono::steady_clock::now();
+	for (i=0; i<connections; i++) {
+		clients.emplace_back(run_client, socket_path, port, requests, kind, std::ref(results[i]));
+	}
+	for (std::thread& client : clients) client.join();
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - started;
+
+	std::vector<long> latencies;
+	long errors = 0;
+	int connected = 0;
+	for (ClientResult& result : results) {
+		latencies.insert(latencies.end(), result.latencies.begin(), result.latencies.end());
+		errors += result.errors;
+		if (result.connected) connected++;
+	}
+	std::sort(latencies.begin(), latencies.end());
+
+	if (connected == 0) {
+		std::cerr << "Could not connect to the server" << std::endl;
+		return 1;
+	}
+
+	std::cout << std::fixed << std::setprecision(2);
+	std::cout << latencies.size() << " requests over " << connected << " connections in "
+	  << elapsed.count() << " s, " << errors << " errors" << std::endl;
+	std::cout << latencies.size() / elapsed.count() << " requests/s" << std::endl;
+	std::cout << "latency ms: p50 " << percentile(latencies, 0.50) << "  p90 " << percentile(latencies, 0.90)
+	  << "  p99 " << percentile(latencies, 0.99) << "  p99.9 " << percentile(latencies, 0.999)
+	  << "  max " << (latencies.empty() ? 0 : latencies.back() / 1000.0) << std::endl;
+
+	return errors == 0 && connected == connections ? 0 : 1;
+}
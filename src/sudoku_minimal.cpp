@@ -0,0 +1,89 @@
+/*
+* Last Modified: 10/19/26
+* Author: Alex Eastman
+* Contact: alexeast@buffalo.edu
+* Summary: sudoku-minimal, a command line tool that finds every minimal
+*          puzzle with few clues that a solution grid has. Usage:
+*
+*              sudoku-minimal [-j threads] [-n clues] [-k checkpoint]
+*                [-b base] grid
+*
+*          grid is a full grid as 81 digits. Prints each minimal puzzle with
+*          clues clues or fewer (default 17) that has grid as its only
+*          solution, one per line, and how far the search got on stderr.
+*          With -k the search is checkpointed to a file, and running again
+*          with the same file picks up where it stopped, printing the puzzles
+*          found before first. With -b only puzzles with every clue of the
+*          puzzle base are searched for. See minimal.h for how the search
+*          works.
+*/
+
+#include <iostream>
+#include <chrono>
+#include <string>
+#include <stdlib.h>
+
+#include "minimal.h"
+#include "solver.h"
+
+int
+main (int argc, char **argv)
+{
+	int threads = 0;
+	int clues = 17;
+	std::string checkpoint;
+	std::string base_line;
+	std::string line;
+
+	int i;
+	for (i=1; i<argc; i++) {
+		std::string arg = argv[i];
+		if (arg == "-j" && i + 1 < argc) threads = atoi(argv[++i]);
+		else if (arg == "-n" && i + 1 < argc) clues = atoi(argv[++i]);
+		else if (arg == "-k" && i + 1 < argc) checkpoint = argv[++i];
+		else if (arg == "-b" && i + 1 < argc) base_line = argv[++i];
+		else line = arg;
+	}
+
+	Grid solution;
+	Grid base = empty_grid();
+	if (!grid_from_string(line, solution) || count_givens(solution) != 81 || !is_consistent(solution) ||
+	  clues < 1 || clues > MAX_SEARCH_CLUES || (!base_line.empty() && !grid_from_string(base_line, base))) {
+		std::cerr << "usage: sudoku-minimal [-j threads] [-n clues] [-k checkpoint] [-b base] grid" << std::endl;
+		return 2;
+	}
+
+	for (i=0; i<81; i++) {
+		if (base.cells[i] != 0 && base.cells[i] != solution.cells[i]) {
+			std::cerr << "base is not a puzzle of grid" << std::endl;
+			return 2;
+		}
+	}
+
+	auto started = std::chrono::steady_clock::now();
+	MinimalSearch search(solution, base, clues, checkpoint);
+	if (!search.resume()) {
+		std::cerr << checkpoint << " is not a checkpoint of this search" << std::endl;
+		return 1;
+	}
+	std::cerr << search.set_count() << " unavoidable sets, " << search.finished_count() << " of "
+	  << search.task_count() << " tasks already finished" << std::endl;
+
+	int found = 0;
+	bool written = search.run(threads, [&](const Grid& puzzle) {
+		std::cout << grid_to_string(puzzle) << std::endl;
+		found++;
+	}, [&]() {
+		std::cerr << "\r" << search.finished_count() << " of " << search.task_count() << " tasks" << std::flush;
+	});
+	std::cerr << std::endl;
+
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - started;
+	std::cerr << found << " puzzles in " << elapsed.count() << "s" << std::endl;
+	if (!written) {
+		std::cerr << "Could not write " << checkpoint << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,166 @@
+/*
+* Last Modified: 10/19/26
+* Author: Alex Eastman
+* Contact: alexeast@buffalo.edu
+* Summary: sudoku-race, which hosts a head to head race. See race.h for the
+*          messages. Usage:
+*
+*              sudoku-race [-p port] [-a] [-i id] [-n players] [-c countdown]
+*                          [-b bots]
+*
+*          Listens on port (default 7249) of the loopback interface, or of
+*          every interface with -a so players on the LAN can join. The race
+*          is on puzzle id, or a fresh classic puzzle if not given, and
+*          starts countdown milliseconds (default 3000) after players
+*          (default 2) have joined and measured their clocks. -b adds bots that join over loopback and
+*          fill in the solution at about a cell a second, for trying it out
+*          alone. Prints who finished, in order, once the race is over.
+*          Stops on SIGINT or SIGTERM.
+*/
+
+#include <iostream>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <signal.h>
+#include <stdlib.h>
+
+#include "race.h"
+#include "random.h"
+
+namespace {
+
+// How long a bot takes per cell, give or take half
+const int bot_cell_ms = 1000;
+
+RaceHost* running = nullptr;
+
+void on_signal (int number)
+{
+	(void) number;
+	if (running) running -> stop();
+	return;
+}
+
+// Joins the race on port and fills in the solution one cell at a time
+void run_bot (int port, int number)
+{
+	RaceClient client;
+	if (!client.join("127.0.0.1", port, "bot" + std::to_string(number))) return;
+
+	// The puzzle is made while waiting, like players do, so the start is fair
+	std::vector<RaceEvent> events;
+	Grid puzzle, solution;
+	long start = 0;
+	while (start == 0) {
+		if (!client.wait(events, -1)) return;
+		for (const RaceEvent& event : events) {
+			if (event.type == RACE_WELCOME && !race_puzzle(event.name, puzzle, solution)) return;
+			if (event.type == RACE_START) start = event.value;
+		}
+		events.clear();
+	}
+
+	Random random(fresh_seed());
+	long now;
+	while ((now = race_clock()) < start) {
+		client.wait(events, (start - now) / 1000 + 1);
+		events.clear();
+	}
+
+	int i;
+	for (i=0; i<81; i++) {
+		if (puzzle.cells[i] != 0) continue;
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(bot_cell_ms / 2 + random.below(bot_cell_ms)));
+		puzzle.cells[i] = solution.cells[i];
+		client.send_progress(count_givens(puzzle));
+		if (!client.receive(events)) return;
+		events.clear();
+	}
+	client.send_done(puzzle);
+
+	// Stays until the host has seen the board
+	while (client.wait(events, -1)) {
+		for (const RaceEvent& event : events) {
+			if (event.type == RACE_WRONG) return;
+			if (event.type == RACE_FINISHED && event.name == "bot" + std::to_string(number)) return;
+		}
+		events.clear();
+	}
+	return;
+}
+
+}
+
+int
+main (int argc, char **argv)
+{
+	int port = RACE_PORT;
+	bool lan = false;
+	std::string id;
+	int players = 2;
+	int countdown = 3000;
+	int bots = 0;
+
+	int i;
+	for (i=1; i<argc; i++) {
+		std::string arg = argv[i];
+		if (arg == "-p" && i + 1 < argc) port = atoi(argv[++i]);
+		else if (arg == "-a") lan = true;
+		else if (arg == "-i" && i + 1 < argc) id = argv[++i];
+		else if (arg == "-n" && i + 1 < argc) players = atoi(argv[++i]);
+		else if (arg == "-c" && i + 1 < argc) countdown = atoi(argv[++i]);
+		else if (arg == "-b" && i + 1 < argc) bots = atoi(argv[++i]);
+		else {
+			std::cerr << "usage: sudoku-race [-p port] [-a] [-i id] [-n players] [-c countdown] [-b bots]"
+			  << std::endl;
+			return 2;
+		}
+	}
+	if (players < 1 || countdown < 0 || bots < 0) {
+		std::cerr << "usage: sudoku-race [-p port] [-a] [-i id] [-n players] [-c countdown] [-b bots]"
+		  << std::endl;
+		return 2;
+	}
+
+	RaceHost host(id);
+	if (!id.empty() && host.get_puzzle_id() != id) {
+		std::cerr << id << " is not a classic puzzle ID" << std::endl;
+		return 1;
+	}
+	if (!host.listen(port, lan)) {
+		std::cerr << "Could not listen on port " << port << std::endl;
+		return 1;
+	}
+	std::cerr << "Racing " << host.get_puzzle_id() << " on " << (lan ? "0.0.0.0:" : "127.0.0.1:")
+	  << host.get_port() << ", waiting for " << players << " players" << std::endl;
+
+	running = &host;
+	struct sigaction action;
+	action.sa_handler = on_signal;
+	sigemptyset(&action.sa_mask);
+	action.sa_flags = 0;
+	sigaction(SIGINT, &action, nullptr);
+	sigaction(SIGTERM, &action, nullptr);
+
+	std::vector<std::thread> threads;
+	for (i=0; i<bots; i++) threads.push_back(std::thread(run_bot, host.get_port(), i + 1));
+
+	bool raced = host.run(players, countdown);
+	running = nullptr;
+
+	for (const RaceResult& result : host.get_results()) {
+		std::cout << result.place << " " << result.name << " " << result.milliseconds / 1000.0 << "s" << std::endl;
+	}
+
+	// Bots still racing see the host go and give up
+	for (auto& t : threads) t.join();
+
+	if (!raced) {
+		std::cerr << "Stopped before the race started" << std::endl;
+		return 1;
+	}
+	return 0;
+}
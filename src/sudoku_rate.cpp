@@ -0,0 +1,118 @@
+/*
+* Last Modified: 10/19/26
+* Author: Alex Eastman
+* Contact: alexeast@buffalo.edu
+* Summary: sudoku-rate, a command line tool that rates every puzzle in one or
+*          more files using all cores. Usage:
+*
+*              sudoku-rate [-j threads] [-c] [-o out] [-i] [-v] file...
+*
+*          -j sets the number of threads (default one per core) and -c uses
+*          the game's analysis cache so puzzles it has seen are not solved
+*          again. -o also writes the puzzles to out in the format of its
+*          extension (.txt, .sdm or .sdk), to convert between formats. Files
+*          can be in any of those formats. -i writes the library index of
+*          each file (see library.h) instead of printing ratings. -v treats
+*          the puzzles as finished grids and checks them instead, printing
+*          each one that is not a valid solution with its first conflicting
+*          cell. Results go to stdout, throughput to stderr.
+*/
+
+#include <iostream>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <stdlib.h>
+
+#include "rater.h"
+#include "collection.h"
+#include "library.h"
+#include "validate.h"
+
+int
+main (int argc, char **argv)
+{
+	int threads = 0;
+	bool use_cache = false;
+	std::string out_path;
+	bool index = false;
+	bool validate = false;
+	std::vector<std::string> paths;
+
+	int i;
+	for (i=1; i<argc; i++) {
+		std::string arg = argv[i];
+		if (arg == "-j" && i + 1 < argc) threads = atoi(argv[++i]);
+		else if (arg == "-c") use_cache = true;
+		else if (arg == "-o" && i + 1 < argc) out_path = argv[++i];
+		else if (arg == "-i") index = true;
+		else if (arg == "-v") validate = true;
+		else paths.push_back(arg);
+	}
+
+	if (paths.empty()) {
+		std::cerr << "usage: sudoku-rate [-j threads] [-c] [-o out] [-i] [-v] file..." << std::endl;
+		return 2;
+	}
+
+	if (index) {
+		bool all_built = true;
+		for (const std::string& path : paths) {
+			auto started = std::chrono::steady_clock::now();
+			if (!build_library_index(path, threads, use_cache ? &shared_cache() : nullptr, nullptr)) {
+				std::cerr << "Could not index " << path << std::endl;
+				all_built = false;
+				continue;
+			}
+			std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - started;
+			std::cerr << "Indexed " << path << " in " << elapsed.count() << " seconds" << std::endl;
+		}
+		return all_built ? 0 : 1;
+	}
+
+	if (validate) {
+		std::vector<Grid> grids;
+		bool all_read = read_puzzles(paths, grids);
+
+		auto started = std::chrono::steady_clock::now();
+		ValidationReport report = validate_grids(pack_grids(grids), grids.size());
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - started;
+
+		int valid = 0;
+		for (i=0; i<(int) grids.size(); i++) {
+			if (grid_passed(report, i)) {
+				valid++;
+				continue;
+			}
+			int cell = report.conflicts[i];
+			std::cout << i + 1 << "\t" << grid_to_string(grids[i]) << "\tr" << cell / 9 + 1 << "c"
+			  << cell % 9 + 1 << std::endl;
+		}
+
+		std::cerr << valid << " of " << grids.size() << " grids valid, checked in " << elapsed.count()
+		  << " seconds" << std::endl;
+		if (!all_read) std::cerr << "Some files could not be read" << std::endl;
+		return all_read && valid == (int) grids.size() ? 0 : 1;
+	}
+
+	auto started = std::chrono::steady_clock::now();
+	bool all_read = rate_files(paths, threads, use_cache ? &shared_cache() : nullptr, std::cout);
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - started;
+
+	std::cerr << "Rated in " << elapsed.count() << " seconds" << std::endl;
+
+	if (!out_path.empty()) {
+		std::vector<Grid> puzzles;
+		read_puzzles(paths, puzzles);
+		if (!write_puzzles(out_path, puzzles, format_from_path(out_path), false)) {
+			std::cerr << "Could not write " << out_path << std::endl;
+			return 1;
+		}
+	}
+	if (!all_read) {
+		std::cerr << "Some files could not be read" << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
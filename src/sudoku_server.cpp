@@ -0,0 +1,94 @@
+/*
+* Last Modified: 10/19/26
+* Author: Alex Eastman
+* Contact: alexeast@buffalo.edu
+* Summary: sudoku-server, which serves puzzles to local clients. See
+*          server.h for the requests. Usage:
+*
+*              sudoku-server [-s socket] [-p port] [-j threads] [-c]
+*
+*          -s listens on a Unix socket (default sudoku.sock in the data
+*          directory) and -p on a TCP port of the loopback interface instead.
+*          Both may be given. -j sets the number of worker threads (default
+*          one per core) and -c uses the game's analysis cache on disk
+*          instead of one in memory. Stops on SIGINT or SIGTERM.
+*/
+
+#include <iostream>
+#include <string>
+#include <signal.h>
+#include <stdlib.h>
+
+#include "server.h"
+#include "cache.h"
+#include "paths.h"
+
+namespace {
+
+// Puzzles the in-memory cache remembers when -c is not given
+const size_t memory_cache_size = 65536;
+
+PuzzleServer* running = nullptr;
+
+void on_signal (int number)
+{
+	(void) number;
+	if (running) running -> stop();
+	return;
+}
+
+}
+
+int
+main (int argc, char **argv)
+{
+	std::string socket_path;
+	int port = 0;
+	int threads = 0;
+	bool use_cache = false;
+
+	int i;
+	for (i=1; i<argc; i++) {
+		std::string arg = argv[i];
+		if (arg == "-s" && i + 1 < argc) socket_path = argv[++i];
+		else if (arg == "-p" && i + 1 < argc) port = atoi(argv[++i]);
+		else if (arg == "-j" && i + 1 < argc) threads = atoi(argv[++i]);
+		else if (arg == "-c") use_cache = true;
+		else {
+			std::cerr << "usage: sudoku-server [-s socket] [-p port] [-j threads] [-c]" << std::endl;
+			return 2;
+		}
+	}
+	if (socket_path.empty() && port == 0) socket_path = data_path(SERVER_SOCKET);
+
+	AnalysisCache memory_cache(memory_cache_size, "");
+	PuzzleServer server(use_cache ? &shared_cache() : &memory_cache);
+
+	if (!socket_path.empty()) {
+		if (!server.listen_unix(socket_path)) {
+			std::cerr << "Could not listen on " << socket_path << std::endl;
+			return 1;
+		}
+		std::cerr << "Listening on " << socket_path << std::endl;
+	}
+	if (port != 0) {
+		if (!server.listen_tcp(port)) {
+			std::cerr << "Could not listen on port " << port << std::endl;
+			return 1;
+		}
+		std::cerr << "Listening on 127.0.0.1:" << port << std::endl;
+	}
+
+	running = &server;
+	struct sigaction action;
+	action.sa_handler = on_signal;
+	sigemptyset(&action.sa_mask);
+	action.sa_flags = 0;
+	sigaction(SIGINT, &action, nullptr);
+	sigaction(SIGTERM, &action, nullptr);
+
+	server.run(threads);
+
+	running = nullptr;
+	return 0;
+}
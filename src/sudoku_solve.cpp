@@ -0,0 +1,83 @@
+/*
+* Last Modified: 10/19/26
+* Author: Alex Eastman
+* Contact: alexeast@buffalo.edu
+* Summary: sudoku-solve, a command line tool that solves puzzles of any size
+*          from 4x4 to 25x25, one per line of each file. Usage:
+*
+*              sudoku-solve [-j threads] [-n limit] file...
+*
+*          Each puzzle is solved with its search split between threads
+*          (default one per core). -n counts solutions up to limit (default
+*          2, enough to tell whether the solution is unique). Prints the
+*          number of solutions found, the time taken and the first solution
+*          for each puzzle. See large_grid_from_string in grid.h for the
+*          format of the lines.
+*/
+
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <stdlib.h>
+
+#include "solver.h"
+
+int
+main (int argc, char **argv)
+{
+	int threads = 0;
+	int limit = 2;
+	std::vector<std::string> paths;
+
+	int i;
+	for (i=1; i<argc; i++) {
+		std::string arg = argv[i];
+		if (arg == "-j" && i + 1 < argc) threads = atoi(argv[++i]);
+		else if (arg == "-n" && i + 1 < argc) limit = atoi(argv[++i]);
+		else paths.push_back(arg);
+	}
+	if (paths.empty() || limit < 1) {
+		std::cerr << "usage: sudoku-solve [-j threads] [-n limit] file..." << std::endl;
+		return 2;
+	}
+
+	int failures = 0;
+	std::cout << std::fixed << std::setprecision(1);
+
+	for (const std::string& path : paths) {
+		std::ifstream file(path);
+		if (!file) {
+			std::cerr << "Could not read " << path << std::endl;
+			failures++;
+			continue;
+		}
+
+		std::string line;
+		int number = 0;
+		while (std::getline(file, line)) {
+			number++;
+			if (!line.empty() && line.back() == '\r') line.pop_back();
+			if (line.empty() || line[0] == '#') continue;
+
+			LargeGrid puzzle, solution;
+			if (!large_grid_from_string(line, puzzle)) {
+				std::cerr << path << ":" << number << ": not a puzzle" << std::endl;
+				failures++;
+				continue;
+			}
+
+			auto started = std::chrono::steady_clock::now();
+			int found = count_large_solutions(puzzle, limit, &solution, threads);
+			std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - started;
+
+			std::cout << found << "\t" << elapsed.count() << "ms\t"
+			  << (found > 0 ? large_grid_to_string(solution) : "no solution") << std::endl;
+			if (found == 0) failures++;
+		}
+	}
+
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,94 @@
+/* Last Modified: 10/19/26
+ * Author: Alex Eastman
+ * Contact: alexeast@buffalo.edu
+ * Summary: Definitions for function prototypes found in trace.h . See trace.h
+ *          for explanation of functions
+ */
+
+
+#include "trace.h"
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// One span (phase 'X') or counter value (phase 'C')
+struct TraceEvent {
+	const char* name;
+	char phase;
+	long time;
+	long value;  // Duration of a span, value of a counter
+	int thread;
+};
+
+std::mutex events_lock;
+std::vector<TraceEvent> events;
+
+/* Small numbers for threads, in the order they first record something, so
+ * the main thread is 0 and the trace viewer keeps them in a sensible order
+ */
+int thread_number (void)
+{
+	static std::atomic<int> next_thread(0);
+	thread_local int number = next_thread.fetch_add(1);
+	return number;
+}
+
+void record (const char* name, char phase, long time, long value)
+{
+	TraceEvent event = {name, phase, time, value, thread_number()};
+	std::lock_guard<std::mutex> guard(events_lock);
+	events.push_back(event);
+	return;
+}
+
+}
+
+long trace_now (void)
+{
+	static const std::chrono::steady_clock::time_point started = std::chrono::steady_clock::now();
+	return std::chrono::duration_cast<std::chrono::microseconds>(
+	  std::chrono::steady_clock::now() - started).count();
+}
+
+void trace_span (const char* name, long start)
+{
+	record(name, 'X', start, trace_now() - start);
+	return;
+}
+
+void trace_counter (const char* name, long value)
+{
+	record(name, 'C', trace_now(), value);
+	return;
+}
+
+void trace_flush (void)
+{
+	if (!trace_enabled()) return;
+
+	std::lock_guard<std::mutex> guard(events_lock);
+	std::ofstream file(getenv("SUDOKU_TRACE"));
+	if (!file) return;
+
+	file << "{\"traceEvents\":[\n";
+
+	size_t i;
+	for (i=0; i<events.size(); i++) {
+		const TraceEvent& event = events[i];
+		file << "{\"name\":\"" << event.name << "\",\"ph\":\"" << event.phase
+		  << "\",\"ts\":" << event.time << ",\"pid\":1,\"tid\":" << event.thread;
+
+		if (event.phase == 'X') file << ",\"dur\":" << event.value;
+		else file << ",\"args\":{\"value\":" << event.value << "}";
+
+		file << "}" << (i + 1 < events.size() ? ",\n" : "\n");
+	}
+
+	file << "],\"displayTimeUnit\":\"ms\"}\n";
+	return;
+}
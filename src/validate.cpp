@@ -0,0 +1,134 @@
+/* Last Modified: 10/19/26
+ * Author: Alex Eastman
+ * Contact: alexeast@buffalo.edu
+ * Summary: Definitions for function prototypes found in validate.h . See
+ *          validate.h for explanation of functions
+ */
+
+
+#include "validate.h"
+#include "trace.h"
+#include <string.h>
+
+namespace {
+
+/* One value per grid of a batch. Arithmetic on these works on every lane at
+ * once, in as few vector instructions as the target has.
+ */
+typedef unsigned char ByteLanes __attribute__((vector_size(BATCH_WIDTH)));
+typedef unsigned short Lanes __attribute__((vector_size(BATCH_WIDTH * 2)));
+
+}
+
+std::vector<GridBatch> pack_grids (const std::vector<Grid>& grids)
+{
+	std::vector<GridBatch> batches((grids.size() + BATCH_WIDTH - 1) / BATCH_WIDTH);
+	if (!batches.empty()) memset(batches.data(), 0, batches.size() * sizeof(GridBatch));
+
+	int i, j;
+	for (i=0; i<(int) grids.size(); i++) {
+		GridBatch& batch = batches[i / BATCH_WIDTH];
+		for (j=0; j<81; j++) batch.cells[j][i % BATCH_WIDTH] = grids[i].cells[j];
+	}
+
+	return batches;
+}
+
+uint32_t validate_batch (const GridBatch& batch)
+{
+	const UnitTables& tables = unit_tables();
+
+	// Digits seen in each unit, and whether any cell so far held something else
+	Lanes seen[27];
+	Lanes not_digit = {};
+
+	int i;
+	for (i=0; i<27; i++) seen[i] = Lanes{};
+
+	for (i=0; i<81; i++) {
+		ByteLanes bytes;
+		memcpy(&bytes, batch.cells[i], sizeof(bytes));
+		Lanes digits = __builtin_convertvector(bytes, Lanes);
+
+		// Comparisons give all ones in a lane where they hold
+		not_digit |= (Lanes) (digits - 1 > 8);
+
+		// 1 << (digit - 1) in each lane. Vectors can't shift each lane by a
+		// different amount without newer instruction sets, so the power of
+		// two is built from the bits of the shift instead. Lanes that don't
+		// hold a digit get junk, but they have failed already.
+		Lanes shift = digits - 1;
+		Lanes bits = (1 + (shift & 1)) * (1 + 3 * ((shift >> 1) & 1)) *
+		  (1 + 15 * ((shift >> 2) & 1)) * (1 + 255 * ((shift >> 3) & 1));
+		seen[tables.units_of[i][0]] |= bits;
+		seen[tables.units_of[i][1]] |= bits;
+		seen[tables.units_of[i][2]] |= bits;
+	}
+
+	// A full unit with all nine digits has none twice
+	Lanes failed = not_digit;
+	for (i=0; i<27; i++) failed |= (Lanes) (seen[i] != 0x1ff);
+
+	uint32_t passed = 0;
+	for (i=0; i<BATCH_WIDTH; i++) {
+		if (failed[i] == 0) passed |= 1u << i;
+	}
+	return passed;
+}
+
+ValidationReport validate_grids (const std::vector<GridBatch>& batches, int count)
+{
+	TRACE_SCOPE("validate_grids");
+
+	ValidationReport report;
+	report.passed.assign((count + 63) / 64, 0);
+	report.conflicts.assign(count, -1);
+
+	int i, j;
+	for (i=0; i<(int) batches.size() && i*BATCH_WIDTH<count; i++) {
+		uint32_t passed = validate_batch(batches[i]);
+
+		for (j=0; j<BATCH_WIDTH && i*BATCH_WIDTH + j<count; j++) {
+			int index = i*BATCH_WIDTH + j;
+			if (passed & (1u << j)) {
+				report.passed[index / 64] |= (uint64_t) 1 << (index % 64);
+				continue;
+			}
+
+			// Only failures are unpacked, to find where
+			Grid grid;
+			int k;
+			for (k=0; k<81; k++) grid.cells[k] = batches[i].cells[k][j];
+			report.conflicts[index] = first_conflict(grid);
+		}
+	}
+
+	return report;
+}
+
+int first_conflict (const Grid& grid)
+{
+	const UnitTables& tables = unit_tables();
+	unsigned short seen[27] = {0};
+
+	int i;
+	for (i=0; i<81; i++) {
+		int digit = grid.cells[i];
+		if (digit < 1 || digit > 9) return i;
+
+		unsigned short bit = 1 << (digit - 1);
+		const unsigned char* units = tables.units_of[i];
+		if ((seen[units[0]] | seen[units[1]] | seen[units[2]]) & bit) return i;
+
+		seen[units[0]] |= bit;
+		seen[units[1]] |= bit;
+		seen[units[2]] |= bit;
+	}
+
+	return -1;
+}
+
+bool grid_passed (const ValidationReport& report, int i)
+{
+	return (report.passed[i / 64] >> (i % 64)) & 1;
+}
@@ -0,0 +1,343 @@
+/* Last Modified: 10/19/26
+ * Author: Alex Eastman
+ * Contact: alexeast@buffalo.edu
+ * Summary: Definitions for the non-template parts of variants.h . See
+ *          variants.h for explanation of functions
+ */
+
+
+#include "variants.h"
+#include <sstream>
+#include <string.h>
+#include <ctype.h>
+
+namespace {
+
+const int neighbours[4][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+
+// Letters for each Variant and Symmetry at the start of a puzzle ID
+const char variant_letters[] = "CDJKA";
+const char symmetry_letters[] = "NRDM";
+
+// Position of c in letters, ignoring case, or -1
+int letter_index (const char* letters, char c)
+{
+	int i;
+	for (i=0; letters[i] != '\0'; i++) {
+		if (letters[i] == toupper(c)) return i;
+	}
+	return -1;
+}
+
+// Calls visit(other) for each cell sharing an edge with cell
+template <class Visit>
+void for_each_neighbour (int cell, const Visit& visit)
+{
+	int i;
+	for (i=0; i<4; i++) {
+		int row = cell / 9 + neighbours[i][0];
+		int column = cell % 9 + neighbours[i][1];
+		if (row >= 0 && row < 9 && column >= 0 && column < 9) visit(row*9 + column);
+	}
+	return;
+}
+
+/* Gives each group a color so that groups sharing an edge differ where it
+ * can. group_of holds the group of each cell (-1 for none). Greedy and
+ * capped at 5 colors, so two neighbours can end up with the same one.
+ */
+void color_groups (const short* group_of, int groups, unsigned char* color)
+{
+	int group, cell;
+	for (group=0; group<groups; group++) {
+		unsigned int taken = 0;
+		for (cell=0; cell<81; cell++) {
+			if (group_of[cell] != group) continue;
+			for_each_neighbour(cell, [&](int other) {
+				int next = group_of[other];
+				if (next >= 0 && next < group) taken |= 1 << color[next];
+			});
+		}
+
+		unsigned char c = 0;
+		while ((taken & (1 << c)) && c < 4) c++;
+		color[group] = c;
+	}
+
+	return;
+}
+
+// Returns true if every cell of region is reachable from any other
+bool connected (const unsigned char* region, int which)
+{
+	bool seen[81] = {false};
+	int stack[81];
+	int size = 0;
+	int count = 0;
+
+	int cell;
+	for (cell=0; cell<81 && size == 0; cell++) {
+		if (region[cell] == which) {
+			stack[size++] = cell;
+			seen[cell] = true;
+		}
+	}
+
+	while (size > 0) {
+		int current = stack[--size];
+		count++;
+		for_each_neighbour(current, [&](int other) {
+			if (!seen[other] && region[other] == which) {
+				seen[other] = true;
+				stack[size++] = other;
+			}
+		});
+	}
+
+	return count == 9;
+}
+
+}
+
+Jigsaw::Jigsaw (void)
+{
+	unsigned char blocks[81];
+	int cell;
+	for (cell=0; cell<81; cell++) blocks[cell] = unit_tables().units_of[cell][2] - 18;
+	*this = Jigsaw(blocks);
+}
+
+Jigsaw::Jigsaw (const unsigned char* regions)
+{
+	int filled[9] = {0};
+	short group_of[81];
+
+	int cell;
+	for (cell=0; cell<81; cell++) {
+		region[cell] = regions[cell];
+		members[region[cell]][filled[region[cell]]++] = cell;
+		group_of[cell] = region[cell];
+	}
+
+	color_groups(group_of, 9, color);
+}
+
+Killer::Killer (void)
+{
+	int cell;
+	for (cell=0; cell<81; cell++) cage_of[cell] = -1;
+	memset(color, 0, sizeof(color));
+}
+
+Killer::Killer (const std::vector<Cage>& layout)
+{
+	cages = layout;
+
+	int cell;
+	for (cell=0; cell<81; cell++) cage_of[cell] = -1;
+
+	int i;
+	for (i=0; i<(int) cages.size(); i++) {
+		for (int member : cages[i].cells) cage_of[member] = i;
+	}
+
+	memset(color, 0, sizeof(color));
+	color_groups(cage_of, cages.size(), color);
+}
+
+Jigsaw random_jigsaw (Random& random)
+{
+	unsigned char region[81];
+	int cell;
+	for (cell=0; cell<81; cell++) region[cell] = unit_tables().units_of[cell][2] - 18;
+
+	// Trade a cell of one region for a cell of a neighbouring region, and
+	// undo the trade if either region is left in pieces
+	int step;
+	for (step=0; step<400; step++) {
+		int a = random.below(81);
+		int b = -1;
+		for_each_neighbour(a, [&](int other) {
+			if (region[other] != region[a] && (b == -1 || random.below(2))) b = other;
+		});
+		if (b == -1) continue;
+
+		int from = region[a];
+		int to = region[b];
+
+		// A cell of the other region that touches this one
+		std::vector<int> options;
+		for (cell=0; cell<81; cell++) {
+			if (region[cell] != to || cell == b) continue;
+			for_each_neighbour(cell, [&](int other) {
+				if (region[other] == from && other != a) options.push_back(cell);
+			});
+		}
+		if (options.empty()) continue;
+		int c = options[random.below(options.size())];
+
+		region[a] = to;
+		region[c] = from;
+		if (!connected(region, from) || !connected(region, to)) {
+			region[a] = from;
+			region[c] = to;
+		}
+	}
+
+	return Jigsaw(region);
+}
+
+Killer random_killer (const Grid& solution, Random& random)
+{
+	std::vector<int> order;
+	int cell;
+	for (cell=0; cell<81; cell++) order.push_back(cell);
+	int i;
+	for (i=80; i>0; i--) std::swap(order[i], order[random.below(i + 1)]);
+
+	bool taken[81] = {false};
+	std::vector<Cage> cages;
+
+	for (int start : order) {
+		if (taken[start]) continue;
+
+		Cage cage;
+		cage.cells.push_back(start);
+		taken[start] = true;
+		unsigned short digits = 1 << (solution.cells[start] - 1);
+		int size = 2 + random.below(3);
+
+		// Grow into free neighbours without repeating a digit
+		while ((int) cage.cells.size() < size) {
+			std::vector<int> frontier;
+			for (int member : cage.cells) {
+				for_each_neighbour(member, [&](int other) {
+					if (!taken[other] && !(digits & (1 << (solution.cells[other] - 1)))) {
+						frontier.push_back(other);
+					}
+				});
+			}
+			if (frontier.empty()) break;
+
+			int next = frontier[random.below(frontier.size())];
+			cage.cells.push_back(next);
+			taken[next] = true;
+			digits |= 1 << (solution.cells[next] - 1);
+		}
+
+		cage.sum = 0;
+		for (int member : cage.cells) cage.sum += solution.cells[member];
+		cages.push_back(cage);
+	}
+
+	return Killer(cages);
+}
+
+std::string jigsaw_to_string (const Jigsaw& jigsaw)
+{
+	std::string text(81, '0');
+	int cell;
+	for (cell=0; cell<81; cell++) text[cell] = '0' + jigsaw.region[cell];
+	return text;
+}
+
+bool jigsaw_from_string (const std::string& text, Jigsaw& jigsaw)
+{
+	if (text.size() != 81) return false;
+
+	unsigned char regions[81];
+	int sizes[9] = {0};
+	int cell;
+	for (cell=0; cell<81; cell++) {
+		int region = text[cell] - '0';
+		if (region < 0 || region > 8 || ++sizes[region] > 9) return false;
+		regions[cell] = region;
+	}
+
+	jigsaw = Jigsaw(regions);
+	return true;
+}
+
+// Each cage is written as its sum, a colon, and its cells as two digits each
+std::string killer_to_string (const Killer& killer)
+{
+	std::string text;
+
+	for (const Cage& cage : killer.cages) {
+		if (!text.empty()) text += ",";
+		text += std::to_string(cage.sum) + ":";
+		for (int cell : cage.cells) {
+			text.push_back('0' + cell / 10);
+			text.push_back('0' + cell % 10);
+		}
+	}
+
+	return text;
+}
+
+bool killer_from_string (const std::string& text, Killer& killer)
+{
+	std::vector<Cage> cages;
+	std::stringstream stream(text);
+	std::string part;
+	bool covered[81] = {false};
+
+	while (std::getline(stream, part, ',')) {
+		size_t colon = part.find(':');
+		if (colon == std::string::npos || (part.size() - colon - 1) % 2 != 0) return false;
+
+		Cage cage;
+		cage.sum = atoi(part.substr(0, colon).c_str());
+
+		size_t i;
+		for (i=colon + 1; i<part.size(); i+=2) {
+			int cell = atoi(part.substr(i, 2).c_str());
+			if (cell < 0 || cell > 80 || covered[cell]) return false;
+			covered[cell] = true;
+			cage.cells.push_back(cell);
+		}
+		cages.push_back(cage);
+	}
+
+	killer = Killer(cages);
+	return true;
+}
+
+std::string variant_name (int variant)
+{
+	switch (variant) {
+		case VARIANT_DIAGONAL: return "diagonal";
+		case VARIANT_JIGSAW: return "jigsaw";
+		case VARIANT_KILLER: return "killer";
+		case VARIANT_ANTI_KNIGHT: return "anti-knight";
+		default: return "classic";
+	}
+}
+
+int variant_from_name (const std::string& name)
+{
+	int variant;
+	for (variant=0; variant<VARIANT_COUNT; variant++) {
+		if (variant_name(variant) == name) return variant;
+	}
+	return VARIANT_CLASSIC;
+}
+
+std::string make_puzzle_id (int variant, int symmetry, uint64_t seed)
+{
+	std::string id = {variant_letters[variant], symmetry_letters[symmetry], '-'};
+	return id + seed_to_id(seed);
+}
+
+bool parse_puzzle_id (const std::string& id, int& variant, int& symmetry, uint64_t& seed)
+{
+	if (id.size() != 3 + SEED_ID_LENGTH || id[2] != '-') return false;
+
+	int rules = letter_index(variant_letters, id[0]);
+	int pattern = letter_index(symmetry_letters, id[1]);
+	if (rules < 0 || pattern < 0 || !seed_from_id(id.substr(3), seed)) return false;
+
+	variant = rules;
+	symmetry = pattern;
+	return true;
+}
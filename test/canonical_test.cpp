@@ -0,0 +1,104 @@
+/*
+* Last Modified: 10/19/26
+* Author: Alex Eastman
+* Contact: alexeast@buffalo.edu
+* Summary: Tests that the canonical hash does not change under the symmetries
+*          of sudoku. Puzzles and solutions are shuffled by random band,
+*          stack, row, column and digit permutations and transposition, done
+*          here rather than through apply_transform, and every copy must
+*          reach the same canonical grid and hash as the original.
+*/
+
+#include <algorithm>
+
+#include "check.h"
+#include "canonical.h"
+#include "random.h"
+
+namespace {
+
+/* (order, random) Shuffles order in place
+ *
+ */
+template <int N>
+void shuffle (int (&order)[N], Random& random)
+{
+	int i;
+	for (i=N-1; i>0; i--) std::swap(order[i], order[random.below(i + 1)]);
+	return;
+}
+
+/* (grid, random) Returns grid under a random symmetry
+ *
+ */
+Grid shuffled (const Grid& grid, Random& random)
+{
+	int bands[3] = {0, 1, 2};
+	int stacks[3] = {0, 1, 2};
+	int digits[9] = {1, 2, 3, 4, 5, 6, 7, 8, 9};
+	shuffle(bands, random);
+	shuffle(stacks, random);
+	shuffle(digits, random);
+
+	int rows[9], columns[9];
+	int i, j;
+	for (i=0; i<3; i++) {
+		int within_rows[3] = {0, 1, 2};
+		int within_columns[3] = {0, 1, 2};
+		shuffle(within_rows, random);
+		shuffle(within_columns, random);
+		for (j=0; j<3; j++) {
+			rows[i*3 + j] = bands[i]*3 + within_rows[j];
+			columns[i*3 + j] = stacks[i]*3 + within_columns[j];
+		}
+	}
+
+	bool transposed = random.below(2) == 1;
+	Grid result;
+	int row, col;
+	for (row=0; row<9; row++) {
+		for (col=0; col<9; col++) {
+			int source = transposed ? columns[col]*9 + rows[row] : rows[row]*9 + columns[col];
+			int digit = grid.cells[source];
+			result.cells[row*9 + col] = digit == 0 ? 0 : digits[digit - 1];
+		}
+	}
+	return result;
+}
+
+}
+
+int
+main (void)
+{
+	Grid puzzles[3];
+	grid_from_string(".....26.........8.48..1........6.97..4...91..1...8.3..5..1...27..2......83..25..9", puzzles[0]);
+	grid_from_string("315872694629354781487916235253461978748239156196587342564193827972648513831725469", puzzles[1]);
+	grid_from_string("1................................................................................", puzzles[2]);
+
+	Random random(26);
+	int i, j;
+	for (i=0; i<3; i++) {
+		CanonicalForm form = canonicalize(puzzles[i]);
+		CHECK(form.hash == canonical_hash(puzzles[i]));
+		CHECK(form.hash == hash_grid(form.grid));
+		CHECK(grid_equal(apply_transform(form.transform, puzzles[i]), form.grid));
+		CHECK(grid_equal(invert_transform(form.transform, form.grid), puzzles[i]));
+
+		for (j=0; j<200; j++) {
+			Grid copy = shuffled(puzzles[i], random);
+			CanonicalForm other = canonicalize(copy);
+			CHECK(other.hash == form.hash);
+			CHECK(grid_equal(other.grid, form.grid));
+			CHECK(grid_equal(apply_transform(other.transform, copy), form.grid));
+		}
+	}
+
+	// Puzzles that are not the same up to symmetry must not share a hash
+	CHECK(canonical_hash(puzzles[0]) != canonical_hash(puzzles[1]));
+	Grid fewer = puzzles[0];
+	fewer.cells[5] = 0;
+	CHECK(canonical_hash(fewer) != canonical_hash(puzzles[0]));
+
+	return check_result("canonical_test");
+}
@@ -0,0 +1,43 @@
+/*
+* Last Modified: 10/19/26
+* Author: Alex Eastman
+* Contact: alexeast@buffalo.edu
+* Summary: What the tests share. Each test is a program of its own, run by
+*          make check. CHECK reports a condition that does not hold and
+*          counts it, and a test's main returns check_result(), which is
+*          nonzero if any check failed.
+*/
+
+#ifndef CHECK_H
+#define CHECK_H
+
+#include <iostream>
+
+/* Checks that failed so far
+ *
+ */
+inline int& check_failures (void)
+{
+	static int failures = 0;
+	return failures;
+}
+
+#define CHECK(condition) \
+	do { \
+		if (!(condition)) { \
+			std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK(" #condition ") failed" << std::endl; \
+			check_failures()++; \
+		} \
+	} while (0)
+
+/* Prints how the test went. Returns the exit status for main.
+ *
+ */
+inline int check_result (const char* test)
+{
+	if (check_failures() == 0) std::cout << test << ": passed" << std::endl;
+	else std::cout << test << ": " << check_failures() << " checks failed" << std::endl;
+	return check_failures() == 0 ? 0 : 1;
+}
+
+#endif
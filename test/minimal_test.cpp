@@ -0,0 +1,85 @@
+/*
+* Last Modified: 10/19/26
+* Author: Alex Eastman
+* Contact: alexeast@buffalo.edu
+* Summary: Tests MinimalSearch against a brute force search. Starting from a
+*          minimal 25 clue puzzle with three clues taken away, every way of
+*          adding back up to three clues is tried, and the search must find
+*          exactly the minimal puzzles among them. Unique puzzles that are
+*          not minimal are common there, so a search that stops at the first
+*          unique set of clues fails it.
+*/
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include "check.h"
+#include "minimal.h"
+#include "generator.h"
+#include "solver.h"
+
+int
+main (void)
+{
+	Grid puzzle, solution;
+	grid_from_string(".....26.........8.48..1........6.97..4...91..1...8.3..5..1...27..2......83..25..9", puzzle);
+	grid_from_string("315872694629354781487916235253461978748239156196587342564193827972648513831725469", solution);
+	CHECK(is_minimal(puzzle, 1));
+
+	// Takes away the 16th to 18th clues, which leaves 61 minimal puzzles
+	std::vector<int> open;
+	Grid base = puzzle;
+	int seen = 0;
+	int i;
+	for (i=0; i<81; i++) {
+		if (base.cells[i] != 0 && seen++ >= 15 && seen <= 18) base.cells[i] = 0;
+		if (base.cells[i] == 0) open.push_back(i);
+	}
+
+	// Every superset of base with up to three more clues, kept if minimal
+	std::set<std::string> expected;
+	auto consider = [&](const Grid& trial) {
+		if (count_solutions(trial, 2, nullptr) == 1 && is_minimal(trial, 1)) {
+			expected.insert(grid_to_string(trial));
+		}
+	};
+
+	int count = open.size();
+	int a, b, c;
+	for (a=0; a<count; a++) {
+		Grid one = base;
+		one.cells[open[a]] = solution.cells[open[a]];
+		consider(one);
+
+		for (b=a+1; b<count; b++) {
+			Grid two = one;
+			two.cells[open[b]] = solution.cells[open[b]];
+			consider(two);
+
+			for (c=b+1; c<count; c++) {
+				Grid three = two;
+				three.cells[open[c]] = solution.cells[open[c]];
+				consider(three);
+			}
+		}
+	}
+
+	std::set<std::string> found;
+	MinimalSearch search(solution, base, 25, "");
+	bool written = search.run(1, [&](const Grid& result) {
+		CHECK(count_solutions(result, 2, nullptr) == 1);
+		CHECK(is_minimal(result, 1));
+		CHECK(count_givens(result) <= 25);
+		CHECK(found.insert(grid_to_string(result)).second);  // Each found once
+	}, {});
+
+	CHECK(written);
+	CHECK(search.finished_count() == search.task_count());
+	CHECK(found.count(grid_to_string(puzzle)) == 1);
+	CHECK(expected.size() == 61);
+	CHECK(found.size() == expected.size());
+	CHECK(found == expected);
+
+	return check_result("minimal_test");
+}
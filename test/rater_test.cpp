@@ -0,0 +1,76 @@
+/*
+* Last Modified: 10/19/26
+* Author: Alex Eastman
+* Contact: alexeast@buffalo.edu
+* Summary: Pins the ratings of a few known puzzles, so a change to the
+*          techniques or their weights that moves a rating shows up here.
+*          Puzzles without exactly one solution must stay UNRATED, and
+*          rate_batch must agree with rate.
+*/
+
+#include <vector>
+
+#include "check.h"
+#include "rater.h"
+
+namespace {
+
+/* A puzzle and the rating it must get
+ *
+ */
+struct Known {
+	const char* puzzle;
+	int hardest;
+	int steps;
+	int score;
+	int difficulty;
+};
+
+const Known known[] = {
+	{"..3.2.6..9..3.5..1..18.64....81.29..7.......8..67.82....26.95..8..2.3..9..5.1.3..",
+	 NAKED_SINGLE, 49, 149, EASY},
+	{"4.....8.5.3..........7......2.....6.....8.4......1.......6.3.7.5..2.....1.4......",
+	 LOCKED_CANDIDATES, 71, 471, MEDIUM},
+	{".....26.........8.48..1........6.97..4...91..1...8.3..5..1...27..2......83..25..9",
+	 GUESS, 58, 3058, DIABOLICAL},
+	{"8..........36......7..9.2...5...7.......457.....1...3...1....68..85...1..9....4..",
+	 GUESS, 67, 3067, DIABOLICAL},
+	{"1................................................................................",  // Many solutions
+	 -1, 0, -1, UNRATED},
+	{"11...............................................................................",  // None
+	 -1, 0, -1, UNRATED},
+};
+
+}
+
+int
+main (void)
+{
+	std::vector<Grid> puzzles;
+	std::vector<Rating> ratings;
+	for (const Known& entry : known) {
+		Grid puzzle;
+		CHECK(grid_from_string(entry.puzzle, puzzle));
+		puzzles.push_back(puzzle);
+
+		Rating rating = rate(puzzle);
+		CHECK(rating.hardest == entry.hardest);
+		CHECK(rating.steps == entry.steps);
+		CHECK(rating.score == entry.score);
+		CHECK(rating.difficulty == entry.difficulty);
+		ratings.push_back(rating);
+	}
+
+	std::vector<Rating> batch = rate_batch(puzzles, 2, nullptr);
+	CHECK(batch.size() == ratings.size());
+
+	int i;
+	for (i=0; i<(int) batch.size() && i<(int) ratings.size(); i++) {
+		CHECK(batch[i].hardest == ratings[i].hardest);
+		CHECK(batch[i].steps == ratings[i].steps);
+		CHECK(batch[i].score == ratings[i].score);
+		CHECK(batch[i].difficulty == ratings[i].difficulty);
+	}
+
+	return check_result("rater_test");
+}
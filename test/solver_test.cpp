@@ -0,0 +1,153 @@
+/*
+* Last Modified: 10/19/26
+* Author: Alex Eastman
+* Contact: alexeast@buffalo.edu
+* Summary: Tests the parallel solvers against the sequential one. Puzzles
+*          with none, one and many solutions are counted by count_solutions,
+*          count_solutions_parallel and count_large_solutions with one and
+*          several threads, and all must agree. 16x16 puzzles, which only
+*          count_large_solutions takes, are checked against its own run on
+*          one thread.
+*/
+
+#include <string>
+#include <vector>
+
+#include "check.h"
+#include "solver.h"
+#include "random.h"
+
+namespace {
+
+/* (grid) Returns the 9x9 grid as an order 3 LargeGrid
+ *
+ */
+LargeGrid to_large (const Grid& grid)
+{
+	LargeGrid large;
+	large.order = 3;
+	large.cells.assign(grid.cells, grid.cells + 81);
+	return large;
+}
+
+/* (puzzle, solution) Returns true if solution is full, breaks no rule and
+ * keeps every clue of puzzle
+ */
+bool solves (const LargeGrid& puzzle, const LargeGrid& solution)
+{
+	int order = puzzle.order;
+	int size = order * order;
+	if (solution.order != order || (int) solution.cells.size() != size * size) return false;
+
+	int row, col;
+	std::vector<int> rows(size), columns(size), boxes(size);
+	for (row=0; row<size; row++) {
+		for (col=0; col<size; col++) {
+			int given = puzzle.cells[row*size + col];
+			int value = solution.cells[row*size + col];
+			if (value < 1 || value > size || (given != 0 && given != value)) return false;
+
+			int bit = 1 << (value - 1);
+			int box = (row / order) * order + col / order;
+			if ((rows[row] | columns[col] | boxes[box]) & bit) return false;
+			rows[row] |= bit;
+			columns[col] |= bit;
+			boxes[box] |= bit;
+		}
+	}
+	return true;
+}
+
+/* (puzzle, limit) Checks that every solver finds the same count for the
+ * 9x9 puzzle, and that the solutions they store solve it. Returns the count.
+ */
+int check_classic (const Grid& puzzle, int limit)
+{
+	Grid solution;
+	int expected = count_solutions(puzzle, limit, &solution);
+	if (expected > 0) CHECK(solves(to_large(puzzle), to_large(solution)));
+
+	int threads;
+	for (threads=1; threads<=4; threads++) {
+		Grid found = empty_grid();
+		CHECK(count_solutions_parallel(puzzle, limit, &found, threads) == expected);
+		if (expected > 0) CHECK(solves(to_large(puzzle), to_large(found)));
+
+		LargeGrid large;
+		CHECK(count_large_solutions(to_large(puzzle), limit, &large, threads) == expected);
+		if (expected > 0) CHECK(solves(to_large(puzzle), large));
+	}
+	return expected;
+}
+
+/* (puzzle, limit) Checks that count_large_solutions finds the same count
+ * on several threads as on one. Returns the count.
+ */
+int check_large (const LargeGrid& puzzle, int limit)
+{
+	LargeGrid solution;
+	int expected = count_large_solutions(puzzle, limit, &solution, 1);
+	if (expected > 0) CHECK(solves(puzzle, solution));
+
+	int threads;
+	for (threads=2; threads<=4; threads++) {
+		LargeGrid found;
+		CHECK(count_large_solutions(puzzle, limit, &found, threads) == expected);
+		if (expected > 0) CHECK(solves(puzzle, found));
+	}
+	return expected;
+}
+
+}
+
+int
+main (void)
+{
+	Grid puzzle;
+	grid_from_string(".....26.........8.48..1........6.97..4...91..1...8.3..5..1...27..2......83..25..9", puzzle);
+	CHECK(check_classic(puzzle, 2) == 1);
+
+	// Clues taken away one at a time give more and more solutions
+	Grid fewer = puzzle;
+	int taken = 0;
+	int i;
+	for (i=0; i<81 && taken<4; i++) {
+		if (fewer.cells[i] == 0) continue;
+		fewer.cells[i] = 0;
+		taken++;
+		CHECK(check_classic(fewer, 100000) > 1);
+	}
+	CHECK(check_classic(fewer, 10) == 10);  // Stops at the limit
+
+	Grid broken = puzzle;
+	broken.cells[0] = 1;  // The only solution has a 3 there
+	CHECK(check_classic(broken, 2) == 0);
+
+	// A 16x16 solution laid out by shifting rows, with random cells emptied
+	LargeGrid full;
+	full.order = 4;
+	full.cells.resize(256);
+	int row, col;
+	for (row=0; row<16; row++) {
+		for (col=0; col<16; col++) full.cells[row*16 + col] = (row % 4 * 4 + row / 4 + col) % 16 + 1;
+	}
+	CHECK(check_large(full, 2) == 1);
+
+	Random random(45);
+	LargeGrid sparse = full;
+	int emptied = 0;
+	while (emptied < 120) {
+		int cell = random.below(256);
+		if (sparse.cells[cell] == 0) continue;
+		sparse.cells[cell] = 0;
+		emptied++;
+		if (emptied % 30 == 0) CHECK(check_large(sparse, 100000) >= 1);
+	}
+
+	LargeGrid clash = sparse;
+	clash.cells[0] = 1;
+	clash.cells[1] = 1;  // Twice in a row
+	CHECK(check_large(clash, 2) == 0);
+
+	return check_result("solver_test");
+}
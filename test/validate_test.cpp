@@ -0,0 +1,78 @@
+/*
+* Last Modified: 10/19/26
+* Author: Alex Eastman
+* Contact: alexeast@buffalo.edu
+* Summary: Tests the batch validator against first_conflict, which checks one
+*          grid at a time. Valid solutions, solutions with a cell changed,
+*          emptied or swapped, and grids of random digits are mixed in a
+*          count that does not fill the last batch, and every grid must pass
+*          or fail, at the same cell, the way first_conflict says.
+*/
+
+#include <algorithm>
+#include <vector>
+
+#include "check.h"
+#include "validate.h"
+#include "generator.h"
+#include "random.h"
+
+int
+main (void)
+{
+	Random random(46);
+	std::vector<Grid> grids;
+	int i, j;
+	for (i=0; i<203; i++) {
+		Grid grid;
+		random_solution(grid, random);
+
+		int cell = random.below(81);
+		switch (i % 5) {
+			case 0:  // Left valid
+				break;
+			case 1:  // One digit changed to another
+				grid.cells[cell] = (grid.cells[cell] + random.below(8)) % 9 + 1;
+				break;
+			case 2:  // One cell emptied
+				grid.cells[cell] = 0;
+				break;
+			case 3:  // Two cells of a row swapped, which only breaks columns and blocks
+				std::swap(grid.cells[cell], grid.cells[cell / 9 * 9 + random.below(9)]);
+				break;
+			case 4:  // Random digits
+				for (j=0; j<81; j++) grid.cells[j] = random.below(10);
+				break;
+		}
+		grids.push_back(grid);
+	}
+
+	std::vector<GridBatch> batches = pack_grids(grids);
+	CHECK(batches.size() == (grids.size() + BATCH_WIDTH - 1) / BATCH_WIDTH);
+
+	int count = grids.size();
+	int valid = 0;
+	for (i=0; i<count; i++) {
+		uint32_t mask = validate_batch(batches[i / BATCH_WIDTH]);
+		bool passed = first_conflict(grids[i]) == -1;
+		CHECK(((mask >> (i % BATCH_WIDTH)) & 1) == passed);
+		if (passed) valid++;
+	}
+
+	// Both valid and broken grids are needed for the comparison to mean much
+	CHECK(valid >= count / 5);
+	CHECK(valid < count);
+
+	// The empty lanes padding the last batch never pass
+	uint32_t last = validate_batch(batches.back());
+	CHECK((last >> (count % BATCH_WIDTH)) == 0);
+
+	ValidationReport report = validate_grids(batches, count);
+	for (i=0; i<count; i++) {
+		int conflict = first_conflict(grids[i]);
+		CHECK(grid_passed(report, i) == (conflict == -1));
+		CHECK(report.conflicts[i] == conflict);
+	}
+
+	return check_result("validate_test");
+}